@@ -5,57 +5,45 @@
 #include <cstring>
 #include <ctime>
 #include <set>
+#include <tuple>
 #include <utility>
 #include <iostream>
 
 #include <inflate/platform.hpp>
+#include <inflate/cpu.hpp>
 #include <inflate/exception.hpp>
+#include <inflate/bitspan.hpp>
 #include <inflate/bitstream.hpp>
 #include <inflate/utility.hpp>
+#include <inflate/checksum.hpp>
+#include <inflate/entropy.hpp>
+#include <inflate/stats.hpp>
+#include <inflate/format.hpp>
+#include <inflate/result.hpp>
+#include <inflate/rng.hpp>
+#include <inflate/kernel.hpp>
+#include <inflate/static.hpp>
+#include <inflate/context.hpp>
+#include <inflate/stream.hpp>
+#include <inflate/buffer.hpp>
+#include <inflate/parallel.hpp>
+#include <inflate/archive.hpp>
+#include <inflate/update.hpp>
+#include <inflate/file.hpp>
+#include <inflate/in_place.hpp>
 
 namespace inflate
 {
-   enum InflateLevel
+   /// @brief The outcome of choosing an inflate level for a target entropy.
+   struct InflateSelection
    {
-      INFLATE_NOOP = 0,
-
-      INFLATE_1BIT,
-      INFLATE_2BIT,
-      INFLATE_3BIT,
-      INFLATE_4BIT,
-      INFLATE_5BIT,
-      INFLATE_6BIT,
-      INFLATE_7BIT,
-
-      INFLATE_RNG_PARTIAL_1BIT,
-      INFLATE_RNG_PARTIAL_2BIT,
-      INFLATE_RNG_PARTIAL_3BIT,
-      INFLATE_RNG_PARTIAL_4BIT,
-      INFLATE_RNG_PARTIAL_5BIT,
-      INFLATE_RNG_PARTIAL_6BIT,
-      INFLATE_RNG_PARTIAL_7BIT,
-
-      INFLATE_RNG_FULL_1BIT,
-      INFLATE_RNG_FULL_2BIT,
-      INFLATE_RNG_FULL_3BIT,
-      INFLATE_RNG_FULL_4BIT,
-      INFLATE_RNG_FULL_5BIT,
-      INFLATE_RNG_FULL_6BIT,
-      INFLATE_RNG_FULL_7BIT,
+      InflateLevel level;
+      double sampled_entropy;
+      double predicted_entropy;
    };
 
-   PACK(1)
-   struct InflateHeader
-   {
-      std::uint8_t level;
-      std::uint64_t inflated;
-      std::uint64_t deflated;
-      std::uint32_t checksum;
-      std::uint32_t seed;
-   };
-   UNPACK()
-
-   #define INFLATE_MAGIC "NFL8"
+   #define INFLATE_SAMPLE_SIZE 0x10000
+   #define INFLATE_REGION_SIZE 0x1000
 
    EXPORT std::pair<ByteVec, InflateHeader> inflate_memory(const void *ptr,
                                                            std::uint64_t size,
@@ -81,6 +69,145 @@ namespace inflate
                                std::optional<std::uint32_t> seed=std::nullopt);
    EXPORT ByteVec deflate_disk(const void *ptr, std::uint64_t size);
    EXPORT ByteVec deflate_disk(const ByteVec &vec);
+
+   /// @brief Inflate with a versioned header, which records the checksum chosen in `options`.
+   ///
+   /// `inflate_disk` with options produces an `NFLV` stream. `deflate_disk` accepts both `NFL8` and `NFLV`
+   /// streams, so readers need no changes.
+   EXPORT std::pair<ByteVec, InflateHeaderV2> inflate_memory(const void *ptr,
+                                                             std::uint64_t size,
+                                                             const InflateOptions &options);
+   EXPORT std::pair<ByteVec, InflateHeaderV2> inflate_memory(const ByteVec &vec, const InflateOptions &options);
+   EXPORT ByteVec deflate_memory(const void *ptr,
+                                 std::uint64_t size,
+                                 const InflateHeaderV2 &header,
+                                 bool validate=true);
+   EXPORT ByteVec deflate_memory(const ByteVec &vec,
+                                 const InflateHeaderV2 &header,
+                                 bool validate=true);
+   EXPORT ByteVec inflate_disk(const void *ptr, std::uint64_t size, const InflateOptions &options);
+   EXPORT ByteVec inflate_disk(const ByteVec &vec, const InflateOptions &options);
+
+   /// @brief Non-throwing counterparts of the functions above.
+   ///
+   /// The header and sizes are validated once on entry; past that point the transforms run without any
+   /// per-bit checks. Failures are reported through the status of the returned `Result`.
+   EXPORT Result<std::pair<ByteVec, InflateHeader>> try_inflate_memory(const void *ptr,
+                                                                       std::uint64_t size,
+                                                                       InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                                                       std::optional<std::uint32_t> seed=std::nullopt) noexcept;
+   EXPORT Result<std::pair<ByteVec, InflateHeader>> try_inflate_memory(const ByteVec &vec,
+                                                                       InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                                                       std::optional<std::uint32_t> seed=std::nullopt) noexcept;
+   EXPORT Result<ByteVec> try_deflate_memory(const void *ptr,
+                                             std::uint64_t size,
+                                             const InflateHeader &header,
+                                             bool validate=true) noexcept;
+   EXPORT Result<ByteVec> try_deflate_memory(const ByteVec &vec,
+                                             const InflateHeader &header,
+                                             bool validate=true) noexcept;
+   EXPORT Result<ByteVec> try_inflate_disk(const void *ptr,
+                                           std::uint64_t size,
+                                           InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                           std::optional<std::uint32_t> seed=std::nullopt) noexcept;
+   EXPORT Result<ByteVec> try_inflate_disk(const ByteVec &vec,
+                                           InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                           std::optional<std::uint32_t> seed=std::nullopt) noexcept;
+   EXPORT Result<ByteVec> try_deflate_disk(const void *ptr, std::uint64_t size) noexcept;
+   EXPORT Result<ByteVec> try_deflate_disk(const ByteVec &vec) noexcept;
+   EXPORT Result<std::pair<ByteVec, InflateHeaderV2>> try_inflate_memory(const void *ptr,
+                                                                         std::uint64_t size,
+                                                                         const InflateOptions &options) noexcept;
+   EXPORT Result<std::pair<ByteVec, InflateHeaderV2>> try_inflate_memory(const ByteVec &vec, const InflateOptions &options) noexcept;
+   EXPORT Result<ByteVec> try_deflate_memory(const void *ptr,
+                                             std::uint64_t size,
+                                             const InflateHeaderV2 &header,
+                                             bool validate=true) noexcept;
+   EXPORT Result<ByteVec> try_deflate_memory(const ByteVec &vec,
+                                             const InflateHeaderV2 &header,
+                                             bool validate=true) noexcept;
+   EXPORT Result<ByteVec> try_inflate_disk(const void *ptr, std::uint64_t size, const InflateOptions &options) noexcept;
+   EXPORT Result<ByteVec> try_inflate_disk(const ByteVec &vec, const InflateOptions &options) noexcept;
+
+   /// @brief Parse the header of an `NFL8` or `NFLV` stream and locate its payload, without deflating it.
+   ///
+   /// The header is validated against the payload size, so the payload can be handed straight to
+   /// `deflate_kernel` or `deflate_memory`. With `InflateOptions::alignment`, `payload_offset` is a multiple of
+   /// the alignment, which lets `mmap` and `O_DIRECT` readers use the payload in place.
+   EXPORT InflateContainer parse_container(const void *ptr, std::uint64_t size);
+   EXPORT InflateContainer parse_container(const ByteVec &vec);
+   EXPORT Result<InflateContainer> try_parse_container(const void *ptr, std::uint64_t size) noexcept;
+   EXPORT Result<InflateContainer> try_parse_container(const ByteVec &vec) noexcept;
+
+   /// @brief Choose the inflate level with the smallest expansion whose output stays at or below `max_entropy`.
+   ///
+   /// Candidate levels are tried on a sample of at most `sample_size` bytes drawn evenly from the input, in
+   /// order of increasing expansion. If `family` is given, only levels of that family (and `INFLATE_NOOP`)
+   /// are considered. Throws `exception::UnreachableEntropy` if no level meets the target.
+   EXPORT InflateSelection select_level(const void *ptr,
+                                        std::uint64_t size,
+                                        double max_entropy,
+                                        std::optional<InflateFamily> family=std::nullopt,
+                                        std::optional<std::uint32_t> seed=std::nullopt,
+                                        std::uint64_t sample_size=INFLATE_SAMPLE_SIZE);
+   EXPORT InflateSelection select_level(const ByteVec &vec,
+                                        double max_entropy,
+                                        std::optional<InflateFamily> family=std::nullopt,
+                                        std::optional<std::uint32_t> seed=std::nullopt,
+                                        std::uint64_t sample_size=INFLATE_SAMPLE_SIZE);
+   EXPORT std::tuple<ByteVec, InflateHeader, InflateSelection> inflate_memory_to_entropy(const void *ptr,
+                                                                                         std::uint64_t size,
+                                                                                         double max_entropy,
+                                                                                         std::optional<InflateFamily> family=std::nullopt,
+                                                                                         std::optional<std::uint32_t> seed=std::nullopt,
+                                                                                         std::uint64_t sample_size=INFLATE_SAMPLE_SIZE);
+   EXPORT std::tuple<ByteVec, InflateHeader, InflateSelection> inflate_memory_to_entropy(const ByteVec &vec,
+                                                                                         double max_entropy,
+                                                                                         std::optional<InflateFamily> family=std::nullopt,
+                                                                                         std::optional<std::uint32_t> seed=std::nullopt,
+                                                                                         std::uint64_t sample_size=INFLATE_SAMPLE_SIZE);
+
+   /// @brief Inflate each `region_size` block of the input with the cheapest level that meets `max_entropy`.
+   ///
+   /// Regions which already meet the target are stored with `INFLATE_NOOP`. The regions are inflated
+   /// back-to-back, each starting on a byte boundary, and share the header's seed.
+   EXPORT std::tuple<ByteVec, InflateRegionHeader, std::vector<InflateRegion>> inflate_regions_memory(const void *ptr,
+                                                                                                      std::uint64_t size,
+                                                                                                      double max_entropy,
+                                                                                                      std::uint64_t region_size=INFLATE_REGION_SIZE,
+                                                                                                      std::optional<InflateFamily> family=std::nullopt,
+                                                                                                      std::optional<std::uint32_t> seed=std::nullopt);
+   EXPORT std::tuple<ByteVec, InflateRegionHeader, std::vector<InflateRegion>> inflate_regions_memory(const ByteVec &vec,
+                                                                                                      double max_entropy,
+                                                                                                      std::uint64_t region_size=INFLATE_REGION_SIZE,
+                                                                                                      std::optional<InflateFamily> family=std::nullopt,
+                                                                                                      std::optional<std::uint32_t> seed=std::nullopt);
+   EXPORT ByteVec deflate_regions_memory(const void *ptr,
+                                         std::uint64_t size,
+                                         const InflateRegionHeader &header,
+                                         const std::vector<InflateRegion> &regions,
+                                         bool validate=true);
+   EXPORT ByteVec deflate_regions_memory(const ByteVec &vec,
+                                         const InflateRegionHeader &header,
+                                         const std::vector<InflateRegion> &regions,
+                                         bool validate=true);
+
+   /// @brief Produce an `NFLR` stream: the magic, the region header, the region table and the inflated regions.
+   ///
+   /// `deflate_disk` recognizes the `NFLR` magic and undoes it transparently.
+   EXPORT ByteVec inflate_regions_disk(const void *ptr,
+                                       std::uint64_t size,
+                                       double max_entropy,
+                                       std::uint64_t region_size=INFLATE_REGION_SIZE,
+                                       std::optional<InflateFamily> family=std::nullopt,
+                                       std::optional<std::uint32_t> seed=std::nullopt);
+   EXPORT ByteVec inflate_regions_disk(const ByteVec &vec,
+                                       double max_entropy,
+                                       std::uint64_t region_size=INFLATE_REGION_SIZE,
+                                       std::optional<InflateFamily> family=std::nullopt,
+                                       std::optional<std::uint32_t> seed=std::nullopt);
+   EXPORT ByteVec deflate_regions_disk(const void *ptr, std::uint64_t size);
+   EXPORT ByteVec deflate_regions_disk(const ByteVec &vec);
 }
 
 #endif
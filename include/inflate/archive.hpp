@@ -0,0 +1,95 @@
+#ifndef __INFLATE_ARCHIVE_HPP
+#define __INFLATE_ARCHIVE_HPP
+
+/// @file archive.hpp
+/// @brief `NFLA` archives: many inflated members in one file, indexed by a central directory at the end.
+///
+/// An archive is the `NFLA` magic, then one `NFLV` stream per member, then the central directory, which holds
+/// an `InflateArchiveEntry` and the name of every member. An `InflateArchiveTrailer` closes the archive. It
+/// sits at a fixed distance from the end, so a reader finds the directory without scanning the members, and
+/// each member can then be extracted on its own.
+///
+/// With `InflateOptions::alignment`, every member stream starts on a multiple of the alignment. Because the
+/// member's payload is aligned within its stream, payloads are then aligned within the archive as well.
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <inflate/platform.hpp>
+#include <inflate/bitstream.hpp>
+#include <inflate/format.hpp>
+
+namespace inflate
+{
+   /// @brief Data to store in an archive under `name`. The data isn't copied and must outlive the call.
+   struct ArchiveSource
+   {
+      std::string name;
+      const void *ptr;
+      std::uint64_t size;
+   };
+
+   struct ArchiveMember
+   {
+      std::string name;
+      std::uint64_t offset;
+      std::uint64_t size;
+      std::uint64_t deflated;
+      InflateLevel level;
+   };
+
+   /// @brief Inflate every source with `options` and bundle the results into an archive.
+   ///
+   /// Members are inflated on up to `threads` threads, or on every hardware thread with 0. Without a seed in
+   /// `options`, each member draws its own seed, in order, from the calling thread's context.
+   EXPORT ByteVec inflate_archive(const std::vector<ArchiveSource> &sources,
+                                  const InflateOptions &options=InflateOptions(),
+                                  std::size_t threads=0);
+
+   /// @brief Random access to the members of an archive, which is parsed up to its central directory only.
+   ///
+   /// A reader either views an archive in memory, which must outlive it, or maps a file read-only. Only the
+   /// pages of the members actually extracted are ever read from the file.
+   class ArchiveReader
+   {
+   protected:
+      const std::uint8_t *_data;
+      std::uint64_t _size;
+      void *_mapping;
+      std::vector<ArchiveMember> _members;
+      std::unordered_map<std::string, std::size_t> _index;
+
+      void parse();
+      void release() noexcept;
+
+   public:
+      EXPORT ArchiveReader(const void *ptr, std::uint64_t size);
+      EXPORT ArchiveReader(const ByteVec &vec);
+      EXPORT explicit ArchiveReader(const std::string &path);
+      ArchiveReader(const ArchiveReader &) = delete;
+      EXPORT ArchiveReader(ArchiveReader &&other) noexcept;
+      ~ArchiveReader() { this->release(); }
+
+      ArchiveReader &operator=(const ArchiveReader &) = delete;
+      EXPORT ArchiveReader &operator=(ArchiveReader &&other) noexcept;
+
+      const std::vector<ArchiveMember> &members() const noexcept { return this->_members; }
+
+      /// @brief The member called `name`, or `nullptr`. If several members share the name, the first is found.
+      EXPORT const ArchiveMember *find(const std::string &name) const noexcept;
+
+      /// @brief The member's `NFLV` stream, in place within the archive.
+      const std::uint8_t *member_data(const ArchiveMember &member) const noexcept { return this->_data + member.offset; }
+
+      /// @brief Parse the member's header and locate its payload, without deflating it.
+      EXPORT InflateContainer container(const ArchiveMember &member) const;
+
+      /// @brief Deflate and validate one member. Throws `exception::MemberNotFound` for an unknown name.
+      EXPORT ByteVec extract(const ArchiveMember &member) const;
+      EXPORT ByteVec extract(const std::string &name) const;
+   };
+}
+
+#endif
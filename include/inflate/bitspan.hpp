@@ -0,0 +1,207 @@
+#ifndef __INFLATE_BITSPAN_HPP
+#define __INFLATE_BITSPAN_HPP
+
+/// @file bitspan.hpp
+/// @brief Non-owning views of bit ranges that may start at any bit, and the word-level kernels beneath them.
+///
+/// A span is a pointer, a bit offset and a length, so slicing never allocates or copies. Like `std::span`,
+/// constness is shallow: a `const BitSpan` still writes through to the bits it views. `ConstBitSpan` is the
+/// read-only flavor, and every `BitSpan` converts to one.
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <inflate/platform.hpp>
+#include <inflate/exception.hpp>
+
+namespace inflate
+{
+   /// @brief Word-level kernels over the bits `[first, last)` of LSB-first data, 64 bits at a time. They do no
+   /// checks of their own; spans and the bitstream algorithms check their ranges once and then call these.
+   EXPORT std::uint64_t count_bits(const std::uint8_t *data, std::uint64_t first, std::uint64_t last, bool value) noexcept;
+
+   /// @brief The index of the first bit equal to `value`, or `last` if there is none.
+   EXPORT std::uint64_t find_bit(const std::uint8_t *data, std::uint64_t first, std::uint64_t last, bool value) noexcept;
+   EXPORT void fill_bits(std::uint8_t *data, std::uint64_t first, std::uint64_t last, bool value) noexcept;
+
+   /// @brief Copy the bits to `output` starting at bit `output_first`. Overlapping ranges are only supported
+   /// when the output starts at or before the input, as with `std::copy`.
+   EXPORT void copy_bits(const std::uint8_t *input,
+                         std::uint64_t first,
+                         std::uint64_t last,
+                         std::uint8_t *output,
+                         std::uint64_t output_first) noexcept;
+   EXPORT bool equal_bits(const std::uint8_t *left,
+                          std::uint64_t first,
+                          std::uint64_t last,
+                          const std::uint8_t *right,
+                          std::uint64_t right_first) noexcept;
+
+   template <typename Byte>
+   class BasicBitSpan
+   {
+      static_assert(std::is_same<std::remove_const_t<Byte>, std::uint8_t>::value, "a bit span views std::uint8_t data");
+
+      template <typename> friend class BasicBitSpan;
+
+   protected:
+      Byte *_data;
+      std::uint64_t _offset;
+      std::uint64_t _size;
+
+      void check_range(std::uint64_t index, std::uint64_t size) const {
+         if (index > this->_size || size > this->_size - index)
+            throw exception::OutOfBounds(index+size, this->_size);
+
+         if (this->_data == nullptr && size != 0)
+            throw exception::NullPointer();
+      }
+
+   public:
+      static constexpr bool is_mutable = !std::is_const<Byte>::value;
+
+      constexpr BasicBitSpan() noexcept : _data(nullptr), _offset(0), _size(0) {}
+
+      /// @brief View `size` bits of `data`, starting at bit `offset`.
+      constexpr BasicBitSpan(Byte *data, std::uint64_t offset, std::uint64_t size) noexcept
+         : _data((data == nullptr) ? data : data + offset / 8), _offset(offset % 8), _size(size) {}
+
+      template <typename Other,
+                std::enable_if_t<!std::is_const<Other>::value && std::is_const<Byte>::value, int> = 0>
+      constexpr BasicBitSpan(const BasicBitSpan<Other> &other) noexcept
+         : _data(other._data), _offset(other._offset), _size(other._size) {}
+
+      /// @brief The byte holding the first bit, and the first bit's position within it.
+      constexpr Byte *data() const noexcept { return this->_data; }
+      constexpr std::uint64_t offset() const noexcept { return this->_offset; }
+      constexpr std::uint64_t bit_size() const noexcept { return this->_size; }
+      constexpr bool empty() const noexcept { return this->_size == 0; }
+
+      bool get_bit(std::uint64_t index) const {
+         if (index >= this->_size)
+            throw exception::OutOfBounds(index, this->_size);
+
+         this->check_range(index, 1);
+
+         auto bit = this->_offset + index;
+         return static_cast<bool>((this->_data[bit / 8] >> (bit % 8)) & 1);
+      }
+      bool operator[](std::uint64_t index) const { return this->get_bit(index); }
+
+      template <bool Mutable = is_mutable, std::enable_if_t<Mutable, int> = 0>
+      void set_bit(std::uint64_t index, bool bit) const {
+         if (index >= this->_size)
+            throw exception::OutOfBounds(index, this->_size);
+
+         this->check_range(index, 1);
+         fill_bits(this->_data, this->_offset+index, this->_offset+index+1, bit);
+      }
+
+      /// @brief The `size` bits starting at `index`, viewing the same data.
+      BasicBitSpan subspan(std::uint64_t index, std::uint64_t size) const {
+         this->check_range(index, size);
+         return BasicBitSpan(this->_data, this->_offset+index, size);
+      }
+      BasicBitSpan subspan(std::uint64_t index) const {
+         if (index > this->_size)
+            throw exception::OutOfBounds(index, this->_size);
+
+         return this->subspan(index, this->_size - index);
+      }
+      BasicBitSpan first(std::uint64_t size) const { return this->subspan(0, size); }
+      BasicBitSpan last(std::uint64_t size) const {
+         if (size > this->_size)
+            throw exception::OutOfBounds(size, this->_size);
+
+         return this->subspan(this->_size - size, size);
+      }
+
+      std::uint64_t count(bool value) const {
+         this->check_range(0, this->_size);
+         return count_bits(this->_data, this->_offset, this->_offset+this->_size, value);
+      }
+
+      /// @brief The index of the first bit equal to `value`, or `bit_size()` if there is none.
+      std::uint64_t find(bool value) const {
+         this->check_range(0, this->_size);
+         return find_bit(this->_data, this->_offset, this->_offset+this->_size, value) - this->_offset;
+      }
+
+      template <bool Mutable = is_mutable, std::enable_if_t<Mutable, int> = 0>
+      void fill(bool value) const {
+         this->check_range(0, this->_size);
+         fill_bits(this->_data, this->_offset, this->_offset+this->_size, value);
+      }
+
+      /// @brief Whether the bytes underneath the two spans overlap.
+      template <typename Other>
+      bool overlaps(const BasicBitSpan<Other> &other) const noexcept {
+         if (this->empty() || other.empty())
+            return false;
+
+         auto begin = reinterpret_cast<std::uintptr_t>(this->_data);
+         auto end = begin + (this->_offset + this->_size + 7) / 8;
+         auto other_begin = reinterpret_cast<std::uintptr_t>(other._data);
+         auto other_end = other_begin + (other._offset + other._size + 7) / 8;
+
+         return begin < other_end && other_begin < end;
+      }
+
+      /// @brief Copy these bits to the start of `output`, which must be at least as long. Overlapping spans
+      /// are handled, at the cost of a temporary copy.
+      void copy_to(const BasicBitSpan<std::uint8_t> &output) const {
+         if (output._size < this->_size)
+            throw exception::OutOfBounds(this->_size, output._size);
+
+         this->check_range(0, this->_size);
+         output.check_range(0, this->_size);
+
+         if (this->overlaps(output))
+         {
+            std::vector<std::uint8_t> copy((this->_offset + this->_size + 7) / 8);
+            copy_bits(this->_data, this->_offset, this->_offset+this->_size, copy.data(), this->_offset);
+            copy_bits(copy.data(), this->_offset, this->_offset+this->_size, output._data, output._offset);
+         }
+         else
+            copy_bits(this->_data, this->_offset, this->_offset+this->_size, output._data, output._offset);
+      }
+
+      /// @brief Copy all of `input` to the start of this span.
+      template <bool Mutable = is_mutable, std::enable_if_t<Mutable, int> = 0>
+      void copy_from(const BasicBitSpan<const std::uint8_t> &input) const { input.copy_to(*this); }
+
+      template <typename Other>
+      bool operator==(const BasicBitSpan<Other> &other) const {
+         if (this->_size != other._size)
+            return false;
+
+         this->check_range(0, this->_size);
+         other.check_range(0, other._size);
+
+         return equal_bits(this->_data, this->_offset, this->_offset+this->_size, other._data, other._offset);
+      }
+      template <typename Other>
+      bool operator!=(const BasicBitSpan<Other> &other) const { return !(*this == other); }
+
+      std::vector<bool> to_bitvec() const {
+         this->check_range(0, this->_size);
+
+         std::vector<bool> result(this->_size);
+
+         for (std::uint64_t i=0; i<this->_size; ++i)
+         {
+            auto bit = this->_offset + i;
+            result[i] = static_cast<bool>((this->_data[bit / 8] >> (bit % 8)) & 1);
+         }
+
+         return result;
+      }
+   };
+
+   using BitSpan = BasicBitSpan<std::uint8_t>;
+   using ConstBitSpan = BasicBitSpan<const std::uint8_t>;
+}
+
+#endif
@@ -7,9 +7,13 @@
 #include <cstring>
 #include <vector>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 
 #include <inflate/platform.hpp>
 #include <inflate/exception.hpp>
+#include <inflate/bitspan.hpp>
 
 namespace inflate
 {
@@ -20,28 +24,128 @@ namespace inflate
    EXPORT ByteVec to_bytevec(const BitVec &bit_vec);
 
    class BitstreamVec;
-   
+
+   /// @brief A read-only view of `size` bits of data. `MutBitstreamPtr` adds the writing half, so writing
+   /// through a view of const data is a compile error rather than a runtime check.
+   ///
+   /// A view of a null pointer must be empty, which the constructors check once. The accessors then only
+   /// check their bounds.
    EXPORT
-   class BitstreamPtr
+   class ConstBitstreamPtr
    {
    protected:
-      union {
-         std::uint8_t *m;
-         const std::uint8_t *c;
-      } _data;
-      
+      const std::uint8_t *_data;
       std::uint64_t _size;
 
-      bool _const;
+   public:
+      class const_iterator {
+         friend ConstBitstreamPtr;
+         
+         const ConstBitstreamPtr *_stream;
+         std::uint64_t _index;
+
+         const_iterator(const ConstBitstreamPtr *stream, std::uint64_t index) : _stream(stream), _index(index) {}
+         
+      public:
+         using iterator_category = std::random_access_iterator_tag;
+         using difference_type = std::ptrdiff_t;
+         using value_type = bool;
+         using pointer = bool *;
+         using reference = bool;
+
+         const_iterator() : _stream(nullptr), _index(0) {}
+         const_iterator(const const_iterator &other) : _stream(other._stream), _index(other._index) {}
+         /// @brief Convert from `MutBitstreamPtr::iterator`, which is declared further down.
+         template <typename It, std::enable_if_t<std::is_convertible<decltype(std::declval<const It &>().stream()), const ConstBitstreamPtr *>::value
+                                                 && !std::is_same<It, const_iterator>::value, int> = 0>
+         const_iterator(const It &other) : _stream(other.stream()), _index(other.index()) {}
+
+         const_iterator &operator=(const const_iterator &other) { this->_stream = other._stream; this->_index = other._index; return *this; }
+         bool operator==(const const_iterator &other) const { return this->_stream == other._stream && this->_index == other._index; }
+         bool operator!=(const const_iterator &other) const { return !(*this == other); }
+         bool operator<(const const_iterator &other) const { return this->_index < other._index; }
+         bool operator>(const const_iterator &other) const { return other < *this; }
+         bool operator<=(const const_iterator &other) const { return !(other < *this); }
+         bool operator>=(const const_iterator &other) const { return !(*this < other); }
+         
+         const_iterator &operator++() { this->_index++; return *this; }
+         const_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+         
+         const_iterator &operator--() { this->_index--; return *this; }
+         const_iterator operator--(int) { auto tmp = *this; --(*this); return tmp; }
+
+         const_iterator &operator+=(difference_type offset) { this->_index += offset; return *this; }
+         const_iterator &operator-=(difference_type offset) { this->_index -= offset; return *this; }
+         const_iterator operator+(difference_type offset) const { auto tmp = *this; return tmp += offset; }
+         const_iterator operator-(difference_type offset) const { auto tmp = *this; return tmp -= offset; }
+         friend const_iterator operator+(difference_type offset, const const_iterator &it) { return it + offset; }
+         difference_type operator-(const const_iterator &other) const {
+            return static_cast<difference_type>(this->_index) - static_cast<difference_type>(other._index);
+         }
+
+         const reference operator*() const {
+            if (this->_stream == nullptr)
+               throw exception::NullPointer();
+            
+            return this->_stream->get_bit(this->_index);
+         }
+         reference operator[](difference_type offset) const { return *(*this + offset); }
+
+         const ConstBitstreamPtr *stream() const { return this->_stream; }
+         std::uint64_t index() const { return this->_index; }
+      };
+
+      ConstBitstreamPtr() : _data(nullptr), _size(0) {}
+      EXPORT ConstBitstreamPtr(const std::uint8_t *data, std::uint64_t size);
+      ConstBitstreamPtr(const ConstBitstreamPtr &other) : _data(other._data), _size(other._size) {}
+
+      ConstBitstreamPtr &operator=(const ConstBitstreamPtr &other) { this->_data = other._data; this->_size = other._size; return *this; }
+      EXPORT bool operator[](std::uint64_t index) const;
+      EXPORT bool operator==(const ConstBitstreamPtr &other) const;
+      bool operator!=(const ConstBitstreamPtr &other) const { return !(*this == other); }
+      EXPORT bool operator==(const BitVec &other) const;
+      bool operator!=(const BitVec &other) const { return !(*this == other); }
+      bool operator==(const ConstBitSpan &other) const { return this->span() == other; }
+      bool operator!=(const ConstBitSpan &other) const { return !(*this == other); }
+
+      const_iterator begin() const { return const_iterator(this, 0); }
+      const_iterator end() const { return const_iterator(this, this->_size); }
+      const_iterator cbegin() const { return const_iterator(this, 0); }
+      const_iterator cend() const { return const_iterator(this, this->_size); }
+
+      EXPORT bool get_bit(std::uint64_t index) const;
+      EXPORT std::uint8_t get_byte(std::uint64_t index) const;
+
+      std::uint64_t bit_size() const { return this->_size; }
+      std::uint64_t byte_size() const { return this->_size / 8 + static_cast<std::uint64_t>(this->_size % 8 != 0); }
+
+      const std::uint8_t *data() const { return this->_data; }
+
+      /// @brief Views of the stream, or of `size` bits starting at `index`, which don't copy anything.
+      ConstBitSpan span() const { return ConstBitSpan(this->_data, 0, this->_size); }
+      ConstBitSpan span(std::uint64_t index, std::uint64_t size) const { return this->span().subspan(index, size); }
+      operator ConstBitSpan() const { return this->span(); }
+      EXPORT void set_data(const std::uint8_t *data, std::uint64_t size);
+
+      EXPORT BitstreamVec read_bits(std::uint64_t index, std::uint64_t size) const;
+
+      EXPORT BitVec to_bitvec() const;
+      EXPORT ByteVec to_bytevec() const;
+      EXPORT BitstreamVec to_vec() const;
+   };
 
+   /// @brief A view of `size` bits of writable data. It converts to a `ConstBitstreamPtr`, but never back.
+   EXPORT
+   class MutBitstreamPtr : public ConstBitstreamPtr
+   {
    public:
       class reference {
-         friend BitstreamPtr;
+         friend MutBitstreamPtr;
          
-         BitstreamPtr *_stream;
+         MutBitstreamPtr *_stream;
          std::uint64_t _index;
 
-         reference(BitstreamPtr *stream, std::uint64_t index) : _stream(stream), _index(index) {}
+         reference(MutBitstreamPtr *stream, std::uint64_t index) : _stream(stream), _index(index) {}
 
       public:
          reference() : _stream(nullptr), _index(0) {}
@@ -73,26 +177,30 @@ namespace inflate
       };
 
       class iterator {
-         friend BitstreamPtr;
+         friend MutBitstreamPtr;
          
-         BitstreamPtr *_stream;
+         MutBitstreamPtr *_stream;
          std::uint64_t _index;
 
-         iterator(BitstreamPtr *stream, std::uint64_t index) : _stream(stream), _index(index) {}
+         iterator(MutBitstreamPtr *stream, std::uint64_t index) : _stream(stream), _index(index) {}
          
       public:
-         using iterator_category = std::forward_iterator_tag;
+         using iterator_category = std::random_access_iterator_tag;
          using difference_type = std::ptrdiff_t;
          using value_type = bool;
-         using pointer = BitstreamPtr::reference *;
-         using reference = BitstreamPtr::reference;
+         using pointer = MutBitstreamPtr::reference *;
+         using reference = MutBitstreamPtr::reference;
 
          iterator() : _stream(nullptr), _index(0) {}
          iterator(const iterator &other) : _stream(other._stream), _index(other._index) {}
 
-         iterator &operator=(const iterator &other) { this->_stream = other._stream; this->_index = other._index; }
+         iterator &operator=(const iterator &other) { this->_stream = other._stream; this->_index = other._index; return *this; }
          bool operator==(const iterator &other) const { return this->_stream == other._stream && this->_index == other._index; }
          bool operator!=(const iterator &other) const { return !(*this == other); }
+         bool operator<(const iterator &other) const { return this->_index < other._index; }
+         bool operator>(const iterator &other) const { return other < *this; }
+         bool operator<=(const iterator &other) const { return !(other < *this); }
+         bool operator>=(const iterator &other) const { return !(*this < other); }
 
          iterator &operator++() { this->_index++; return *this; }
          iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
@@ -100,6 +208,15 @@ namespace inflate
          iterator &operator--() { this->_index--; return *this; }
          iterator operator--(int) { auto tmp = *this; --(*this); return tmp; }
 
+         iterator &operator+=(difference_type offset) { this->_index += offset; return *this; }
+         iterator &operator-=(difference_type offset) { this->_index -= offset; return *this; }
+         iterator operator+(difference_type offset) const { auto tmp = *this; return tmp += offset; }
+         iterator operator-(difference_type offset) const { auto tmp = *this; return tmp -= offset; }
+         friend iterator operator+(difference_type offset, const iterator &it) { return it + offset; }
+         difference_type operator-(const iterator &other) const {
+            return static_cast<difference_type>(this->_index) - static_cast<difference_type>(other._index);
+         }
+
          reference operator*() {
             if (this->_stream == nullptr)
                throw exception::NullPointer();
@@ -112,123 +229,173 @@ namespace inflate
             
             return this->_stream->operator[](this->_index);
          }
+         reference operator[](difference_type offset) const { return *(*this + offset); }
+
+         MutBitstreamPtr *stream() const { return this->_stream; }
+         std::uint64_t index() const { return this->_index; }
       };
 
-      class const_iterator {
-         friend BitstreamPtr;
-         
-         const BitstreamPtr *_stream;
-         std::uint64_t _index;
+      MutBitstreamPtr() : ConstBitstreamPtr() {}
+      MutBitstreamPtr(std::uint8_t *data, std::uint64_t size) : ConstBitstreamPtr(data, size) {}
+      MutBitstreamPtr(const MutBitstreamPtr &other) : ConstBitstreamPtr(other) {}
 
-         const_iterator(const BitstreamPtr *stream, std::uint64_t index) : _stream(stream), _index(index) {}
-         
-      public:
-         using iterator_category = std::forward_iterator_tag;
-         using difference_type = std::ptrdiff_t;
-         using value_type = bool;
-         using pointer = bool *;
-         using reference = bool;
+      MutBitstreamPtr &operator=(const MutBitstreamPtr &other) { ConstBitstreamPtr::operator=(other); return *this; }
 
-         const_iterator() : _stream(nullptr), _index(0) {}
-         const_iterator(const const_iterator &other) : _stream(other._stream), _index(other._index) {}
-
-         const_iterator &operator=(const const_iterator &other) { this->_stream = other._stream; this->_index = other._index; }
-         bool operator==(const const_iterator &other) const { return this->_stream == other._stream && this->_index == other._index; }
-         bool operator!=(const const_iterator &other) const { return !(*this == other); }
-         
-         const_iterator &operator++() { this->_index++; return *this; }
-         const_iterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
-         
-         const_iterator &operator--() { this->_index--; return *this; }
-         const_iterator operator--(int) { auto tmp = *this; --(*this); return tmp; }
-
-         const reference operator*() const {
-            if (this->_stream == nullptr)
-               throw exception::NullPointer();
-            
-            return this->_stream->get_bit(this->_index);
-         }
-      };
-
-      BitstreamPtr() : _size(0), _const(false) { this->_data.m = nullptr; }
-      BitstreamPtr(std::uint8_t *data, std::uint64_t size) : _size(size), _const(false) { this->_data.m = data; }
-      BitstreamPtr(const std::uint8_t *data, std::uint64_t size) : _size(size), _const(true) { this->_data.c = data; }
-      BitstreamPtr(const BitstreamPtr &other) : _data(other._data), _size(other._size), _const(other._const) {}
-
-      BitstreamPtr &operator=(const BitstreamPtr &other);
-      reference operator[](std::uint64_t index);
-      bool operator[](std::uint64_t index) const;
-      bool operator==(const BitstreamPtr &other) const;
-      bool operator!=(const BitstreamPtr &other) const { return !(*this == other); }
-      bool operator==(const BitVec &other) const;
-      bool operator!=(const BitVec &other) const { return !(*this == other); }
+      using ConstBitstreamPtr::operator[];
+      EXPORT reference operator[](std::uint64_t index);
 
+      using ConstBitstreamPtr::begin;
+      using ConstBitstreamPtr::end;
       iterator begin() { return iterator(this, 0); }
       iterator end() { return iterator(this, this->_size); }
 
-      const_iterator cbegin() const { return const_iterator(this, 0); }
-      const_iterator cend() const { return const_iterator(this, this->_size); }
-
-      bool get_bit(std::uint64_t index) const;
-      void set_bit(std::uint64_t index, bool bit);
-      void flip_bit(std::uint64_t index);
-
-      std::uint8_t get_byte(std::uint64_t index) const;
-      void set_byte(std::uint64_t index, std::uint8_t byte);
+      EXPORT void set_bit(std::uint64_t index, bool bit);
+      EXPORT void flip_bit(std::uint64_t index);
+      EXPORT void set_byte(std::uint64_t index, std::uint8_t byte);
 
-      std::uint64_t bit_size() const;
-      std::uint64_t byte_size() const;
+      /// @brief The writable data. The pointer was writable when the view was made, so this is only a cast.
+      std::uint8_t *mutable_data() const { return const_cast<std::uint8_t *>(this->_data); }
 
-      const std::uint8_t *data() const;
-      void set_data(std::uint8_t *data, std::uint64_t size);
-      void set_data(const std::uint8_t *data, std::uint64_t size);
+      BitSpan mutable_span() const { return BitSpan(this->mutable_data(), 0, this->_size); }
+      BitSpan mutable_span(std::uint64_t index, std::uint64_t size) const { return this->mutable_span().subspan(index, size); }
+      void set_data(std::uint8_t *data, std::uint64_t size) { ConstBitstreamPtr::set_data(data, size); }
 
-      BitstreamVec read_bits(std::uint64_t index, std::uint64_t size) const;
-      void write_bits(std::uint64_t index, const BitVec &bits);
-      void write_bits(std::uint64_t index, const BitstreamPtr &bits);
-
-      BitVec to_bitvec() const;
-      ByteVec to_bytevec() const;
-      BitstreamVec to_vec() const;
+      EXPORT void write_bits(std::uint64_t index, const BitVec &bits);
+      EXPORT void write_bits(std::uint64_t index, const ConstBitstreamPtr &bits);
+      EXPORT void write_bits(std::uint64_t index, const ConstBitSpan &bits);
    };
 
+   /// @brief The name streams had before the const and mutable halves were split, kept for source compatibility.
+   using BitstreamPtr = MutBitstreamPtr;
+
    EXPORT
-   class BitstreamVec : public BitstreamPtr
+   class BitstreamVec : public MutBitstreamPtr
    {
    protected:
       ByteVec _vec;
       
    public:
-      BitstreamVec() : _vec(ByteVec()), BitstreamPtr() { this->set_data(this->_vec.data(), this->_vec.size()*8); }
-      BitstreamVec(std::uint64_t size) : BitstreamPtr() {
+      BitstreamVec() : _vec(ByteVec()), MutBitstreamPtr() { this->set_data(this->_vec.data(), this->_vec.size()*8); }
+      BitstreamVec(std::uint64_t size) : MutBitstreamPtr() {
          this->_vec = ByteVec(size/8 + static_cast<std::uint64_t>(size % 8 != 0), 0);
          this->set_data(this->_vec.data(), size);
       }
       BitstreamVec(const std::uint8_t *data, std::uint64_t size)
          : _vec(data, data+(size/8+static_cast<std::uint64_t>(size%8!=0))),
-           BitstreamPtr()
+           MutBitstreamPtr()
       {
          this->set_data(this->_vec.data(), size);
       }
-      BitstreamVec(const ByteVec &vec, std::uint64_t size) : _vec(vec), BitstreamPtr() { this->set_data(this->_vec.data(), size); }
-      BitstreamVec(const BitstreamVec &other) : _vec(other._vec), BitstreamPtr(other) { this->set_data(this->_vec.data(), this->_size); }
+      BitstreamVec(const ByteVec &vec, std::uint64_t size) : _vec(vec), MutBitstreamPtr() { this->set_data(this->_vec.data(), size); }
+      explicit BitstreamVec(const ConstBitSpan &bits) : BitstreamVec(bits.bit_size()) { bits.copy_to(this->mutable_span()); }
+      BitstreamVec(ByteVec &&vec, std::uint64_t size) : _vec(std::move(vec)), MutBitstreamPtr() { this->set_data(this->_vec.data(), size); }
+      BitstreamVec(const BitstreamVec &other) : _vec(other._vec), MutBitstreamPtr(other) { this->set_data(this->_vec.data(), this->_size); }
+      BitstreamVec(BitstreamVec &&other) noexcept : _vec(std::move(other._vec)), MutBitstreamPtr(other) {
+         this->set_data(this->_vec.data(), this->_size);
+         other._vec.clear();
+         other.set_data(other._vec.data(), 0);
+      }
 
       BitstreamVec &operator=(const BitstreamVec &other);
+      BitstreamVec &operator=(BitstreamVec &&other) noexcept;
 
+      /// @brief Resize to `bits` bits. New bits are zero, and growing past the capacity at least doubles it,
+      /// so appending one bit at a time costs amortized O(1).
       void resize(std::uint64_t bits);
 
+      /// @brief Make room for `bits` bits without changing the size. Like any reallocation, this moves the data.
+      void reserve(std::uint64_t bits);
+      std::uint64_t capacity() const noexcept { return static_cast<std::uint64_t>(this->_vec.capacity()) * 8; }
+
       void push_bit(bool bit);
       void push_bits(const BitVec &bits);
+      void push_bits(const ConstBitSpan &bits);
 
       bool pop_bit();
       BitstreamVec pop_bits(std::uint64_t bits);
 
       void insert_bit(std::uint64_t index, bool bit);
       void insert_bits(std::uint64_t index, const BitVec &bits);
+      void insert_bits(std::uint64_t index, const ConstBitSpan &bits);
 
       void erase_bit(std::uint64_t index);
       void erase_bits(std::uint64_t index, std::uint64_t size);
    };
+
+   template <typename It>
+   struct is_bitstream_iterator : std::integral_constant<bool,
+                                                         std::is_same<It, MutBitstreamPtr::iterator>::value
+                                                         || std::is_same<It, ConstBitstreamPtr::const_iterator>::value> {};
+
+namespace detail
+{
+   /// @brief Check that `[first, last)` lies within the stream and return the stream's data. Like the standard
+   /// algorithms, both ends of a range are assumed to come from the same stream.
+   EXPORT const std::uint8_t *bit_range(const ConstBitstreamPtr *stream, std::uint64_t first, std::uint64_t last);
+}
+
+   /// @brief Counterparts of the standard algorithms for bitstream iterators, found by argument-dependent
+   /// lookup. An unqualified call, such as `count(stream.cbegin(), stream.cend(), true)` after
+   /// `using std::count;`, picks these over the per-bit generic versions. The range is checked once, and
+   /// the work is done on 64-bit words.
+   template <typename It, std::enable_if_t<is_bitstream_iterator<It>::value, int> = 0>
+   std::ptrdiff_t count(It first, It last, bool value) {
+      auto data = detail::bit_range(first.stream(), first.index(), last.index());
+      return static_cast<std::ptrdiff_t>(count_bits(data, first.index(), last.index(), value));
+   }
+
+   template <typename It, std::enable_if_t<is_bitstream_iterator<It>::value, int> = 0>
+   It find(It first, It last, bool value) {
+      auto data = detail::bit_range(first.stream(), first.index(), last.index());
+      return first + static_cast<std::ptrdiff_t>(find_bit(data, first.index(), last.index(), value) - first.index());
+   }
+
+   inline void fill(MutBitstreamPtr::iterator first, MutBitstreamPtr::iterator last, bool value) {
+      detail::bit_range(first.stream(), first.index(), last.index());
+      fill_bits(first.stream()->mutable_data(), first.index(), last.index(), value);
+   }
+
+   template <typename It, std::enable_if_t<is_bitstream_iterator<It>::value, int> = 0>
+   MutBitstreamPtr::iterator copy(It first, It last, MutBitstreamPtr::iterator output) {
+      auto data = detail::bit_range(first.stream(), first.index(), last.index());
+      auto size = last.index() - first.index();
+      auto output_end = output + static_cast<std::ptrdiff_t>(size);
+
+      detail::bit_range(output.stream(), output.index(), output_end.index());
+      copy_bits(data, first.index(), last.index(), output.stream()->mutable_data(), output.index());
+
+      return output_end;
+   }
+
+   /// @brief Copy to any other output, such as a `std::back_inserter`, without the per-bit checks.
+   template <typename OutputIt, std::enable_if_t<!is_bitstream_iterator<OutputIt>::value, int> = 0>
+   OutputIt copy(ConstBitstreamPtr::const_iterator first, ConstBitstreamPtr::const_iterator last, OutputIt output) {
+      auto data = detail::bit_range(first.stream(), first.index(), last.index());
+
+      for (auto index=first.index(); index<last.index(); ++index)
+         *output++ = static_cast<bool>((data[index / 8] >> (index % 8)) & 1);
+
+      return output;
+   }
+
+   template <typename OutputIt, std::enable_if_t<!is_bitstream_iterator<OutputIt>::value, int> = 0>
+   OutputIt copy(MutBitstreamPtr::iterator first, MutBitstreamPtr::iterator last, OutputIt output) {
+      return copy(ConstBitstreamPtr::const_iterator(first), ConstBitstreamPtr::const_iterator(last), output);
+   }
+
+   template <typename It, std::enable_if_t<is_bitstream_iterator<It>::value, int> = 0>
+   bool equal(ConstBitstreamPtr::const_iterator first, ConstBitstreamPtr::const_iterator last, It other) {
+      auto data = detail::bit_range(first.stream(), first.index(), last.index());
+      auto other_end = other + (last - first);
+      auto other_data = detail::bit_range(other.stream(), other.index(), other_end.index());
+
+      return equal_bits(data, first.index(), last.index(), other_data, other.index());
+   }
+
+   template <typename It, std::enable_if_t<is_bitstream_iterator<It>::value, int> = 0>
+   bool equal(MutBitstreamPtr::iterator first, MutBitstreamPtr::iterator last, It other) {
+      return equal(ConstBitstreamPtr::const_iterator(first), ConstBitstreamPtr::const_iterator(last), other);
+   }
 }
 
 #endif
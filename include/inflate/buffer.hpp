@@ -0,0 +1,107 @@
+#ifndef __INFLATE_BUFFER_HPP
+#define __INFLATE_BUFFER_HPP
+
+/// @file buffer.hpp
+/// @brief An uninitialized, page-backed byte buffer for multi-gigabyte outputs.
+///
+/// Unlike `ByteVec`, a `LargeBuffer` isn't zeroed on construction, so a transform that overwrites it writes
+/// every byte once. On POSIX systems it's an anonymous mapping, which the kernel backs with huge pages when
+/// asked: `MAP_HUGETLB` uses the reserved hugetlb pool, `MADV_HUGEPAGE` asks for transparent huge pages.
+/// Either cuts the number of page faults by a factor of 512 on x86-64. Elsewhere it falls back to the heap.
+///
+/// Pages are faulted in by whoever first writes them. That's the workers of `inflate_memory_parallel`, which
+/// keeps them NUMA-local, or the threads of `prefault` for callers that fill the buffer themselves.
+
+#include <cstdint>
+#include <cstddef>
+
+#include <inflate/platform.hpp>
+#include <inflate/bitstream.hpp>
+
+namespace inflate
+{
+   enum LargeBufferBacking
+   {
+      LARGE_BUFFER_EMPTY = 0,
+      LARGE_BUFFER_HEAP,
+      LARGE_BUFFER_MAPPED,
+      LARGE_BUFFER_HUGETLB,
+   };
+
+   struct LargeBufferOptions
+   {
+      /// @brief Ask for transparent huge pages with `MADV_HUGEPAGE`.
+      bool huge_pages = true;
+
+      /// @brief Try the hugetlb pool first, in pages of the system's default huge page size. Falls back to an
+      /// ordinary mapping when the pool is too small or that size is unknown.
+      bool hugetlb = false;
+   };
+
+   class LargeBuffer
+   {
+   protected:
+      std::uint8_t *_data;
+      std::size_t _size;
+      std::size_t _mapped;
+      LargeBufferBacking _backing;
+
+      void release() noexcept;
+
+   public:
+      LargeBuffer() : _data(nullptr), _size(0), _mapped(0), _backing(LargeBufferBacking::LARGE_BUFFER_EMPTY) {}
+
+      /// @brief Allocate `size` bytes of uninitialized memory. Throws `std::bad_alloc` if nothing can be mapped.
+      EXPORT LargeBuffer(std::size_t size, const LargeBufferOptions &options=LargeBufferOptions());
+      LargeBuffer(const LargeBuffer &) = delete;
+      LargeBuffer(LargeBuffer &&other) noexcept
+         : _data(other._data), _size(other._size), _mapped(other._mapped), _backing(other._backing)
+      {
+         other._data = nullptr;
+         other._size = 0;
+         other._mapped = 0;
+         other._backing = LargeBufferBacking::LARGE_BUFFER_EMPTY;
+      }
+      ~LargeBuffer() { this->release(); }
+
+      LargeBuffer &operator=(const LargeBuffer &) = delete;
+      LargeBuffer &operator=(LargeBuffer &&other) noexcept {
+         if (this != &other)
+         {
+            this->release();
+            this->_data = other._data;
+            this->_size = other._size;
+            this->_mapped = other._mapped;
+            this->_backing = other._backing;
+            other._data = nullptr;
+            other._size = 0;
+            other._mapped = 0;
+            other._backing = LargeBufferBacking::LARGE_BUFFER_EMPTY;
+         }
+
+         return *this;
+      }
+
+      std::uint8_t &operator[](std::size_t index) { return this->_data[index]; }
+      const std::uint8_t &operator[](std::size_t index) const { return this->_data[index]; }
+
+      std::uint8_t *data() noexcept { return this->_data; }
+      const std::uint8_t *data() const noexcept { return this->_data; }
+      std::size_t size() const noexcept { return this->_size; }
+      bool empty() const noexcept { return this->_size == 0; }
+      LargeBufferBacking backing() const noexcept { return this->_backing; }
+
+      std::uint8_t *begin() noexcept { return this->_data; }
+      std::uint8_t *end() noexcept { return this->_data + this->_size; }
+      const std::uint8_t *begin() const noexcept { return this->_data; }
+      const std::uint8_t *end() const noexcept { return this->_data + this->_size; }
+
+      /// @brief Fault every page in, split over `threads` threads (0 uses every hardware thread). The contents
+      /// are left as they are.
+      EXPORT void prefault(std::size_t threads=0) noexcept;
+
+      EXPORT ByteVec to_bytevec() const;
+   };
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef __INFLATE_CHECKSUM_HPP
+#define __INFLATE_CHECKSUM_HPP
+
+/// @file checksum.hpp
+/// @brief The checksums which can be recorded in a versioned header.
+///
+/// `crc32` is declared in `utility.hpp` for compatibility. `crc32` folds with PCLMUL and `crc32c` uses the SSE4.2
+/// `crc32` instruction when the active CPU tier allows it (see `cpu.hpp`); both fall back to tables otherwise.
+/// Every variant gives the same result.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <inflate/platform.hpp>
+#include <inflate/format.hpp>
+
+namespace inflate
+{
+   /// @brief The CRC32C (Castagnoli) of the buffer.
+   EXPORT std::uint32_t crc32c(const void *ptr, std::size_t size, std::uint32_t init_crc=0);
+   EXPORT std::uint32_t crc32c(const std::vector<std::uint8_t> &vec, std::uint32_t init_crc=0);
+
+   /// @brief The CRC32 of the concatenation of two buffers, given the CRC32 of each and the size of the second.
+   ///
+   /// Runs in O(log size_b), so checksums of chunks processed independently can be joined without
+   /// touching the data again.
+   EXPORT std::uint32_t crc32_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t size_b);
+   EXPORT std::uint32_t crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t size_b);
+
+   /// @brief Compute `crc32` with up to `threads` threads, each checksumming one chunk. Pass 0 to use every
+   /// hardware thread.
+   ///
+   /// Chunks are at least 1 MiB, so small buffers are checksummed on the calling thread.
+   EXPORT std::uint32_t crc32_parallel(const void *ptr, std::size_t size, std::size_t threads=0, std::uint32_t init_crc=0);
+   EXPORT std::uint32_t crc32_parallel(const std::vector<std::uint8_t> &vec, std::size_t threads=0, std::uint32_t init_crc=0);
+
+   /// @brief The 64-bit xxHash of the buffer.
+   EXPORT std::uint64_t xxh64(const void *ptr, std::size_t size, std::uint64_t seed=0);
+   EXPORT std::uint64_t xxh64(const std::vector<std::uint8_t> &vec, std::uint64_t seed=0);
+
+   constexpr bool is_supported_checksum(std::uint8_t type) noexcept {
+      return type <= ChecksumType::CHECKSUM_XXH64;
+   }
+
+   /// @brief The checksum of the given type, widened to 64 bits. Returns 0 for an unsupported type.
+   EXPORT std::uint64_t checksum(ChecksumType type, const void *ptr, std::size_t size) noexcept;
+}
+
+#endif
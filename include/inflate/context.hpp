@@ -0,0 +1,127 @@
+#ifndef __INFLATE_CONTEXT_HPP
+#define __INFLATE_CONTEXT_HPP
+
+/// @file context.hpp
+/// @brief Reusable state for repeated inflate and deflate calls.
+///
+/// An `InflateContext` owns a seed generator and the buffers results are written into. The buffers grow to the
+/// largest request seen so far and are reused afterwards, so a long-lived context stops allocating once it has
+/// warmed up. A context is not thread-safe: give each thread its own. The free functions in `inflate.hpp` run
+/// on a per-thread context, see `thread_context()`.
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include <inflate/platform.hpp>
+#include <inflate/bitstream.hpp>
+#include <inflate/format.hpp>
+
+namespace inflate
+{
+   class InflateContext
+   {
+      std::uint64_t _seed_state;
+      ByteVec _output;
+      ByteVec _scratch;
+
+   public:
+      /// @brief Create a context. Without a seed, the seed generator is seeded from `std::random_device`.
+      EXPORT InflateContext(std::optional<std::uint64_t> seed=std::nullopt);
+
+      /// @brief The next seed for the RNG inflate levels, used whenever a call isn't given one. Never 0.
+      EXPORT std::uint32_t next_seed();
+
+      /// @brief The result of the last call returning a reference into this context.
+      const ByteVec &output() const { return this->_output; }
+
+      /// @brief A buffer for intermediate data, reused between calls.
+      ByteVec &scratch() { return this->_scratch; }
+
+      /// @brief The bytes currently reserved by the output and scratch buffers.
+      std::size_t capacity() const { return this->_output.capacity() + this->_scratch.capacity(); }
+
+      /// @brief Free the output and scratch buffers.
+      EXPORT void release();
+
+      /// @brief Inflate into the context's output buffer. The reference stays valid until the next call which
+      /// writes to it. The input may be `output()` itself, so results can be fed straight back in.
+      EXPORT std::pair<const ByteVec &, InflateHeader> inflate_memory(const void *ptr,
+                                                                      std::uint64_t size,
+                                                                      InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                                                      std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT std::pair<const ByteVec &, InflateHeader> inflate_memory(const ByteVec &vec,
+                                                                      InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                                                      std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT const ByteVec &deflate_memory(const void *ptr,
+                                           std::uint64_t size,
+                                           const InflateHeader &header,
+                                           bool validate=true);
+      EXPORT const ByteVec &deflate_memory(const ByteVec &vec,
+                                           const InflateHeader &header,
+                                           bool validate=true);
+      EXPORT const ByteVec &inflate_disk(const void *ptr,
+                                         std::uint64_t size,
+                                         InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                         std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT const ByteVec &inflate_disk(const ByteVec &vec,
+                                         InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                         std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT const ByteVec &deflate_disk(const void *ptr, std::uint64_t size);
+      EXPORT const ByteVec &deflate_disk(const ByteVec &vec);
+
+      /// @brief Versioned-header counterparts, see the free functions of the same name.
+      EXPORT std::pair<const ByteVec &, InflateHeaderV2> inflate_memory(const void *ptr,
+                                                                        std::uint64_t size,
+                                                                        const InflateOptions &options);
+      EXPORT std::pair<const ByteVec &, InflateHeaderV2> inflate_memory(const ByteVec &vec, const InflateOptions &options);
+      EXPORT const ByteVec &deflate_memory(const void *ptr,
+                                           std::uint64_t size,
+                                           const InflateHeaderV2 &header,
+                                           bool validate=true);
+      EXPORT const ByteVec &deflate_memory(const ByteVec &vec,
+                                           const InflateHeaderV2 &header,
+                                           bool validate=true);
+      EXPORT const ByteVec &inflate_disk(const void *ptr, std::uint64_t size, const InflateOptions &options);
+      EXPORT const ByteVec &inflate_disk(const ByteVec &vec, const InflateOptions &options);
+
+      /// @brief The same operations writing into a caller-owned vector, whose capacity is reused. When the input
+      /// lies inside `output`, the vector trades buffers with the context's scratch buffer instead.
+      EXPORT InflateHeader inflate_memory_into(ByteVec &output,
+                                               const void *ptr,
+                                               std::uint64_t size,
+                                               InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                               std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT void deflate_memory_into(ByteVec &output,
+                                      const void *ptr,
+                                      std::uint64_t size,
+                                      const InflateHeader &header,
+                                      bool validate=true);
+      EXPORT void inflate_disk_into(ByteVec &output,
+                                    const void *ptr,
+                                    std::uint64_t size,
+                                    InflateLevel level=InflateLevel::INFLATE_3BIT,
+                                    std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT void deflate_disk_into(ByteVec &output, const void *ptr, std::uint64_t size);
+      EXPORT InflateHeaderV2 inflate_memory_into(ByteVec &output,
+                                                 const void *ptr,
+                                                 std::uint64_t size,
+                                                 const InflateOptions &options);
+      EXPORT void deflate_memory_into(ByteVec &output,
+                                      const void *ptr,
+                                      std::uint64_t size,
+                                      const InflateHeaderV2 &header,
+                                      bool validate=true);
+      EXPORT void inflate_disk_into(ByteVec &output,
+                                    const void *ptr,
+                                    std::uint64_t size,
+                                    const InflateOptions &options);
+   };
+
+   /// @brief The context used by the free functions on the calling thread.
+   ///
+   /// Its buffers are reused by those functions, so references into them don't survive the next free call.
+   EXPORT InflateContext &thread_context();
+}
+
+#endif
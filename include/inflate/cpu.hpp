@@ -0,0 +1,104 @@
+#ifndef __INFLATE_CPU_HPP
+#define __INFLATE_CPU_HPP
+
+/// @file cpu.hpp
+/// @brief Runtime CPU feature detection and the dispatch of accelerated variants.
+///
+/// Features are detected once. Which of them may be used is capped by the active tier, which defaults to the
+/// best tier the CPU supports and can be lowered with the `INFLATE_CPU_TIER` environment variable (`generic`,
+/// `sse42`, `avx2` or `avx512`) or with `set_cpu_tier`. Operations with accelerated variants bind a function
+/// pointer through `CpuDispatch` on first use and rebind it whenever the tier changes. Every variant of an
+/// operation produces the same output, so the tier only affects speed.
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include <inflate/platform.hpp>
+
+namespace inflate
+{
+   enum CpuFeature
+   {
+      CPU_FEATURE_SSE42 = 1 << 0,
+      CPU_FEATURE_PCLMUL = 1 << 1,
+      CPU_FEATURE_BMI2 = 1 << 2,
+      CPU_FEATURE_AVX2 = 1 << 3,
+      CPU_FEATURE_AVX512 = 1 << 4,
+   };
+
+   /// @brief Each tier allows the features of the tiers below it plus its own: SSE4.2 and PCLMUL, then AVX2
+   /// and BMI2, then AVX-512 (F and BW).
+   enum CpuTier
+   {
+      CPU_TIER_GENERIC = 0,
+      CPU_TIER_SSE42,
+      CPU_TIER_AVX2,
+      CPU_TIER_AVX512,
+   };
+
+   struct CpuFeatures
+   {
+      std::uint32_t flags;
+
+      bool has(CpuFeature feature) const noexcept { return (this->flags & feature) == static_cast<std::uint32_t>(feature); }
+
+      /// @brief The highest tier whose features are all present.
+      EXPORT CpuTier tier() const noexcept;
+   };
+
+   /// @brief The features of the CPU, detected on the first call.
+   EXPORT const CpuFeatures &cpu_features() noexcept;
+
+   /// @brief The active tier.
+   EXPORT CpuTier cpu_tier() noexcept;
+
+   /// @brief Override the active tier, or restore the default with `std::nullopt`. Tiers above what the CPU
+   /// supports are capped to the best supported one. The override takes precedence over `INFLATE_CPU_TIER`.
+   EXPORT void set_cpu_tier(std::optional<CpuTier> tier) noexcept;
+
+   /// @brief Whether the CPU has `feature` and the active tier allows it.
+   EXPORT bool cpu_enabled(CpuFeature feature) noexcept;
+
+   EXPORT const char *cpu_tier_name(CpuTier tier) noexcept;
+
+   /// @brief Incremented whenever the active tier changes, which tells `CpuDispatch` to rebind.
+   EXPORT std::uint32_t cpu_dispatch_generation() noexcept;
+
+   /// @brief A function pointer chosen by `select` on first use, and chosen again after the tier changes.
+   ///
+   /// Racing threads may both call `select`. That's harmless, because every variant computes the same thing.
+   template <typename Fn>
+   class CpuDispatch
+   {
+      Fn (*_select)();
+      std::atomic<Fn> _bound;
+      std::atomic<std::uint32_t> _generation;
+
+   public:
+      constexpr CpuDispatch(Fn (*select)()) : _select(select), _bound(nullptr), _generation(0) {}
+
+      CpuDispatch(const CpuDispatch &) = delete;
+      CpuDispatch &operator=(const CpuDispatch &) = delete;
+
+      Fn get() noexcept {
+         auto generation = cpu_dispatch_generation();
+         auto bound = this->_bound.load(std::memory_order_acquire);
+
+         if (bound == nullptr || this->_generation.load(std::memory_order_relaxed) != generation)
+         {
+            bound = this->_select();
+            this->_bound.store(bound, std::memory_order_release);
+            this->_generation.store(generation, std::memory_order_relaxed);
+         }
+
+         return bound;
+      }
+
+      template <typename... Args>
+      auto operator()(Args&&... args) noexcept { return this->get()(std::forward<Args>(args)...); }
+   };
+}
+
+#endif
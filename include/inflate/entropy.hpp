@@ -0,0 +1,38 @@
+#ifndef __INFLATE_ENTROPY_HPP
+#define __INFLATE_ENTROPY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <inflate/platform.hpp>
+
+namespace inflate
+{
+   /// @brief A count of every byte value occurring in a buffer.
+   using Histogram = std::array<std::uint64_t, 256>;
+
+   /// @brief Count the bytes of the given buffer.
+   ///
+   /// Counting is spread over interleaved tables to avoid store-to-load stalls on runs of the same byte.
+   /// A `threads` value of 0 uses every available hardware thread; buffers too small to benefit are
+   /// always counted on the calling thread.
+   EXPORT Histogram histogram(const void *ptr, std::size_t size, std::size_t threads=1);
+   EXPORT Histogram histogram(const std::vector<std::uint8_t> &vec, std::size_t threads=1);
+
+   /// @brief Calculate the Shannon entropy, in bits per byte, of the given histogram.
+   EXPORT double entropy(const Histogram &histogram);
+   EXPORT double entropy(const void *ptr, std::size_t size, std::size_t threads=1);
+   EXPORT double entropy(const std::vector<std::uint8_t> &vec, std::size_t threads=1);
+
+   /// @brief Calculate the entropy of every `window`-sized block of the buffer, advancing by `step` bytes.
+   ///
+   /// Each window is derived from the previous one in constant time, so the whole scan is a single pass.
+   /// If the buffer is smaller than the window, no results are returned. A zero `window` or `step` throws
+   /// `exception::BadWindow`.
+   EXPORT std::vector<double> sliding_entropy(const void *ptr, std::size_t size, std::size_t window, std::size_t step=1);
+   EXPORT std::vector<double> sliding_entropy(const std::vector<std::uint8_t> &vec, std::size_t window, std::size_t step=1);
+}
+
+#endif
@@ -72,16 +72,22 @@ namespace exception
    class BadHeaderMagic : public Exception
    {
    public:
-      BadHeaderMagic() : Exception("Bad header magic: the magic bytes in the header of the inflate stream was not 'NFL8'.") {}
+      BadHeaderMagic() : Exception("Bad header magic: the magic bytes in the header of the inflate stream were not recognized.") {}
+   };
+
+   class BadHeader : public Exception
+   {
+   public:
+      BadHeader() : Exception("Bad header: the sizes in the inflate header are inconsistent with its level.") {}
    };
 
    class BadCRC : public Exception
    {
    public:
-      std::uint32_t given;
-      std::uint32_t expected;
+      std::uint64_t given;
+      std::uint64_t expected;
 
-      BadCRC(std::uint32_t given, std::uint32_t expected) : given(given), expected(expected), Exception() {
+      BadCRC(std::uint64_t given, std::uint64_t expected) : given(given), expected(expected), Exception() {
          std::stringstream stream;
 
          stream << "Bad CRC: the given CRC calculated to "
@@ -106,6 +112,140 @@ namespace exception
       }
    };
 
+   class UnsupportedChecksum : public Exception
+   {
+   public:
+      std::uint8_t type;
+
+      UnsupportedChecksum(std::uint8_t type) : type(type), Exception() {
+         std::stringstream stream;
+
+         stream << "Unsupported checksum: the given checksum type " << static_cast<int>(type) << " is unsupported.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class UnsupportedRng : public Exception
+   {
+   public:
+      std::uint8_t rng;
+
+      UnsupportedRng(std::uint8_t rng) : rng(rng), Exception() {
+         std::stringstream stream;
+
+         stream << "Unsupported RNG: the given random number generator " << static_cast<int>(rng) << " is unsupported.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class BadAlignment : public Exception
+   {
+   public:
+      std::uint32_t alignment;
+
+      BadAlignment(std::uint32_t alignment) : alignment(alignment), Exception() {
+         std::stringstream stream;
+
+         stream << "Bad alignment: the given payload alignment " << alignment << " is not a supported power of two.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class BadSeed : public Exception
+   {
+   public:
+      std::uint32_t seed;
+
+      BadSeed(std::uint32_t seed) : seed(seed), Exception() {
+         std::stringstream stream;
+
+         stream << "Bad seed: the seed " << seed << " would leave the LFSR stuck at the RNG_FULL levels.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class UnreachableEntropy : public Exception
+   {
+   public:
+      double target;
+
+      UnreachableEntropy(double target) : target(target), Exception() {
+         std::stringstream stream;
+
+         stream << "Unreachable entropy: no inflate level can bring the data below an entropy of " << target;
+
+         this->error = stream.str();
+      }
+   };
+
+   class BadWindow : public Exception
+   {
+   public:
+      std::uint64_t window;
+      std::uint64_t step;
+
+      BadWindow(std::uint64_t window, std::uint64_t step) : window(window), step(step), Exception() {
+         std::stringstream stream;
+
+         stream << "Bad window: a sliding window of " << window << " bytes advancing by " << step
+                << " bytes is invalid, both must be nonzero.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class MemberNotFound : public Exception
+   {
+   public:
+      std::string name;
+
+      MemberNotFound(const std::string &name) : name(name), Exception() {
+         std::stringstream stream;
+
+         stream << "Member not found: the archive has no member named \"" << name << "\".";
+
+         this->error = stream.str();
+      }
+   };
+
+   class OpenFailed : public Exception
+   {
+   public:
+      std::string path;
+
+      OpenFailed(const std::string &path) : path(path), Exception() {
+         std::stringstream stream;
+
+         stream << "Open failed: the file \"" << path << "\" could not be opened.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class IOFailed : public Exception
+   {
+   public:
+      std::string path;
+
+      IOFailed(const std::string &path) : path(path), Exception() {
+         std::stringstream stream;
+
+         stream << "I/O failed: reading or writing the file \"" << path << "\" failed.";
+
+         this->error = stream.str();
+      }
+   };
+
+   class BadCheckpoints : public Exception
+   {
+   public:
+      BadCheckpoints() : Exception("Bad checkpoints: the checkpoints were not recorded for this inflate stream.") {}
+   };
+
    class ConstConflict : public Exception
    {
    public:
@@ -0,0 +1,51 @@
+#ifndef __INFLATE_FILE_HPP
+#define __INFLATE_FILE_HPP
+
+/// @file file.hpp
+/// @brief File-to-file inflate and deflate that keep sparse files sparse.
+///
+/// The input is streamed through the kernels a few megabytes at a time, so files larger than memory are
+/// fine. Where the filesystem reports holes through `SEEK_DATA` and `SEEK_HOLE`, the holes are never read:
+/// zero input maps to zero output at every level, so the fixed and RNG_PARTIAL levels only jump the register
+/// past them, and the RNG_FULL levels run the kernel over zeros to keep the register in step. CRC checksums
+/// of the holes are combined in O(log n) instead of computed.
+///
+/// The output is truncated and resized up front, so it starts as one large hole. Only the pages of output
+/// that hold a nonzero byte are written, which leaves holes for the input's holes and for any zero pages
+/// within its data. XXH64 can't skip anything and reads the deflated file in full.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <inflate/platform.hpp>
+#include <inflate/format.hpp>
+
+namespace inflate
+{
+   struct FileExtent
+   {
+      std::uint64_t offset;
+      std::uint64_t size;
+   };
+
+   /// @brief The ranges of the file which hold data, in order. Without `SEEK_DATA` support, the whole file is
+   /// a single extent.
+   EXPORT std::vector<FileExtent> data_extents(const std::string &path);
+
+   /// @brief Inflate the file at `input` into a file at `output`, returning the header, which is the same as
+   /// `inflate_memory` on the file's contents would return. The output holds the inflated data only.
+   EXPORT InflateHeaderV2 inflate_file(const std::string &input,
+                                       const std::string &output,
+                                       const InflateOptions &options=InflateOptions());
+
+   /// @brief Deflate the inflated file at `input`, described by `header`, into a file at `output`. With
+   /// `validate`, the checksum is checked once the output has been written and `exception::BadCRC` is thrown
+   /// if it doesn't match.
+   EXPORT void deflate_file(const std::string &input,
+                            const std::string &output,
+                            const InflateHeaderV2 &header,
+                            bool validate=true);
+}
+
+#endif
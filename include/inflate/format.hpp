@@ -0,0 +1,204 @@
+#ifndef __INFLATE_FORMAT_HPP
+#define __INFLATE_FORMAT_HPP
+
+#include <cstdint>
+#include <optional>
+
+#include <inflate/platform.hpp>
+
+namespace inflate
+{
+   enum InflateLevel : std::uint8_t
+   {
+      INFLATE_NOOP = 0,
+
+      INFLATE_1BIT,
+      INFLATE_2BIT,
+      INFLATE_3BIT,
+      INFLATE_4BIT,
+      INFLATE_5BIT,
+      INFLATE_6BIT,
+      INFLATE_7BIT,
+
+      INFLATE_RNG_PARTIAL_1BIT,
+      INFLATE_RNG_PARTIAL_2BIT,
+      INFLATE_RNG_PARTIAL_3BIT,
+      INFLATE_RNG_PARTIAL_4BIT,
+      INFLATE_RNG_PARTIAL_5BIT,
+      INFLATE_RNG_PARTIAL_6BIT,
+      INFLATE_RNG_PARTIAL_7BIT,
+
+      INFLATE_RNG_FULL_1BIT,
+      INFLATE_RNG_FULL_2BIT,
+      INFLATE_RNG_FULL_3BIT,
+      INFLATE_RNG_FULL_4BIT,
+      INFLATE_RNG_FULL_5BIT,
+      INFLATE_RNG_FULL_6BIT,
+      INFLATE_RNG_FULL_7BIT,
+
+      // 16- or 32-bit groups with a chosen number of padding bits, see `InflateOptions`. These need a
+      // versioned header to record their group width.
+      INFLATE_WIDE,
+      INFLATE_RNG_PARTIAL_WIDE,
+      INFLATE_RNG_FULL_WIDE,
+   };
+
+   enum InflateFamily
+   {
+      INFLATE_FAMILY_FIXED = 0,
+      INFLATE_FAMILY_RNG_PARTIAL,
+      INFLATE_FAMILY_RNG_FULL,
+   };
+
+   PACK(1)
+   struct InflateHeader
+   {
+      std::uint8_t level;
+      std::uint64_t inflated;
+      std::uint64_t deflated;
+      std::uint32_t checksum;
+      std::uint32_t seed;
+   };
+   UNPACK()
+
+   /// @brief The header of an `NFLR` stream. Like `InflateHeaderV2`, every field is naturally aligned, so
+   /// no packing is needed for the layout to be the same on every compiler.
+   struct InflateRegionHeader
+   {
+      std::uint64_t region_size;
+      std::uint64_t regions;
+      std::uint64_t deflated;
+      std::uint32_t checksum;
+      std::uint32_t seed;
+   };
+
+   /// @brief One entry of the region table following an `InflateRegionHeader`.
+   struct InflateRegion
+   {
+      std::uint8_t level;
+      std::uint8_t reserved[7];
+      std::uint64_t inflated;
+   };
+
+   /// @brief The checksum recorded in a versioned header.
+   enum ChecksumType : std::uint8_t
+   {
+      CHECKSUM_CRC32 = 0,
+      CHECKSUM_CRC32C,
+      CHECKSUM_XXH64,
+   };
+
+   /// @brief The generator behind the RNG levels, recorded in a versioned header.
+   ///
+   /// The LFSR is a single register stepped once per draw. The counter-based engines instead hash the seed,
+   /// the group's index and the draw's index within the group, so any group's draws can be computed directly.
+   enum RngEngine : std::uint8_t
+   {
+      RNG_LFSR = 0,
+      RNG_SPLITMIX,
+      RNG_PHILOX,
+   };
+
+   /// @brief The header of an `NFLV` stream.
+   ///
+   /// Unlike `InflateHeader`, every field is naturally aligned, so the layout is the same on every compiler.
+   /// `header_size` is the size of the header as written, which lets later versions append fields that older
+   /// readers skip: readers accept any version from `INFLATE_MIN_HEADER_VERSION` on, so a new version may only
+   /// append fields. The reserved bytes must be zero, so a reader rejects a stream using them for something it
+   /// doesn't know about rather than misreading it. `group_bits` and `padding_bits` are only set for the wide levels and are zero otherwise.
+   /// `rng` took over the first reserved byte in version 3, see `header_version`.
+   struct InflateHeaderV2
+   {
+      std::uint16_t version;
+      std::uint16_t header_size;
+      std::uint8_t level;
+      std::uint8_t checksum_type;
+      std::uint8_t group_bits;
+      std::uint8_t padding_bits;
+      std::uint8_t rng;
+      std::uint8_t reserved[3];
+      std::uint32_t seed;
+      std::uint64_t inflated;
+      std::uint64_t deflated;
+      std::uint64_t checksum;
+   };
+
+   /// @brief Per-call settings for the functions producing versioned headers.
+   struct InflateOptions
+   {
+      InflateLevel level = InflateLevel::INFLATE_3BIT;
+      std::optional<std::uint32_t> seed = std::nullopt;
+      ChecksumType checksum = ChecksumType::CHECKSUM_CRC32;
+
+      /// @brief The group width, 16 or 32, and how many bits of each group are padding. Required by the wide
+      /// levels and ignored by the others: 1 padding bit in 16 grows the data by about 6.7%.
+      std::uint8_t group_bits = 0;
+      std::uint8_t padding_bits = 0;
+
+      /// @brief Pad the header written by `inflate_disk` so the payload starts on a multiple of this many bytes
+      /// from the start of the stream, such as 64 for cache lines or 4096 for `O_DIRECT`. A power of two up to
+      /// `INFLATE_MAX_ALIGNMENT`; 0 places the payload right behind the header.
+      std::uint32_t alignment = 0;
+
+      /// @brief The generator of the RNG levels. The counter-based engines let the RNG_FULL levels run in
+      /// parallel and be edited in place like the RNG_PARTIAL ones; the LFSR is kept as the default so the
+      /// output matches earlier releases.
+      RngEngine rng = RngEngine::RNG_LFSR;
+   };
+
+   /// @brief The parsed header of an `NFL8` or `NFLV` stream and where its payload lies within the stream.
+   struct InflateContainer
+   {
+      InflateHeaderV2 header;
+      std::uint64_t payload_offset;
+      std::uint64_t payload_size;
+   };
+
+   /// @brief One member in the central directory of an `NFLA` archive, followed by `name_size` bytes of name.
+   ///
+   /// `offset` and `size` locate the member's `NFLV` stream within the archive, and `deflated` is the size of
+   /// the member's original data.
+   struct InflateArchiveEntry
+   {
+      std::uint64_t offset;
+      std::uint64_t size;
+      std::uint64_t deflated;
+      std::uint32_t name_size;
+      std::uint8_t level;
+      std::uint8_t reserved[3];
+   };
+
+   /// @brief The last bytes of an `NFLA` archive, which locate its central directory. `directory_checksum` is
+   /// the CRC32 of the directory.
+   struct InflateArchiveTrailer
+   {
+      std::uint64_t directory_offset;
+      std::uint64_t directory_size;
+      std::uint64_t members;
+      std::uint32_t directory_checksum;
+      char magic[4];
+   };
+
+   #define INFLATE_MAGIC "NFL8"
+   #define INFLATE_REGION_MAGIC "NFLR"
+   #define INFLATE_VERSIONED_MAGIC "NFLV"
+   #define INFLATE_ARCHIVE_MAGIC "NFLA"
+   #define INFLATE_HEADER_VERSION 3
+   #define INFLATE_MIN_HEADER_VERSION 2
+   #define INFLATE_MAX_ALIGNMENT 0x8000
+
+   constexpr bool is_supported_alignment(std::uint32_t alignment) noexcept {
+      return alignment <= INFLATE_MAX_ALIGNMENT && (alignment & (alignment - 1)) == 0;
+   }
+
+   /// @brief The version written into a header: the lowest one whose readers understand every field in use.
+   ///
+   /// Version 3 gave `rng` its meaning. Readers before it would take the byte for a reserved one and decode
+   /// with the LFSR, so only streams on another engine are marked version 3, which those readers refuse. LFSR
+   /// streams stay at version 2 and readable by every release.
+   constexpr std::uint16_t header_version(RngEngine rng) noexcept {
+      return (rng == RngEngine::RNG_LFSR) ? INFLATE_MIN_HEADER_VERSION : INFLATE_HEADER_VERSION;
+   }
+}
+
+#endif
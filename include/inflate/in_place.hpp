@@ -0,0 +1,47 @@
+#ifndef __INFLATE_IN_PLACE_HPP
+#define __INFLATE_IN_PLACE_HPP
+
+/// @file in_place.hpp
+/// @brief Inflate and deflate within a single buffer, so input and output are never resident at once.
+///
+/// A unit of eight groups is `modulus` deflated bytes and `group_bits` inflated bytes, and the inflated side
+/// is always the larger. Inflating from the last unit to the first, the output of unit `u` starts at
+/// `u * group_bits`, past every byte of input still unread below `u * modulus`. Deflating runs the other way,
+/// from the first unit to the last. Each step copies a small chunk of input aside first, so a unit may
+/// overwrite its own input.
+///
+/// Going backwards, the register has to be at the right state for each chunk. The RNG_PARTIAL levels, and
+/// every level using a counter-based `RngEngine`, jump there directly. The RNG_FULL levels using the LFSR
+/// first walk the whole stream forwards over zeros, which costs about as much as a second inflate, and keep
+/// the state at every chunk boundary: four bytes per chunk.
+
+#include <cstdint>
+
+#include <inflate/platform.hpp>
+#include <inflate/bitstream.hpp>
+#include <inflate/format.hpp>
+
+namespace inflate
+{
+   /// @brief Inflate the `input_size` bytes at the start of `buffer` over themselves. The buffer holds
+   /// `buffer_size` bytes, at least `inflated_size(options, input_size)`, or `exception::InsufficientSize` is
+   /// thrown. The output and header are the same as `inflate_memory` with the same options.
+   EXPORT InflateHeaderV2 inflate_in_place(std::uint8_t *buffer,
+                                           std::uint64_t buffer_size,
+                                           std::uint64_t input_size,
+                                           const InflateOptions &options=InflateOptions());
+
+   /// @brief Inflate the contents of `buffer` over themselves, growing it to the inflated size first. Reserve
+   /// the inflated size beforehand, or growing the vector may copy it.
+   EXPORT InflateHeaderV2 inflate_in_place(ByteVec &buffer, const InflateOptions &options=InflateOptions());
+
+   /// @brief Deflate the `size` bytes of inflated data at `buffer`, described by `header`, over themselves.
+   /// The deflated data ends up at the start of the buffer. Throws like `deflate_memory`, although by the time
+   /// a checksum mismatch is found, the inflated data has already been overwritten.
+   EXPORT void deflate_in_place(std::uint8_t *buffer, std::uint64_t size, const InflateHeaderV2 &header, bool validate=true);
+
+   /// @brief Deflate the contents of `buffer` over themselves and shrink it to the deflated size.
+   EXPORT void deflate_in_place(ByteVec &buffer, const InflateHeaderV2 &header, bool validate=true);
+}
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef __INFLATE_KERNEL_HPP
+#define __INFLATE_KERNEL_HPP
+
+/// @file kernel.hpp
+/// @brief The raw, unchecked transforms underneath the inflate and deflate functions.
+///
+/// Each level transforms groups of input bits into 8-bit output groups, or 16- and 32-bit groups for the wide
+/// levels. The kernels assume their arguments
+/// were validated up front: buffers must be large enough for the given bit counts and the level must be
+/// supported. Calls can be chained on consecutive pieces of a stream by passing the same `ShiftRegister` or
+/// `RandomEngine`, provided every piece but the last holds a multiple of eight groups, which keeps both sides byte-aligned.
+
+#include <cstdint>
+
+#include <inflate/platform.hpp>
+#include <inflate/format.hpp>
+#include <inflate/result.hpp>
+#include <inflate/rng.hpp>
+#include <inflate/utility.hpp>
+
+namespace inflate
+{
+   /// @brief The shape of a level's output groups: each carries `group_bits - padding_bits` input bits.
+   struct InflateGeometry
+   {
+      std::uint32_t group_bits;
+      std::uint32_t padding_bits;
+
+      constexpr std::uint32_t modulus() const noexcept { return this->group_bits - this->padding_bits; }
+   };
+
+   /// @brief Whether the level uses 8-bit groups. The wide levels aren't, since their shape needs more than the
+   /// level to describe, see `is_supported_geometry`.
+   constexpr bool is_supported_level(std::uint8_t level) noexcept {
+      return level <= InflateLevel::INFLATE_RNG_FULL_7BIT;
+   }
+
+   constexpr bool is_wide_level(std::uint8_t level) noexcept {
+      return level >= InflateLevel::INFLATE_WIDE && level <= InflateLevel::INFLATE_RNG_FULL_WIDE;
+   }
+
+   /// @brief The number of input bits carried by each 8-bit output group of the given level.
+   constexpr std::uint32_t level_modulus(InflateLevel level) noexcept {
+      if (level <= InflateLevel::INFLATE_7BIT)
+         return 8 - level;
+      else if (level <= InflateLevel::INFLATE_RNG_PARTIAL_7BIT)
+         return 8 - (level - InflateLevel::INFLATE_7BIT);
+      else
+         return 8 - (level - InflateLevel::INFLATE_RNG_PARTIAL_7BIT);
+   }
+
+   constexpr InflateFamily level_family(InflateLevel level) noexcept {
+      if (is_wide_level(level))
+         return static_cast<InflateFamily>(level - InflateLevel::INFLATE_WIDE);
+      else if (level <= InflateLevel::INFLATE_7BIT)
+         return InflateFamily::INFLATE_FAMILY_FIXED;
+      else if (level <= InflateLevel::INFLATE_RNG_PARTIAL_7BIT)
+         return InflateFamily::INFLATE_FAMILY_RNG_PARTIAL;
+      else
+         return InflateFamily::INFLATE_FAMILY_RNG_FULL;
+   }
+
+   /// @brief The size, in bits, of the inflated stream produced from `deflated_bits` bits of input.
+   constexpr std::uint64_t inflated_bits(InflateLevel level, std::uint64_t deflated_bits) noexcept {
+      auto modulus = level_modulus(level);
+
+      // fixed levels leave the trailing partial group unpadded, the RNG levels always emit whole groups.
+      if (level_family(level) == InflateFamily::INFLATE_FAMILY_FIXED)
+         return (deflated_bits / modulus) * 8 + deflated_bits % modulus;
+      else
+         return (deflated_bits / modulus + static_cast<std::uint64_t>(deflated_bits % modulus != 0)) * 8;
+   }
+
+   /// @brief The geometry of a level. `group_bits` and `padding_bits` are only used by the wide levels.
+   constexpr InflateGeometry level_geometry(InflateLevel level, std::uint32_t group_bits=0, std::uint32_t padding_bits=0) noexcept {
+      if (is_wide_level(level))
+         return InflateGeometry{group_bits, padding_bits};
+
+      return InflateGeometry{8, 8 - level_modulus(level)};
+   }
+
+   constexpr InflateGeometry options_geometry(const InflateOptions &options) noexcept {
+      return level_geometry(options.level, options.group_bits, options.padding_bits);
+   }
+
+   constexpr InflateGeometry header_geometry(const InflateHeaderV2 &header) noexcept {
+      return level_geometry(static_cast<InflateLevel>(header.level), header.group_bits, header.padding_bits);
+   }
+
+   constexpr bool is_supported_geometry(std::uint8_t level, InflateGeometry geometry) noexcept {
+      if (is_wide_level(level))
+         return (geometry.group_bits == 16 || geometry.group_bits == 32)
+            && geometry.padding_bits >= 1
+            && geometry.padding_bits < geometry.group_bits;
+
+      return is_supported_level(level);
+   }
+
+   constexpr std::uint64_t inflated_bits(InflateLevel level, InflateGeometry geometry, std::uint64_t deflated_bits) noexcept {
+      auto modulus = geometry.modulus();
+
+      if (level_family(level) == InflateFamily::INFLATE_FAMILY_FIXED)
+         return (deflated_bits / modulus) * geometry.group_bits + deflated_bits % modulus;
+      else
+         return (deflated_bits / modulus + static_cast<std::uint64_t>(deflated_bits % modulus != 0)) * geometry.group_bits;
+   }
+
+   /// @brief Check that the header describes a supported level whose sizes agree with each other and with
+   /// the `size` bytes of inflated data.
+   EXPORT InflateStatus validate_header(const InflateHeader &header, std::uint64_t size) noexcept;
+   EXPORT InflateStatus validate_header(const InflateHeaderV2 &header, std::uint64_t size) noexcept;
+
+   /// @brief Inflate `deflated_bits` bits of `input` into `output`, which must hold
+   /// `inflated_bits(level, deflated_bits)` bits rounded up to a whole byte.
+   EXPORT void inflate_kernel(InflateLevel level,
+                              const std::uint8_t *input,
+                              std::uint64_t deflated_bits,
+                              std::uint8_t *output,
+                              ShiftRegister &lfsr) noexcept;
+
+   /// @brief Deflate the inflated `input` back into `deflated_bits` bits of `output`, which must hold
+   /// `deflated_bits` rounded up to a whole byte.
+   EXPORT void deflate_kernel(InflateLevel level,
+                              const std::uint8_t *input,
+                              std::uint64_t deflated_bits,
+                              std::uint8_t *output,
+                              ShiftRegister &lfsr) noexcept;
+
+   /// @brief The kernels for any level, including the wide ones. Chained calls must split the stream on
+   /// multiples of eight groups, which are `modulus` input bytes and `group_bits` output bytes.
+   ///
+   /// At the fixed and RNG_PARTIAL levels, runs of zero input are written with `memset` and the register
+   /// jumped past them, which makes sparse data such as disk images close to free.
+   EXPORT void inflate_kernel(InflateLevel level,
+                              InflateGeometry geometry,
+                              const std::uint8_t *input,
+                              std::uint64_t deflated_bits,
+                              std::uint8_t *output,
+                              ShiftRegister &lfsr) noexcept;
+   EXPORT void deflate_kernel(InflateLevel level,
+                              InflateGeometry geometry,
+                              const std::uint8_t *input,
+                              std::uint64_t deflated_bits,
+                              std::uint8_t *output,
+                              ShiftRegister &lfsr) noexcept;
+
+   /// @brief The kernels driven by the generator a header names, see `RandomEngine`. With a counter engine,
+   /// runs of zero input are skipped at the RNG_FULL levels too.
+   EXPORT void inflate_kernel(InflateLevel level,
+                              InflateGeometry geometry,
+                              const std::uint8_t *input,
+                              std::uint64_t deflated_bits,
+                              std::uint8_t *output,
+                              RandomEngine &rng) noexcept;
+   EXPORT void deflate_kernel(InflateLevel level,
+                              InflateGeometry geometry,
+                              const std::uint8_t *input,
+                              std::uint64_t deflated_bits,
+                              std::uint8_t *output,
+                              RandomEngine &rng) noexcept;
+}
+
+#endif
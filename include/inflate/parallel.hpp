@@ -0,0 +1,92 @@
+#ifndef __INFLATE_PARALLEL_HPP
+#define __INFLATE_PARALLEL_HPP
+
+/// @file parallel.hpp
+/// @brief Multi-threaded, NUMA-aware inflate and deflate of very large buffers.
+///
+/// The input is cut into contiguous ranges on 8-group boundaries, one per worker. The RNG_PARTIAL levels use
+/// exactly one shift per group, so each worker jumps its own `ShiftRegister` to the start of its range. The
+/// output is identical to a single-threaded call. The RNG_FULL levels draw a varying number of shifts
+/// per group, so with the LFSR they run on a single worker. With a counter-based `RngEngine`, any level
+/// jumps straight to its range.
+///
+/// The output buffer is supplied by the caller and only written by the workers. If the caller hands in memory
+/// that hasn't been touched yet, such as a `LargeBuffer` or a large `new std::uint8_t[]`, each page is
+/// first touched by the worker that fills it. On NUMA machines, workers are spread over the nodes and pinned
+/// to them, so every node's share of the output lands in its local memory. Without NUMA, or where the topology
+/// can't be read, all workers belong to a single node and aren't pinned.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <inflate/platform.hpp>
+#include <inflate/format.hpp>
+#include <inflate/buffer.hpp>
+
+namespace inflate
+{
+   /// @brief The minimum input per worker, below which fewer workers are used.
+   #define INFLATE_PARALLEL_MINIMUM 0x100000
+
+   struct NumaNode
+   {
+      std::uint32_t id;
+
+      /// @brief The CPUs of the node. Empty when the topology is unknown, in which case workers aren't pinned.
+      std::vector<std::uint32_t> cpus;
+   };
+
+   /// @brief The NUMA nodes of the machine, read once. Always holds at least one node.
+   EXPORT const std::vector<NumaNode> &numa_nodes();
+
+   struct ParallelOptions
+   {
+      /// @brief The number of workers. 0 uses every hardware thread.
+      std::size_t threads = 0;
+
+      /// @brief Spread the workers over the NUMA nodes and pin them there.
+      bool numa = true;
+
+      std::uint64_t minimum = INFLATE_PARALLEL_MINIMUM;
+   };
+
+   /// @brief The number of bytes `inflate_memory_parallel` writes for `size` bytes of input.
+   EXPORT std::uint64_t inflated_size(const InflateOptions &options, std::uint64_t size);
+
+   /// @brief Inflate `size` bytes of `ptr` into `output`, which must hold `inflated_size(options, size)` bytes.
+   ///
+   /// The result and the header are the same as `inflate_memory` with the same options. CRC32 and CRC32C
+   /// checksums are computed per range and combined; XXH64 is computed afterwards on the calling thread.
+   EXPORT InflateHeaderV2 inflate_memory_parallel(const void *ptr,
+                                                  std::uint64_t size,
+                                                  std::uint8_t *output,
+                                                  const InflateOptions &options,
+                                                  const ParallelOptions &parallel=ParallelOptions());
+
+   /// @brief Deflate `size` bytes of `ptr`, described by `header`, into `output`, which must hold the
+   /// header's `deflated` bits rounded up to a byte. Throws like `deflate_memory`.
+   EXPORT void deflate_memory_parallel(const void *ptr,
+                                       std::uint64_t size,
+                                       const InflateHeaderV2 &header,
+                                       std::uint8_t *output,
+                                       bool validate=true,
+                                       const ParallelOptions &parallel=ParallelOptions());
+
+   /// @brief The parallel functions above, returning a `LargeBuffer` instead of filling a caller's buffer.
+   ///
+   /// The buffer is neither zeroed nor prefaulted, so every page is first written by the worker filling it.
+   EXPORT std::pair<LargeBuffer, InflateHeaderV2> inflate_memory_large(const void *ptr,
+                                                                       std::uint64_t size,
+                                                                       const InflateOptions &options,
+                                                                       const ParallelOptions &parallel=ParallelOptions(),
+                                                                       const LargeBufferOptions &buffer=LargeBufferOptions());
+   EXPORT LargeBuffer deflate_memory_large(const void *ptr,
+                                           std::uint64_t size,
+                                           const InflateHeaderV2 &header,
+                                           bool validate=true,
+                                           const ParallelOptions &parallel=ParallelOptions(),
+                                           const LargeBufferOptions &buffer=LargeBufferOptions());
+}
+
+#endif
@@ -22,6 +22,10 @@
 /// * `PACK(alignment)`: on MSVC, this evaluates to `__pragma(pack(push, alignment))`. if MSVC is not detected,
 ///                      this evaluates to `__attribute__((packed,aligned(alignment)))`.
 /// * `UNPACK()`: on MSVC, this evaluates to `__pragma(pack(pop))`. if MSVC is not detected, this evaluates to nothing.
+/// * `INFLATE_X86`: defined when compiling for x86 or x86-64.
+/// * `INFLATE_TARGET(features)`: on GCC and Clang, this evaluates to `__attribute__((target(features)))`, which lets
+///                               a function use instructions beyond the baseline. MSVC needs no such marking, so
+///                               this evaluates to nothing there.
 ///
 
 #if defined(_WIN32) || defined(WIN32)
@@ -54,6 +58,16 @@
 #define UNPACK()
 #endif
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define INFLATE_X86
+#endif
+
+#if defined(__GNUC__)
+#define INFLATE_TARGET(features) __attribute__((target(features)))
+#else
+#define INFLATE_TARGET(features)
+#endif
+
 #if defined(INFLATE_WIN32)
 /* this warning is in relation to a right-shift of 64, which is expected to result in a 0 value. */
 //#pragma warning( disable: 4293 )
@@ -0,0 +1,58 @@
+#ifndef __INFLATE_RESULT_HPP
+#define __INFLATE_RESULT_HPP
+
+#include <optional>
+#include <utility>
+
+#include <inflate/platform.hpp>
+
+namespace inflate
+{
+   /// @brief The error codes of the non-throwing API, one for each exception a throwing call can raise.
+   enum InflateStatus
+   {
+      STATUS_OK = 0,
+      STATUS_NULL_POINTER,
+      STATUS_INSUFFICIENT_SIZE,
+      STATUS_BAD_HEADER_MAGIC,
+      STATUS_BAD_HEADER,
+      STATUS_BAD_CRC,
+      STATUS_UNSUPPORTED_INFLATE_LEVEL,
+      STATUS_UNSUPPORTED_CHECKSUM,
+      STATUS_BAD_ALIGNMENT,
+      STATUS_UNSUPPORTED_RNG,
+      STATUS_BAD_SEED,
+      STATUS_OUT_OF_MEMORY,
+      STATUS_ERROR,
+   };
+
+   EXPORT const char *status_string(InflateStatus status) noexcept;
+
+   /// @brief Either a value or the status explaining why there isn't one.
+   template <typename T>
+   class Result
+   {
+      InflateStatus _status;
+      std::optional<T> _value;
+
+   public:
+      Result(T &&value) noexcept : _status(InflateStatus::STATUS_OK), _value(std::move(value)) {}
+      Result(InflateStatus status) noexcept : _status(status), _value(std::nullopt) {}
+
+      explicit operator bool() const noexcept { return this->ok(); }
+
+      bool ok() const noexcept { return this->_status == InflateStatus::STATUS_OK; }
+      InflateStatus status() const noexcept { return this->_status; }
+
+      /// @brief The contained value. Only valid when `ok()` is true.
+      T &value() noexcept { return *this->_value; }
+      const T &value() const noexcept { return *this->_value; }
+
+      T &operator*() noexcept { return this->value(); }
+      const T &operator*() const noexcept { return this->value(); }
+      T *operator->() noexcept { return &this->value(); }
+      const T *operator->() const noexcept { return &this->value(); }
+   };
+}
+
+#endif
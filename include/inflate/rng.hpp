@@ -0,0 +1,194 @@
+#ifndef __INFLATE_RNG_HPP
+#define __INFLATE_RNG_HPP
+
+/// @file rng.hpp
+/// @brief The generators behind the RNG levels.
+///
+/// The kernels take a group's draws through `next_group()`, which hands back something with a `shift()`. The
+/// LFSR returns itself, so its draws simply continue from group to group. A `CounterRng` returns the draws of
+/// the next group index, computed from the seed and that index alone: reaching any group is a matter of
+/// setting the index, whatever the level and however many draws the groups before it took.
+
+#include <cstdint>
+#include <optional>
+
+#include <inflate/platform.hpp>
+#include <inflate/format.hpp>
+#include <inflate/utility.hpp>
+
+namespace inflate
+{
+   constexpr bool is_supported_rng(std::uint8_t rng) noexcept {
+      return rng <= RngEngine::RNG_PHILOX;
+   }
+
+   /// @brief Whether the generator can be moved to any group directly. The counter engines always can. The
+   /// LFSR can at the RNG_PARTIAL levels, which shift once per group, but not at the RNG_FULL ones, which
+   /// reject repeated bit positions and so draw a varying number of times. The fixed levels never draw.
+   constexpr bool is_seekable(InflateFamily family, RngEngine rng) noexcept {
+      return family != InflateFamily::INFLATE_FAMILY_RNG_FULL || rng != RngEngine::RNG_LFSR;
+   }
+
+   /// @brief Whether `seed` can drive `rng` at `family`. An LFSR seeded with 0 never leaves 0, and the RNG_FULL
+   /// levels draw until they find unused bit positions, so they would never finish.
+   constexpr bool is_usable_seed(InflateFamily family, RngEngine rng, std::uint32_t seed) noexcept {
+      return seed != 0 || rng != RngEngine::RNG_LFSR || family != InflateFamily::INFLATE_FAMILY_RNG_FULL;
+   }
+
+   /// @brief The SplitMix64 finalizer over a counter made of the seed, the group and the block of draws.
+   /// Each hash yields two draws.
+   struct SplitMix
+   {
+      static constexpr std::uint32_t BLOCK = 2;
+
+      static constexpr void block(std::uint32_t seed, std::uint64_t group, std::uint32_t index, std::uint32_t (&out)[BLOCK]) {
+         auto z = ((static_cast<std::uint64_t>(seed) << 32) | seed)
+            + (group + 1) * 0x9E3779B97F4A7C15ull
+            + static_cast<std::uint64_t>(index) * 0xD1B54A32D192ED03ull;
+
+         z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+         z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+         z ^= z >> 31;
+
+         out[0] = static_cast<std::uint32_t>(z);
+         out[1] = static_cast<std::uint32_t>(z >> 32);
+      }
+   };
+
+   /// @brief Philox4x32-10 keyed by the seed, with the block of draws and the group as its counter. Each
+   /// hash yields four draws.
+   struct Philox
+   {
+      static constexpr std::uint32_t BLOCK = 4;
+
+      static constexpr void block(std::uint32_t seed, std::uint64_t group, std::uint32_t index, std::uint32_t (&out)[BLOCK]) {
+         std::uint32_t c0 = index;
+         std::uint32_t c1 = static_cast<std::uint32_t>(group);
+         std::uint32_t c2 = static_cast<std::uint32_t>(group >> 32);
+         std::uint32_t c3 = 0;
+         std::uint32_t k0 = seed;
+         std::uint32_t k1 = 0;
+
+         for (std::uint32_t round=0; round<10; ++round)
+         {
+            auto p0 = static_cast<std::uint64_t>(0xD2511F53) * c0;
+            auto p1 = static_cast<std::uint64_t>(0xCD9E8D57) * c2;
+
+            c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<std::uint32_t>(p1);
+            c3 = static_cast<std::uint32_t>(p0);
+
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+         }
+
+         out[0] = c0;
+         out[1] = c1;
+         out[2] = c2;
+         out[3] = c3;
+      }
+   };
+
+   /// @brief A counter-based generator whose state is the index of the next group.
+   template <typename Hash>
+   class CounterRng
+   {
+      std::uint32_t _seed;
+      std::uint64_t _group;
+
+   public:
+      /// @brief The draws of a single group, hashed a block at a time.
+      class Draws
+      {
+         std::uint32_t _seed;
+         std::uint64_t _group;
+         std::uint32_t _index;
+         std::uint32_t _block[Hash::BLOCK];
+
+      public:
+         constexpr Draws(std::uint32_t seed, std::uint64_t group) : _seed(seed), _group(group), _index(0), _block{} {}
+
+         constexpr std::uint32_t shift() {
+            auto slot = this->_index % Hash::BLOCK;
+
+            if (slot == 0)
+               Hash::block(this->_seed, this->_group, this->_index / Hash::BLOCK, this->_block);
+
+            ++this->_index;
+
+            return this->_block[slot];
+         }
+      };
+
+      constexpr CounterRng(std::uint32_t seed=0xACE1, std::uint64_t group=0) : _seed(seed), _group(group) {}
+
+      constexpr Draws next_group() { return Draws(this->_seed, this->_group++); }
+
+      /// @brief Skip `groups` groups, in O(1).
+      constexpr void jump(std::uint64_t groups) { this->_group += groups; }
+
+      constexpr std::uint64_t state() const { return this->_group; }
+      constexpr void restore(std::uint64_t state) { this->_group = state; }
+   };
+
+   using SplitMixRng = CounterRng<SplitMix>;
+   using PhiloxRng = CounterRng<Philox>;
+
+   /// @brief The generator named by a header or by `InflateOptions`, for code that picks it at runtime.
+   ///
+   /// The kernels resolve the engine once per call and then run with the concrete generator, so nothing is
+   /// decided per draw. `jump` and `state` count groups for the counter engines and shifts for the LFSR, which
+   /// are the same thing wherever `is_seekable` holds.
+   class RandomEngine
+   {
+      RngEngine _engine;
+      ShiftRegister _lfsr;
+      SplitMixRng _splitmix;
+      PhiloxRng _philox;
+
+   public:
+      RandomEngine(std::optional<std::uint32_t> seed=std::nullopt, RngEngine engine=RngEngine::RNG_LFSR)
+         : _engine(engine),
+           _lfsr(seed),
+           _splitmix(seed.value_or(0xACE1)),
+           _philox(seed.value_or(0xACE1))
+      {}
+      explicit RandomEngine(const InflateHeaderV2 &header) : RandomEngine(header.seed, static_cast<RngEngine>(header.rng)) {}
+
+      RngEngine engine() const { return this->_engine; }
+
+      ShiftRegister &lfsr() { return this->_lfsr; }
+      SplitMixRng &splitmix() { return this->_splitmix; }
+      PhiloxRng &philox() { return this->_philox; }
+
+      void jump(std::uint64_t steps) {
+         switch (this->_engine)
+         {
+         case RngEngine::RNG_SPLITMIX: this->_splitmix.jump(steps); break;
+         case RngEngine::RNG_PHILOX: this->_philox.jump(steps); break;
+         default: this->_lfsr.jump(steps); break;
+         }
+      }
+
+      std::uint64_t state() const {
+         switch (this->_engine)
+         {
+         case RngEngine::RNG_SPLITMIX: return this->_splitmix.state();
+         case RngEngine::RNG_PHILOX: return this->_philox.state();
+         default: return this->_lfsr.state();
+         }
+      }
+
+      void restore(std::uint64_t state) {
+         switch (this->_engine)
+         {
+         case RngEngine::RNG_SPLITMIX: this->_splitmix.restore(state); break;
+         case RngEngine::RNG_PHILOX: this->_philox.restore(state); break;
+         default: this->_lfsr.restore(static_cast<std::uint32_t>(state)); break;
+         }
+      }
+   };
+}
+
+#endif
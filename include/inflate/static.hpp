@@ -0,0 +1,134 @@
+#ifndef __INFLATE_STATIC_HPP
+#define __INFLATE_STATIC_HPP
+
+/// @file static.hpp
+/// @brief Compile-time inflation of fixed payloads.
+///
+/// `static_inflate` runs the same transforms as `inflate_memory` in a constant expression, so embedded data can
+/// be stored already inflated and costs nothing at startup:
+///
+/// ```cpp
+/// constexpr auto blob = inflate::static_inflate<inflate::INFLATE_RNG_FULL_3BIT, 0x1234>(payload);
+/// auto data = inflate::deflate_memory(blob.data.data(), blob.data.size(), blob.header);
+/// ```
+///
+/// These functions trade speed for being usable in a constant expression. Use `inflate_memory` at runtime.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <inflate/format.hpp>
+#include <inflate/kernel.hpp>
+#include <inflate/utility.hpp>
+
+namespace inflate
+{
+   /// @brief The size, in bytes, of the inflated form of `size` bytes at the given level.
+   constexpr std::size_t static_inflated_size(InflateLevel level, std::size_t size) noexcept {
+      auto bits = inflated_bits(level, static_cast<std::uint64_t>(size) * 8);
+      return static_cast<std::size_t>(bits / 8 + static_cast<std::uint64_t>(bits % 8 != 0));
+   }
+
+   template <std::size_t N>
+   struct StaticInflate
+   {
+      std::array<std::uint8_t, N> data;
+      InflateHeader header;
+   };
+
+namespace detail
+{
+   template <std::size_t N>
+   constexpr std::uint8_t static_extract(const std::array<std::uint8_t, N> &input, std::uint64_t offset, std::uint32_t count) {
+      std::uint8_t value = 0;
+
+      for (std::uint32_t i=0; i<count; ++i)
+      {
+         auto bit = offset + i;
+         value |= static_cast<std::uint8_t>(((input[bit / 8] >> (bit % 8)) & 1) << i);
+      }
+
+      return value;
+   }
+
+   constexpr std::uint8_t static_transform(InflateLevel level, std::uint8_t value, std::uint32_t read_size, ShiftRegister &lfsr) {
+      switch (level_family(level))
+      {
+      case InflateFamily::INFLATE_FAMILY_RNG_PARTIAL:
+      {
+         auto padding = 8 - level_modulus(level);
+         auto inject = lfsr.shift() % read_size;
+         auto low = static_cast<std::uint32_t>(value) & ((1u << inject) - 1);
+
+         return static_cast<std::uint8_t>(low | ((static_cast<std::uint32_t>(value) >> inject) << (inject + padding)));
+      }
+
+      case InflateFamily::INFLATE_FAMILY_RNG_FULL:
+      {
+         std::uint8_t mask = 0;
+         std::uint32_t target_bits = 0;
+
+         while (target_bits < read_size)
+         {
+            auto index = lfsr.shift() % 8;
+
+            if ((mask >> index) & 1)
+               continue;
+
+            mask |= static_cast<std::uint8_t>(1 << index);
+            ++target_bits;
+         }
+
+         std::uint8_t result = 0;
+
+         for (std::uint32_t i=0; i<8; ++i)
+         {
+            if (((mask >> i) & 1) == 0)
+               continue;
+
+            result |= static_cast<std::uint8_t>((value & 1) << i);
+            value >>= 1;
+         }
+
+         return result;
+      }
+
+      default:
+         return value;
+      }
+   }
+}
+
+   /// @brief Inflate `input` at compile time. The result is identical to `inflate_memory(input, Level, Seed)`.
+   template <InflateLevel Level, std::uint32_t Seed=0xACE1, std::size_t N>
+   constexpr StaticInflate<static_inflated_size(Level, N)> static_inflate(const std::array<std::uint8_t, N> &input) {
+      static_assert(is_supported_level(Level), "unsupported inflate level");
+      static_assert(is_usable_seed(level_family(Level), RngEngine::RNG_LFSR, Seed), "the LFSR can't be seeded with 0 at the RNG_FULL levels");
+
+      StaticInflate<static_inflated_size(Level, N)> result {};
+      auto lfsr = ShiftRegister(Seed);
+      const auto modulus = level_modulus(Level);
+      const std::uint64_t deflated = static_cast<std::uint64_t>(N) * 8;
+      const std::uint64_t groups = deflated / modulus;
+
+      for (std::uint64_t g=0; g<groups; ++g)
+         result.data[g] = detail::static_transform(Level, detail::static_extract(input, g*modulus, modulus), modulus, lfsr);
+
+      if (deflated % modulus != 0)
+      {
+         auto read_size = static_cast<std::uint32_t>(deflated % modulus);
+         result.data[groups] = detail::static_transform(Level, detail::static_extract(input, groups*modulus, read_size), read_size, lfsr);
+      }
+
+      result.header.level = Level;
+      result.header.inflated = inflated_bits(Level, deflated);
+      result.header.deflated = deflated;
+      result.header.checksum = crc32(input);
+      result.header.seed = Seed;
+
+      return result;
+   }
+}
+
+#endif
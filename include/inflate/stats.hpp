@@ -0,0 +1,86 @@
+#ifndef __INFLATE_STATS_HPP
+#define __INFLATE_STATS_HPP
+
+/// @file stats.hpp
+/// @brief Opt-in performance counters for the inflate and deflate functions.
+///
+/// Counters are only collected when the library is compiled with `INFLATE_STATS` defined (the `INFLATE_STATS`
+/// CMake option). Otherwise the instrumentation macros expand to nothing, `last_stats()` always reads zero and
+/// the callback is never invoked.
+///
+/// Statistics are gathered per top-level call on the calling thread: nested calls, such as `inflate_disk`
+/// calling `inflate_memory`, are folded into the outermost call.
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include <inflate/platform.hpp>
+
+namespace inflate
+{
+   struct InflateStats
+   {
+      std::uint64_t bytes_in;
+      std::uint64_t bytes_out;
+      std::uint64_t lfsr_steps;
+
+      /// @brief Output bytes written by the zero-run fast path instead of the kernels.
+      std::uint64_t zero_bytes;
+      std::uint64_t allocations;
+      std::uint64_t transform_ns;
+      std::uint64_t checksum_ns;
+      std::uint64_t assembly_ns;
+   };
+
+   using StatsCallback = std::function<void(const char *operation, const InflateStats &stats)>;
+
+   /// @brief True if the library was compiled with the performance counters.
+   EXPORT bool stats_enabled();
+
+   /// @brief The counters of the last completed top-level call on this thread.
+   EXPORT InflateStats last_stats();
+
+   /// @brief Install a callback invoked after every top-level call, on the calling thread. Pass `nullptr` to remove it.
+   ///
+   /// The callback must not throw.
+   EXPORT void set_stats_callback(StatsCallback callback);
+
+namespace stats
+{
+   EXPORT InflateStats &current();
+
+   class Scope
+   {
+      const char *_operation;
+
+   public:
+      EXPORT Scope(const char *operation);
+      EXPORT ~Scope();
+   };
+
+   class Timer
+   {
+      std::uint64_t InflateStats::*_field;
+      std::chrono::steady_clock::time_point _start;
+
+   public:
+      Timer(std::uint64_t InflateStats::*field) : _field(field), _start(std::chrono::steady_clock::now()) {}
+      ~Timer() {
+         auto elapsed = std::chrono::steady_clock::now() - this->_start;
+         current().*(this->_field) += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      }
+   };
+}}
+
+#if defined(INFLATE_STATS)
+#define INFLATE_STATS_SCOPE(operation) inflate::stats::Scope __inflate_stats_scope(operation)
+#define INFLATE_STATS_ADD(field, value) (inflate::stats::current().field += (value))
+#define INFLATE_STATS_TIMER(field) inflate::stats::Timer __inflate_stats_timer_##field(&inflate::InflateStats::field)
+#else
+#define INFLATE_STATS_SCOPE(operation)
+#define INFLATE_STATS_ADD(field, value)
+#define INFLATE_STATS_TIMER(field)
+#endif
+
+#endif
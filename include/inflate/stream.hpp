@@ -0,0 +1,115 @@
+#ifndef __INFLATE_STREAM_HPP
+#define __INFLATE_STREAM_HPP
+
+/// @file stream.hpp
+/// @brief `std::streambuf` adapters which inflate and deflate on the fly.
+///
+/// Both adapters work through fixed-size internal buffers. Memory use stays constant however long the
+/// stream is, and output starts before the input has been fully read.
+///
+/// ```cpp
+/// std::ofstream file("blob.nfl", std::ios::binary);
+/// inflate::InflateStreambuf inflater(file.rdbuf(), inflate::INFLATE_RNG_FULL_3BIT);
+/// std::ostream(&inflater) << data;
+/// inflater.close();
+/// ```
+///
+/// Errors are reported the way streambufs report them: the stream fails, and `status()` says why.
+
+#include <cstdint>
+#include <optional>
+#include <streambuf>
+
+#include <inflate/platform.hpp>
+#include <inflate/bitstream.hpp>
+#include <inflate/format.hpp>
+#include <inflate/result.hpp>
+#include <inflate/rng.hpp>
+#include <inflate/utility.hpp>
+
+namespace inflate
+{
+   /// @brief The number of 8-group blocks transformed per call: each block is `modulus` deflated bytes and
+   /// `group_bits` inflated bytes.
+   #define INFLATE_STREAM_BLOCKS 0x1000
+
+   /// @brief Writes an `NFL8` stream to `sink`, inflating whatever is written to it.
+   ///
+   /// The sizes and checksum are only known once the input ends, so a placeholder header is written first and
+   /// patched by `close()`. The sink must therefore be seekable.
+   class InflateStreambuf : public std::streambuf
+   {
+      std::streambuf *_sink;
+      InflateLevel _level;
+      ShiftRegister _lfsr;
+      InflateHeader _header;
+      std::streampos _header_position;
+      ByteVec _input;
+      ByteVec _output;
+      InflateStatus _status;
+      bool _closed;
+
+      bool flush_input(bool final);
+
+   protected:
+      EXPORT int_type overflow(int_type ch) override;
+      EXPORT int sync() override;
+
+   public:
+      /// @brief Throws `exception::NullPointer` if `sink` is null and `exception::UnsupportedInflateLevel` for a
+      /// level an `NFL8` header can't describe.
+      EXPORT InflateStreambuf(std::streambuf *sink,
+                              InflateLevel level=InflateLevel::INFLATE_3BIT,
+                              std::optional<std::uint32_t> seed=std::nullopt);
+      EXPORT ~InflateStreambuf();
+
+      InflateStreambuf(const InflateStreambuf &) = delete;
+      InflateStreambuf &operator=(const InflateStreambuf &) = delete;
+
+      /// @brief Inflate the remaining input and patch the header. Called by the destructor if needed.
+      EXPORT InflateStatus close();
+
+      InflateStatus status() const { return this->_status; }
+
+      /// @brief The header, complete once `close()` has returned.
+      const InflateHeader &header() const { return this->_header; }
+   };
+
+   /// @brief Reads an `NFL8` or `NFLV` stream from `source`, producing the deflated data.
+   ///
+   /// The header is parsed on the first read. When `validate` is set, the checksum is verified before the last
+   /// chunk is handed out, and the stream ends early with `STATUS_BAD_CRC` on a mismatch. Streaming validation
+   /// supports CRC32 and CRC32C.
+   class DeflateStreambuf : public std::streambuf
+   {
+      std::streambuf *_source;
+      bool _validate;
+      bool _header_read;
+      InflateHeaderV2 _header;
+      RandomEngine _rng;
+      std::uint64_t _remaining;
+      std::uint64_t _sum;
+      ByteVec _input;
+      ByteVec _output;
+      InflateStatus _status;
+
+      bool read_header();
+
+   protected:
+      EXPORT int_type underflow() override;
+
+   public:
+      EXPORT DeflateStreambuf(std::streambuf *source, bool validate=true);
+
+      DeflateStreambuf(const DeflateStreambuf &) = delete;
+      DeflateStreambuf &operator=(const DeflateStreambuf &) = delete;
+
+      InflateStatus status() const { return this->_status; }
+
+      /// @brief The stream's header, upgraded to a versioned header for `NFL8` streams. Parses it if no data
+      /// has been read yet.
+      EXPORT const InflateHeaderV2 &header();
+   };
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef __INFLATE_UPDATE_HPP
+#define __INFLATE_UPDATE_HPP
+
+/// @file update.hpp
+/// @brief Patching a few deflated bytes of an inflated stream in place, without redoing the whole stream.
+///
+/// An edit only touches the units of eight groups that hold the changed bytes. Those units are deflated out
+/// of the inflated buffer to recover the bytes around the edit, patched, and inflated back over themselves.
+/// Every other byte of the buffer is left alone.
+///
+/// The register has to be at the right state for the first unit. The RNG_PARTIAL levels shift exactly once
+/// per group, so the register is jumped there directly. The RNG_FULL levels reject repeated bit positions,
+/// so the number of shifts per group varies, although it only depends on the register and never on the
+/// data. Reaching a unit means replaying the groups before it, from the start of the stream or from the
+/// nearest of a set of `InflateCheckpoints`. An edit never changes the register's path, so checkpoints stay
+/// valid across any number of updates. Streams using a counter-based `RngEngine` jump straight to the unit at
+/// every level and never need checkpoints.
+///
+/// CRC32 and CRC32C checksums are updated from the changed bytes alone: a CRC is linear, so the new checksum
+/// is the old one plus the CRC of the difference, shifted past the bytes that follow the edit. XXH64 has no
+/// such property and is recomputed over the whole deflated stream.
+
+#include <cstdint>
+#include <vector>
+
+#include <inflate/platform.hpp>
+#include <inflate/bitstream.hpp>
+#include <inflate/format.hpp>
+
+namespace inflate
+{
+   /// @brief The default distance between checkpoints, in units of eight groups.
+   #define INFLATE_CHECKPOINT_INTERVAL 0x1000
+
+   /// @brief Register states of an RNG_FULL stream using the LFSR: `states[i]` is the register at the start
+   /// of unit `i * interval`, so `states[0]` is always the seed. Any other stream only records the seed.
+   struct InflateCheckpoints
+   {
+      std::uint64_t interval;
+      std::vector<std::uint32_t> states;
+   };
+
+   /// @brief Record the checkpoints of the `size` bytes of inflated data described by `header`, by deflating
+   /// it once. An `interval` of 0 uses `INFLATE_CHECKPOINT_INTERVAL`.
+   EXPORT InflateCheckpoints inflate_checkpoints(const void *ptr,
+                                                 std::uint64_t size,
+                                                 const InflateHeaderV2 &header,
+                                                 std::uint64_t interval=INFLATE_CHECKPOINT_INTERVAL);
+   EXPORT InflateCheckpoints inflate_checkpoints(const ByteVec &vec,
+                                                 const InflateHeaderV2 &header,
+                                                 std::uint64_t interval=INFLATE_CHECKPOINT_INTERVAL);
+
+   /// @brief Overwrite the `length` deflated bytes at `offset` with `ptr` within the `size` bytes of inflated
+   /// data at `inflated`, and update the checksum of `header` to match.
+   ///
+   /// The result is the same as inflating the edited data again with the header's seed. The header must
+   /// describe whole bytes, and the edit must lie within them, or `exception::OutOfBounds` is thrown.
+   /// `checkpoints` is only used by the RNG_FULL levels with the LFSR, and must have been recorded for the
+   /// same stream.
+   EXPORT void update_memory(std::uint8_t *inflated,
+                             std::uint64_t size,
+                             InflateHeaderV2 &header,
+                             std::uint64_t offset,
+                             const void *ptr,
+                             std::uint64_t length,
+                             const InflateCheckpoints *checkpoints=nullptr);
+   EXPORT void update_memory(ByteVec &inflated,
+                             InflateHeaderV2 &header,
+                             std::uint64_t offset,
+                             const ByteVec &bytes,
+                             const InflateCheckpoints *checkpoints=nullptr);
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef __INFLATE_UTILITY_HPP
 #define __INFLATE_UTILITY_HPP
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
@@ -11,7 +12,7 @@
 namespace inflate
 {
    /// @brief The table used for calculating a CRC32 value.
-   const std::uint32_t CRC32_TABLE[256] = { 
+   constexpr std::uint32_t CRC32_TABLE[256] = { 
       0x00000000, 0x77073096, 0xee0e612c, 0x990951ba,
       0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
       0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
@@ -81,40 +82,101 @@ namespace inflate
    EXPORT std::uint32_t crc32(const void *ptr, std::size_t size, std::uint32_t init_crc=0);
    EXPORT std::uint32_t crc32(const std::vector<std::uint8_t> &vec, std::uint32_t init_crc=0);
 
+   /// @brief A CRC32 which can be evaluated at compile time, matching the runtime `crc32` bit for bit.
+   template <std::size_t N>
+   constexpr std::uint32_t crc32(const std::array<std::uint8_t, N> &data, std::uint32_t init_crc=0) {
+      auto crc = init_crc ^ 0xFFFFFFFF;
+
+      for (std::size_t i=0; i<N; ++i)
+         crc = CRC32_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+      return crc ^ 0xFFFFFFFF;
+   }
+
+   /// @brief Generate a seed for the RNG inflate levels when the caller didn't provide one.
+   ///
+   /// Seeds come from the calling thread's `InflateContext`, so this is safe to call from any thread.
+   EXPORT std::uint32_t generate_seed();
+
    class ShiftRegister
    {
    protected:
+      static constexpr std::uint32_t TAPS = (1u << 31) | (1u << 29) | (1u << 25) | (1u << 24);
+
       std::uint32_t _reg;
       std::uint32_t _seed;
 
-   public:
-      ShiftRegister(std::optional<std::uint32_t> seed=std::nullopt) {
-         if (seed.has_value())
-            this->_seed = *seed;
-         else
-            this->_seed = 0xACE1;
+      static constexpr std::uint32_t apply(const std::uint32_t (&matrix)[32], std::uint32_t value) {
+         std::uint32_t result = 0;
+
+         for (std::uint32_t i=0; i<32; ++i)
+            if ((value >> i) & 1)
+               result ^= matrix[i];
 
-         this->_reg = this->_seed;
+         return result;
       }
-      ShiftRegister(const ShiftRegister &other) : _seed(other._seed), _reg(other._reg) {}
+
+   public:
+      constexpr ShiftRegister(std::optional<std::uint32_t> seed=std::nullopt)
+         : _reg(seed.value_or(0xACE1)),
+           _seed(seed.value_or(0xACE1))
+      {}
+      constexpr ShiftRegister(const ShiftRegister &other) : _reg(other._reg), _seed(other._seed) {}
       
-      ShiftRegister &operator=(const ShiftRegister &other) {
+      constexpr ShiftRegister &operator=(const ShiftRegister &other) {
          this->_reg = other._reg;
          this->_seed = other._seed;
          return *this;
       }
-      std::uint32_t operator*() { return this->shift(); }
+      constexpr std::uint32_t operator*() { return this->shift(); }
 
-      virtual std::uint32_t shift() {
+      constexpr std::uint32_t shift() {
          auto lsb = this->_reg & 1;
          this->_reg >>= 1;
 
-         if (lsb) { this->_reg ^= (1 << 31) | (1 << 29) | (1 << 25) | (1 << 24); }
+         if (lsb) { this->_reg ^= TAPS; }
 
          return this->_reg;
       }
-      void reset() { this->_reg = this->_seed; }
-      void reseed(std::uint32_t seed) { this->_seed = seed; }
+
+      /// @brief Advance the register by `steps` shifts in O(log steps), so a stream can be split into pieces
+      /// that are processed independently.
+      ///
+      /// A shift is linear over GF(2), so `steps` shifts are the shift matrix raised to `steps`. Matrices are
+      /// kept as their 32 columns, the images of each single-bit register.
+      constexpr void jump(std::uint64_t steps) {
+         std::uint32_t power[32] = {};
+         std::uint32_t square[32] = {};
+
+         power[0] = TAPS;
+
+         for (std::uint32_t i=1; i<32; ++i)
+            power[i] = static_cast<std::uint32_t>(1) << (i - 1);
+
+         for (; steps != 0; steps >>= 1)
+         {
+            if (steps & 1)
+               this->_reg = apply(power, this->_reg);
+
+            for (std::uint32_t i=0; i<32; ++i)
+               square[i] = apply(power, power[i]);
+
+            for (std::uint32_t i=0; i<32; ++i)
+               power[i] = square[i];
+         }
+      }
+
+      /// @brief The current register, which `restore` puts back. Saving it is enough to resume a stream from
+      /// any point, however many shifts it took to get there.
+      constexpr std::uint32_t state() const { return this->_reg; }
+      constexpr void restore(std::uint32_t state) { this->_reg = state; }
+
+      /// @brief The draws of the next group, which for a single register are just the shifts that follow.
+      /// See `CounterRng` for generators that keep groups apart.
+      constexpr ShiftRegister &next_group() { return *this; }
+
+      constexpr void reset() { this->_reg = this->_seed; }
+      constexpr void reseed(std::uint32_t seed) { this->_seed = seed; }
    };
 }
 #endif
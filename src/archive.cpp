@@ -0,0 +1,325 @@
+#include "internal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INFLATE_MMAP
+#endif
+
+using namespace inflate;
+using namespace inflate::internal;
+
+namespace
+{
+   const std::size_t MAGIC_SIZE = 4;
+
+   std::uint64_t align_up(std::uint64_t offset, std::uint32_t alignment) noexcept {
+      if (alignment <= 1)
+         return offset;
+
+      return (offset + alignment - 1) & ~static_cast<std::uint64_t>(alignment - 1);
+   }
+
+   /// @brief Inflate every source straight into its place in the archive, handing members out to the workers
+   /// one at a time.
+   void inflate_members(const std::vector<ArchiveSource> &sources,
+                        const std::vector<InflateOptions> &options,
+                        const std::vector<InflateArchiveEntry> &entries,
+                        std::uint8_t *output,
+                        std::size_t threads)
+   {
+      std::vector<std::exception_ptr> errors(sources.size());
+      std::atomic<std::size_t> next(0);
+
+      auto work = [&]() {
+         for (auto index=next++; index<sources.size(); index=next++)
+         {
+            try { write_disk_stream(output+entries[index].offset, sources[index].ptr, sources[index].size, options[index]); }
+            catch (...) { errors[index] = std::current_exception(); }
+         }
+      };
+
+      if (threads == 0)
+         threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+      threads = std::min(threads, sources.size());
+
+      if (threads <= 1)
+         work();
+      else
+      {
+         std::vector<std::thread> workers;
+
+         for (std::size_t t=0; t<threads; ++t)
+            workers.emplace_back(work);
+
+         for (auto &worker : workers)
+            worker.join();
+      }
+
+      // report the failure of the earliest member, whichever thread hit it.
+      for (auto &error : errors)
+         if (error != nullptr)
+            std::rethrow_exception(error);
+   }
+}
+
+ByteVec inflate::inflate_archive(const std::vector<ArchiveSource> &sources, const InflateOptions &options, std::size_t threads) {
+   INFLATE_STATS_SCOPE("inflate_archive");
+
+   if (!is_supported_alignment(options.alignment))
+      throw exception::BadAlignment(options.alignment);
+
+   std::vector<InflateOptions> member_options(sources.size(), options);
+
+   for (auto &member : member_options)
+      if (!member.seed.has_value())
+         member.seed = thread_context().next_seed();
+
+   // every member's size is known up front, so the archive is laid out first and the members are inflated
+   // straight into it.
+   std::vector<InflateArchiveEntry> entries(sources.size());
+   std::uint64_t offset = MAGIC_SIZE;
+   std::uint64_t directory_size = 0;
+   auto payload_offset = disk_payload_offset(options, true);
+
+   for (std::size_t i=0; i<sources.size(); ++i)
+   {
+      auto &entry = entries[i];
+      std::memset(&entry, 0, sizeof(InflateArchiveEntry));
+
+      offset = align_up(offset, options.alignment);
+      entry.offset = offset;
+      entry.size = payload_offset + inflated_size(options, sources[i].size);
+      entry.deflated = sources[i].size;
+      entry.name_size = static_cast<std::uint32_t>(sources[i].name.size());
+      entry.level = options.level;
+
+      offset += entry.size;
+      directory_size += sizeof(InflateArchiveEntry) + entry.name_size;
+   }
+
+   InflateArchiveTrailer trailer;
+   trailer.directory_offset = offset;
+   trailer.directory_size = directory_size;
+   trailer.members = sources.size();
+   std::memcpy(trailer.magic, INFLATE_ARCHIVE_MAGIC, MAGIC_SIZE);
+
+   ByteVec result(offset + directory_size + sizeof(InflateArchiveTrailer));
+   std::memcpy(result.data(), INFLATE_ARCHIVE_MAGIC, MAGIC_SIZE);
+
+   inflate_members(sources, member_options, entries, result.data(), threads);
+
+   {
+      INFLATE_STATS_TIMER(assembly_ns);
+
+      auto directory = result.data() + trailer.directory_offset;
+
+      for (std::size_t i=0; i<sources.size(); ++i)
+      {
+         std::memcpy(directory, &entries[i], sizeof(InflateArchiveEntry));
+         std::memcpy(directory+sizeof(InflateArchiveEntry), sources[i].name.data(), entries[i].name_size);
+         directory += sizeof(InflateArchiveEntry) + entries[i].name_size;
+      }
+
+      trailer.directory_checksum = crc32(result.data()+trailer.directory_offset, directory_size);
+      std::memcpy(directory, &trailer, sizeof(InflateArchiveTrailer));
+   }
+
+   INFLATE_STATS_ADD(bytes_out, result.size());
+
+   return result;
+}
+
+inflate::ArchiveReader::ArchiveReader(const void *ptr, std::uint64_t size)
+   : _data(reinterpret_cast<const std::uint8_t *>(ptr)), _size(size), _mapping(nullptr)
+{
+   if (ptr == nullptr)
+      throw exception::NullPointer();
+
+   this->parse();
+}
+
+inflate::ArchiveReader::ArchiveReader(const ByteVec &vec) : ArchiveReader(vec.data(), vec.size()) {}
+
+inflate::ArchiveReader::ArchiveReader(const std::string &path) : _data(nullptr), _size(0), _mapping(nullptr) {
+#if defined(INFLATE_MMAP)
+   auto fd = open(path.c_str(), O_RDONLY);
+
+   if (fd < 0)
+      throw exception::OpenFailed(path);
+
+   struct stat info;
+
+   if (fstat(fd, &info) != 0)
+   {
+      close(fd);
+      throw exception::OpenFailed(path);
+   }
+
+   this->_size = static_cast<std::uint64_t>(info.st_size);
+
+   // an empty file can't be mapped, but it isn't an archive either, which parse() reports.
+   if (this->_size != 0)
+   {
+      auto mapping = mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (mapping == MAP_FAILED)
+      {
+         close(fd);
+         throw exception::OpenFailed(path);
+      }
+
+      this->_mapping = mapping;
+      this->_data = reinterpret_cast<const std::uint8_t *>(mapping);
+   }
+
+   close(fd);
+#else
+   std::ifstream file(path, std::ios::binary);
+
+   if (!file.is_open())
+      throw exception::OpenFailed(path);
+
+   auto buffer = new ByteVec(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   this->_mapping = buffer;
+   this->_data = buffer->data();
+   this->_size = buffer->size();
+#endif
+
+   try { this->parse(); }
+   catch (...) { this->release(); throw; }
+}
+
+inflate::ArchiveReader::ArchiveReader(ArchiveReader &&other) noexcept
+   : _data(other._data),
+     _size(other._size),
+     _mapping(other._mapping),
+     _members(std::move(other._members)),
+     _index(std::move(other._index))
+{
+   other._data = nullptr;
+   other._size = 0;
+   other._mapping = nullptr;
+}
+
+ArchiveReader &inflate::ArchiveReader::operator=(ArchiveReader &&other) noexcept {
+   if (this == &other)
+      return *this;
+
+   this->release();
+
+   this->_data = other._data;
+   this->_size = other._size;
+   this->_mapping = other._mapping;
+   this->_members = std::move(other._members);
+   this->_index = std::move(other._index);
+
+   other._data = nullptr;
+   other._size = 0;
+   other._mapping = nullptr;
+
+   return *this;
+}
+
+void inflate::ArchiveReader::release() noexcept {
+   if (this->_mapping == nullptr)
+      return;
+
+#if defined(INFLATE_MMAP)
+   munmap(this->_mapping, this->_size);
+#else
+   delete reinterpret_cast<ByteVec *>(this->_mapping);
+#endif
+
+   this->_mapping = nullptr;
+   this->_data = nullptr;
+   this->_size = 0;
+}
+
+void inflate::ArchiveReader::parse() {
+   if (this->_size < MAGIC_SIZE + sizeof(InflateArchiveTrailer))
+      throw exception::InsufficientSize(this->_size, MAGIC_SIZE + sizeof(InflateArchiveTrailer));
+
+   InflateArchiveTrailer trailer;
+   auto trailer_offset = this->_size - sizeof(InflateArchiveTrailer);
+   std::memcpy(&trailer, this->_data+trailer_offset, sizeof(InflateArchiveTrailer));
+
+   if (std::memcmp(this->_data, INFLATE_ARCHIVE_MAGIC, MAGIC_SIZE) != 0
+       || std::memcmp(trailer.magic, INFLATE_ARCHIVE_MAGIC, MAGIC_SIZE) != 0)
+      throw exception::BadHeaderMagic();
+
+   if (trailer.directory_offset < MAGIC_SIZE
+       || trailer.directory_offset > trailer_offset
+       || trailer.directory_size != trailer_offset - trailer.directory_offset)
+      throw exception::BadHeader();
+
+   auto directory = this->_data + trailer.directory_offset;
+   auto sum = crc32(directory, trailer.directory_size);
+
+   if (sum != trailer.directory_checksum)
+      throw exception::BadCRC(sum, trailer.directory_checksum);
+
+   // every entry takes at least its fixed part, which bounds the count before anything is allocated.
+   if (trailer.members > trailer.directory_size / sizeof(InflateArchiveEntry))
+      throw exception::BadHeader();
+
+   this->_members.reserve(trailer.members);
+   std::uint64_t cursor = 0;
+
+   for (std::uint64_t i=0; i<trailer.members; ++i)
+   {
+      InflateArchiveEntry entry;
+
+      if (trailer.directory_size - cursor < sizeof(InflateArchiveEntry))
+         throw exception::BadHeader();
+
+      std::memcpy(&entry, directory+cursor, sizeof(InflateArchiveEntry));
+      cursor += sizeof(InflateArchiveEntry);
+
+      if (trailer.directory_size - cursor < entry.name_size
+          || entry.offset < MAGIC_SIZE
+          || entry.offset > trailer.directory_offset
+          || entry.size > trailer.directory_offset - entry.offset)
+         throw exception::BadHeader();
+
+      auto name = std::string(reinterpret_cast<const char *>(directory+cursor), entry.name_size);
+      cursor += entry.name_size;
+
+      this->_index.emplace(name, this->_members.size());
+      this->_members.push_back(ArchiveMember{std::move(name), entry.offset, entry.size, entry.deflated, static_cast<InflateLevel>(entry.level)});
+   }
+
+   if (cursor != trailer.directory_size)
+      throw exception::BadHeader();
+}
+
+const ArchiveMember *inflate::ArchiveReader::find(const std::string &name) const noexcept {
+   auto found = this->_index.find(name);
+   return (found == this->_index.end()) ? nullptr : &this->_members[found->second];
+}
+
+InflateContainer inflate::ArchiveReader::container(const ArchiveMember &member) const {
+   return parse_container(this->member_data(member), member.size);
+}
+
+ByteVec inflate::ArchiveReader::extract(const ArchiveMember &member) const {
+   return deflate_disk(this->member_data(member), member.size);
+}
+
+ByteVec inflate::ArchiveReader::extract(const std::string &name) const {
+   auto member = this->find(name);
+
+   if (member == nullptr)
+      throw exception::MemberNotFound(name);
+
+   return this->extract(*member);
+}
@@ -2,6 +2,81 @@
 
 using namespace inflate;
 
+namespace
+{
+   inline std::uint64_t load64(const std::uint8_t *ptr) noexcept {
+      std::uint64_t word = 0;
+
+      for (std::uint32_t i=0; i<8; ++i)
+         word |= static_cast<std::uint64_t>(ptr[i]) << (i * 8);
+
+      return word;
+   }
+
+   inline std::uint32_t popcount64(std::uint64_t word) noexcept {
+#if defined(__GNUC__)
+      return static_cast<std::uint32_t>(__builtin_popcountll(word));
+#else
+      word = word - ((word >> 1) & 0x5555555555555555ull);
+      word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+      word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+      return static_cast<std::uint32_t>((word * 0x0101010101010101ull) >> 56);
+#endif
+   }
+
+   inline std::uint32_t lowest_bit(std::uint64_t word) noexcept {
+#if defined(__GNUC__)
+      return static_cast<std::uint32_t>(__builtin_ctzll(word));
+#else
+      std::uint32_t index = 0;
+
+      for (; (word & 1) == 0; word >>= 1)
+         ++index;
+
+      return index;
+#endif
+   }
+
+   /// @brief Read `count` bits, 1 to 64, starting at bit `index`.
+   std::uint64_t load_bits(const std::uint8_t *data, std::uint64_t index, std::uint32_t count) noexcept {
+      auto byte = index / 8;
+      auto shift = static_cast<std::uint32_t>(index % 8);
+      auto bytes = (shift + count + 7) / 8;
+      std::uint64_t word = 0;
+
+      if (bytes >= 8)
+         word = load64(data+byte);
+      else
+         for (std::uint32_t i=0; i<bytes; ++i)
+            word |= static_cast<std::uint64_t>(data[byte+i]) << (i * 8);
+
+      word >>= shift;
+
+      if (bytes > 8)
+         word |= static_cast<std::uint64_t>(data[byte+8]) << (64 - shift);
+
+      return (count == 64) ? word : word & ((static_cast<std::uint64_t>(1) << count) - 1);
+   }
+
+   /// @brief Write the low `count` bits of `word`, 1 to 64, starting at bit `index`.
+   void store_bits(std::uint8_t *data, std::uint64_t index, std::uint32_t count, std::uint64_t word) noexcept {
+      for (std::uint32_t written=0; written<count;)
+      {
+         auto bit = static_cast<std::uint32_t>((index + written) % 8);
+         auto take = std::min<std::uint32_t>(8 - bit, count - written);
+         auto mask = static_cast<std::uint8_t>(((1u << take) - 1) << bit);
+         auto &byte = data[(index + written) / 8];
+
+         byte = static_cast<std::uint8_t>((byte & ~mask) | ((static_cast<std::uint8_t>(word >> written) << bit) & mask));
+         written += take;
+      }
+   }
+
+   inline std::uint32_t chunk(std::uint64_t index, std::uint64_t last) noexcept {
+      return static_cast<std::uint32_t>(std::min<std::uint64_t>(64, last - index));
+   }
+}
+
 BitVec inflate::to_bitvec(const ByteVec &byte_vec) {
    BitVec result;
 
@@ -31,46 +106,23 @@ ByteVec inflate::to_bytevec(const BitVec &bit_vec) {
    return result;
 }
 
-BitstreamPtr &BitstreamPtr::operator=(const BitstreamPtr &other) {
-   this->_data.m = other._data.m;
-   this->_size = other._size;
-   this->_const = other._const;
-
-   return *this;
-}
-
-BitstreamPtr::reference BitstreamPtr::operator[](std::uint64_t index)
-{
-   if (index >= this->bit_size())
-      throw exception::OutOfBounds(index, this->bit_size());
-   
-   return BitstreamPtr::reference(this, index);
+ConstBitstreamPtr::ConstBitstreamPtr(const std::uint8_t *data, std::uint64_t size) : _data(data), _size(size) {
+   if (data == nullptr && size != 0)
+      throw exception::NullPointer();
 }
 
-bool BitstreamPtr::operator[](std::uint64_t index) const
-{
-   if (index >= this->bit_size())
-      throw exception::OutOfBounds(index, this->bit_size());
-   
+bool ConstBitstreamPtr::operator[](std::uint64_t index) const {
    return this->get_bit(index);
 }
 
-bool BitstreamPtr::operator==(const BitstreamPtr &other) const {
+bool ConstBitstreamPtr::operator==(const ConstBitstreamPtr &other) const {
    if (this->_size != other._size) { return false; }
+   if (this->_size == 0) { return true; }
 
-   for (std::uint64_t i=0; i<other.bit_size(); ++i)
-   {
-      auto left = this->get_bit(i);
-      auto right = other.get_bit(i);
-      
-      if (left != right)
-         return false;
-   }
-
-   return true;
+   return equal_bits(this->_data, 0, this->_size, other._data, 0);
 }
 
-bool BitstreamPtr::operator==(const BitVec &other) const {
+bool ConstBitstreamPtr::operator==(const BitVec &other) const {
    if (this->_size != other.size()) { return false; }
 
    for (std::uint64_t i=0; i<other.size(); ++i)
@@ -80,98 +132,87 @@ bool BitstreamPtr::operator==(const BitVec &other) const {
    return true;
 }
 
-bool BitstreamPtr::get_bit(std::uint64_t index) const {
-   if (this->_data.c == nullptr)
-      throw exception::NullPointer();
-   
-   if (index >= this->bit_size())
-      throw exception::OutOfBounds(index, this->bit_size());
-
-   auto byte_offset = index / 8;
-   auto bit_offset = index % 8;
+bool ConstBitstreamPtr::get_bit(std::uint64_t index) const {
+   // a null stream is empty, so the bounds check covers it.
+   if (index >= this->_size)
+      throw exception::OutOfBounds(index, this->_size);
 
-   return static_cast<bool>((this->_data.c[byte_offset] >> bit_offset) & 1);
+   return static_cast<bool>((this->_data[index / 8] >> (index % 8)) & 1);
 }
 
-void BitstreamPtr::set_bit(std::uint64_t index, bool bit) {
-   if (this->_const)
-      throw exception::ConstConflict();
-   
-   if (this->_data.m == nullptr)
-      throw exception::NullPointer();
+std::uint8_t ConstBitstreamPtr::get_byte(std::uint64_t index) const {
+   if (index >= this->byte_size())
+      throw exception::OutOfBounds(index, this->byte_size());
 
-   if (index >= this->bit_size())
-      throw exception::OutOfBounds(index, this->bit_size());
+   return this->_data[index];
+}
 
-   auto byte_offset = index / 8;
-   auto bit_offset = index % 8;
-   std::uint8_t bit_mask = (1 << bit_offset) ^ 0xFF;
+void ConstBitstreamPtr::set_data(const std::uint8_t *data, std::uint64_t size) {
+   if (data == nullptr && size != 0)
+      throw exception::NullPointer();
 
-   this->_data.m[byte_offset] = (this->_data.m[byte_offset] & bit_mask) | (static_cast<std::uint8_t>(bit) << bit_offset);
+   this->_data = data;
+   this->_size = size;
 }
 
-void BitstreamPtr::flip_bit(std::uint64_t index) {
-   this->set_bit(index, !this->get_bit(index));
-}
+BitstreamVec ConstBitstreamPtr::read_bits(std::uint64_t index, std::uint64_t size) const {
+   if (index+size > this->bit_size())
+      throw exception::OutOfBounds(index+size, this->bit_size());
 
-std::uint8_t BitstreamPtr::get_byte(std::uint64_t index) const {
-   if (this->_data.c == nullptr)
-      throw exception::NullPointer();
+   BitstreamVec result(size);
 
-   if (index >= this->byte_size())
-      throw exception::OutOfBounds(index, this->byte_size());
+   for (std::uint64_t i=0; i<size; ++i)
+      result[i] = this->get_bit(i+index);
 
-   return this->_data.c[index];
+   return result;
 }
 
-void BitstreamPtr::set_byte(std::uint64_t index, std::uint8_t byte) {
-   if (this->_const)
-      throw exception::ConstConflict();
-   
-   if (this->_data.m == nullptr)
-      throw exception::NullPointer();
+BitVec ConstBitstreamPtr::to_bitvec() const {
+   BitVec result;
+   result.reserve(this->_size);
 
-   if (index >= this->byte_size())
-      throw exception::OutOfBounds(index, this->byte_size());
+   copy(this->cbegin(), this->cend(), std::back_inserter(result));
 
-   this->_data.m[index] = byte;
+   return result;
 }
 
-std::size_t BitstreamPtr::bit_size() const { return this->_size; }
-std::size_t BitstreamPtr::byte_size() const { return this->_size / 8 + static_cast<std::size_t>(this->_size % 8 != 0); }
+ByteVec ConstBitstreamPtr::to_bytevec() const {
+   return ByteVec(this->_data, this->_data+this->byte_size());
+}
 
-const std::uint8_t *BitstreamPtr::data() const { return this->_data.c; }
+BitstreamVec ConstBitstreamPtr::to_vec() const { return BitstreamVec(this->_data, this->_size); }
 
-void BitstreamPtr::set_data(std::uint8_t *data, std::uint64_t size) {
-   this->_data.m = data;
-   this->_size = size;
-   this->_const = false;
+MutBitstreamPtr::reference MutBitstreamPtr::operator[](std::uint64_t index) {
+   if (index >= this->_size)
+      throw exception::OutOfBounds(index, this->_size);
+   
+   return MutBitstreamPtr::reference(this, index);
 }
 
-void BitstreamPtr::set_data(const std::uint8_t *data, std::uint64_t size) {
-   this->_data.c = data;
-   this->_size = size;
-   this->_const = true;
-}
+void MutBitstreamPtr::set_bit(std::uint64_t index, bool bit) {
+   if (index >= this->_size)
+      throw exception::OutOfBounds(index, this->_size);
 
-BitstreamVec BitstreamPtr::read_bits(std::uint64_t index, std::uint64_t size) const {
-   BitstreamVec result;
+   auto data = this->mutable_data();
+   auto byte_offset = index / 8;
+   auto bit_offset = index % 8;
+   std::uint8_t bit_mask = (1 << bit_offset) ^ 0xFF;
 
-   if (index+size > this->bit_size())
-      throw exception::OutOfBounds(index+size, this->bit_size());
+   data[byte_offset] = (data[byte_offset] & bit_mask) | (static_cast<std::uint8_t>(bit) << bit_offset);
+}
 
-   result = BitstreamVec(size);
+void MutBitstreamPtr::flip_bit(std::uint64_t index) {
+   this->set_bit(index, !this->get_bit(index));
+}
 
-   for (std::uint64_t i=0; i<size; ++i)
-      result[i] = this->get_bit(i+index);
+void MutBitstreamPtr::set_byte(std::uint64_t index, std::uint8_t byte) {
+   if (index >= this->byte_size())
+      throw exception::OutOfBounds(index, this->byte_size());
 
-   return result;
+   this->mutable_data()[index] = byte;
 }
 
-void BitstreamPtr::write_bits(std::uint64_t index, const BitVec &bits) {
-   if (this->_const)
-      throw exception::ConstConflict();
-   
+void MutBitstreamPtr::write_bits(std::uint64_t index, const BitVec &bits) {
    if (index+bits.size() > this->bit_size())
       throw exception::OutOfBounds(index+bits.size(), this->bit_size());
 
@@ -179,25 +220,16 @@ void BitstreamPtr::write_bits(std::uint64_t index, const BitVec &bits) {
       this->set_bit(i, bits[i-index]);
 }
 
-void BitstreamPtr::write_bits(std::uint64_t index, const BitstreamPtr &bits) {
-   if (this->_const)
-      throw exception::ConstConflict();
-   
+void MutBitstreamPtr::write_bits(std::uint64_t index, const ConstBitstreamPtr &bits) {
+   this->write_bits(index, bits.span());
+}
+
+void MutBitstreamPtr::write_bits(std::uint64_t index, const ConstBitSpan &bits) {
    if (index+bits.bit_size() > this->bit_size())
       throw exception::OutOfBounds(index+bits.bit_size(), this->bit_size());
 
-   for (std::uint64_t i=index; i<index+bits.bit_size(); ++i)
-      this->set_bit(i, bits[i-index]);
-}
-
-BitVec BitstreamPtr::to_bitvec() const { return BitVec(this->cbegin(), this->cend()); }
-ByteVec BitstreamPtr::to_bytevec() const {
-   if (this->_data.c == nullptr)
-      throw exception::NullPointer();
-   
-   return ByteVec(this->_data.c, this->_data.c+this->byte_size());
+   bits.copy_to(this->mutable_span(index, bits.bit_size()));
 }
-BitstreamVec BitstreamPtr::to_vec() const { return BitstreamVec(this->_data.c, this->_size); }
 
 BitstreamVec &BitstreamVec::operator=(const BitstreamVec &other) {
    this->_vec = other._vec;
@@ -206,28 +238,48 @@ BitstreamVec &BitstreamVec::operator=(const BitstreamVec &other) {
    return *this;
 }
 
+BitstreamVec &BitstreamVec::operator=(BitstreamVec &&other) noexcept {
+   if (this == &other)
+      return *this;
+
+   this->_vec = std::move(other._vec);
+   this->set_data(this->_vec.data(), other._size);
+
+   other._vec.clear();
+   other.set_data(other._vec.data(), 0);
+
+   return *this;
+}
+
 void BitstreamVec::resize(std::uint64_t bits) {
-   std::intptr_t delta = static_cast<std::int64_t>(bits) - this->_size;
    auto old = this->_size;
+   auto old_bytes = this->byte_size();
+   auto bytes = bits / 8 + static_cast<std::uint64_t>(bits % 8 != 0);
 
-   if (delta < 0 && bits % 8 != 0)
-   {
-      auto trailing_bits = 8 - bits % 8;
-      auto trailing_mask = 0xFF >> trailing_bits;
-      auto byte_offset = bits / 8;
-      this->_vec[byte_offset] &= trailing_mask;
-   }
-   
-   this->_size = bits;
+   if (bits > old && bytes > this->_vec.capacity())
+      this->_vec.reserve(std::max<std::uint64_t>(bytes, this->_vec.capacity() * 2));
+
+   this->_vec.resize(bytes);
 
-   if (this->byte_size() != this->_vec.size())
+   // bits past the end are kept at zero, but a vector built from a larger ByteVec can hold stale bytes past
+   // the stream, so growing clears everything the stream didn't own.
+   if (bits > old)
    {
-      this->_vec.resize(this->byte_size());
-      this->set_data(this->_vec.data(), this->_size);
+      if (old % 8 != 0)
+         this->_vec[old / 8] &= 0xFF >> (8 - old % 8);
+
+      if (bytes > old_bytes)
+         std::memset(this->_vec.data()+old_bytes, 0, bytes-old_bytes);
    }
+   else if (bits % 8 != 0)
+      this->_vec[bits / 8] &= 0xFF >> (8 - bits % 8);
+
+   this->set_data(this->_vec.data(), bits);
+}
 
-   if (delta > 0)
-      this->write_bits(old, BitVec(delta, false));
+void BitstreamVec::reserve(std::uint64_t bits) {
+   this->_vec.reserve(bits / 8 + static_cast<std::uint64_t>(bits % 8 != 0));
+   this->set_data(this->_vec.data(), this->_size);
 }
 
 void BitstreamVec::push_bit(bool bit) {
@@ -244,6 +296,20 @@ void BitstreamVec::push_bits(const BitVec &bits) {
    this->write_bits(index, bits);
 }
 
+void BitstreamVec::push_bits(const ConstBitSpan &bits) {
+   // growing may move the buffer out from under a span of this stream.
+   if (bits.overlaps(this->span()))
+   {
+      this->push_bits(BitstreamVec(bits).span());
+      return;
+   }
+
+   auto index = this->_size;
+   this->resize(this->_size+bits.bit_size());
+
+   this->write_bits(index, bits);
+}
+
 bool BitstreamVec::pop_bit() {
    if (this->bit_size() == 0)
       throw exception::NoBits();
@@ -295,6 +361,23 @@ void BitstreamVec::insert_bits(std::uint64_t index, const BitVec &bits) {
    this->write_bits(index+bits.size(), end_bits);
 }
 
+void BitstreamVec::insert_bits(std::uint64_t index, const ConstBitSpan &bits) {
+   if (index > this->_size)
+      throw exception::OutOfBounds(index, this->_size);
+
+   if (bits.overlaps(this->span()))
+   {
+      this->insert_bits(index, BitstreamVec(bits).span());
+      return;
+   }
+
+   auto rest = this->_size - index;
+
+   this->resize(this->_size + bits.bit_size());
+   this->span(index, rest).copy_to(this->mutable_span(index+bits.bit_size(), rest));
+   this->write_bits(index, bits);
+}
+
 void BitstreamVec::erase_bit(std::uint64_t index) {
    this->erase_bits(index, 1);
 }
@@ -316,3 +399,103 @@ void BitstreamVec::erase_bits(std::uint64_t index, std::uint64_t size) {
    this->resize(this->bit_size()-size);
    this->write_bits(index, bits);
 }
+
+std::uint64_t inflate::count_bits(const std::uint8_t *data, std::uint64_t first, std::uint64_t last, bool value) noexcept {
+   std::uint64_t ones = 0;
+
+   for (auto index=first; index<last; index+=64)
+      ones += popcount64(load_bits(data, index, chunk(index, last)));
+
+   return (value) ? ones : (last - first) - ones;
+}
+
+std::uint64_t inflate::find_bit(const std::uint8_t *data, std::uint64_t first, std::uint64_t last, bool value) noexcept {
+   for (auto index=first; index<last; index+=64)
+   {
+      auto count = chunk(index, last);
+      auto word = load_bits(data, index, count);
+
+      if (!value)
+         word = ~word & ((count == 64) ? ~static_cast<std::uint64_t>(0) : (static_cast<std::uint64_t>(1) << count) - 1);
+
+      if (word != 0)
+         return index + lowest_bit(word);
+   }
+
+   return last;
+}
+
+void inflate::fill_bits(std::uint8_t *data, std::uint64_t first, std::uint64_t last, bool value) noexcept {
+   auto fill = (value) ? ~static_cast<std::uint64_t>(0) : 0;
+   auto head_end = std::min(last, (first + 7) / 8 * 8);
+
+   if (first < head_end)
+      store_bits(data, first, static_cast<std::uint32_t>(head_end - first), fill);
+
+   if (head_end >= last)
+      return;
+
+   auto whole_bytes = (last - head_end) / 8;
+   std::memset(data+head_end/8, (value) ? 0xFF : 0, whole_bytes);
+
+   auto tail = head_end + whole_bytes * 8;
+
+   if (tail < last)
+      store_bits(data, tail, static_cast<std::uint32_t>(last - tail), fill);
+}
+
+void inflate::copy_bits(const std::uint8_t *input,
+                        std::uint64_t first,
+                        std::uint64_t last,
+                        std::uint8_t *output,
+                        std::uint64_t output_first) noexcept
+{
+   // byte-aligned on both sides is just a memmove and a partial tail.
+   if (first % 8 == 0 && output_first % 8 == 0)
+   {
+      auto whole_bytes = (last - first) / 8;
+      std::memmove(output+output_first/8, input+first/8, whole_bytes);
+
+      first += whole_bytes * 8;
+      output_first += whole_bytes * 8;
+   }
+
+   for (auto index=first; index<last; index+=64)
+   {
+      auto count = chunk(index, last);
+      store_bits(output, output_first + (index - first), count, load_bits(input, index, count));
+   }
+}
+
+bool inflate::equal_bits(const std::uint8_t *left,
+                         std::uint64_t first,
+                         std::uint64_t last,
+                         const std::uint8_t *right,
+                         std::uint64_t right_first) noexcept
+{
+   for (auto index=first; index<last; index+=64)
+   {
+      auto count = chunk(index, last);
+
+      if (load_bits(left, index, count) != load_bits(right, right_first + (index - first), count))
+         return false;
+   }
+
+   return true;
+}
+
+const std::uint8_t *inflate::detail::bit_range(const ConstBitstreamPtr *stream, std::uint64_t first, std::uint64_t last) {
+   if (stream == nullptr)
+      throw exception::NullPointer();
+
+   if (first > last)
+      throw exception::OutOfBounds(first, last);
+
+   if (last > stream->bit_size())
+      throw exception::OutOfBounds(last, stream->bit_size());
+
+   if (stream->data() == nullptr && first != last)
+      throw exception::NullPointer();
+
+   return stream->data();
+}
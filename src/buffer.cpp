@@ -0,0 +1,170 @@
+#include <inflate.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define INFLATE_MMAP
+#endif
+
+using namespace inflate;
+
+namespace
+{
+   std::size_t page_size() noexcept {
+#if defined(INFLATE_MMAP)
+      static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+      return size;
+#else
+      return 0x1000;
+#endif
+   }
+
+   /// `MAP_HUGETLB` maps pages of the system's default huge page size, which is 2 MiB on x86-64 but can be
+   /// 1 GiB, or 512 MiB on arm64 with 64 KiB pages. 0 if it can't be read, in which case the pool is not used.
+   std::size_t huge_page_size() noexcept {
+#if defined(__linux__)
+      static const std::size_t size = []() -> std::size_t {
+         std::ifstream meminfo("/proc/meminfo");
+         std::string key;
+         std::size_t value = 0;
+
+         while (meminfo >> key)
+         {
+            if (key == "Hugepagesize:" && meminfo >> value)
+               return value * 1024;
+
+            meminfo.ignore(0x100, '\n');
+         }
+
+         return 0;
+      }();
+
+      return size;
+#else
+      return 0;
+#endif
+   }
+
+   void touch_pages(std::uint8_t *ptr, std::size_t size, std::size_t stride) noexcept {
+      // rewriting a byte faults the page in for writing without changing what's there.
+      auto volatile_ptr = reinterpret_cast<volatile std::uint8_t *>(ptr);
+
+      for (std::size_t offset=0; offset<size; offset+=stride)
+         volatile_ptr[offset] = volatile_ptr[offset];
+   }
+}
+
+inflate::LargeBuffer::LargeBuffer(std::size_t size, const LargeBufferOptions &options)
+   : _data(nullptr), _size(size), _mapped(0), _backing(LargeBufferBacking::LARGE_BUFFER_EMPTY)
+{
+   if (size == 0)
+      return;
+
+#if defined(INFLATE_MMAP)
+   void *ptr = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+   auto huge_page = huge_page_size();
+
+   if (options.hugetlb && huge_page != 0)
+   {
+      auto rounded = (size + huge_page - 1) / huge_page * huge_page;
+      ptr = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+      if (ptr != MAP_FAILED)
+      {
+         this->_mapped = rounded;
+         this->_backing = LargeBufferBacking::LARGE_BUFFER_HUGETLB;
+      }
+   }
+#endif
+
+   if (ptr == MAP_FAILED)
+   {
+      ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (ptr == MAP_FAILED)
+         throw std::bad_alloc();
+
+      this->_mapped = size;
+      this->_backing = LargeBufferBacking::LARGE_BUFFER_MAPPED;
+
+#if defined(MADV_HUGEPAGE)
+      // only advice: without transparent huge pages the mapping simply keeps its small pages.
+      if (options.huge_pages)
+         madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+   }
+
+   this->_data = reinterpret_cast<std::uint8_t *>(ptr);
+#else
+   (void)options;
+
+   this->_data = new std::uint8_t[size];
+   this->_backing = LargeBufferBacking::LARGE_BUFFER_HEAP;
+#endif
+}
+
+void inflate::LargeBuffer::release() noexcept {
+   if (this->_data == nullptr)
+      return;
+
+#if defined(INFLATE_MMAP)
+   munmap(this->_data, this->_mapped);
+#else
+   delete[] this->_data;
+#endif
+
+   this->_data = nullptr;
+   this->_size = 0;
+   this->_mapped = 0;
+   this->_backing = LargeBufferBacking::LARGE_BUFFER_EMPTY;
+}
+
+void inflate::LargeBuffer::prefault(std::size_t threads) noexcept {
+   if (this->_size == 0)
+      return;
+
+   auto stride = (this->_backing == LargeBufferBacking::LARGE_BUFFER_HUGETLB) ? huge_page_size() : page_size();
+   auto pages = (this->_size + stride - 1) / stride;
+
+   if (threads == 0)
+      threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+   threads = std::min(threads, pages);
+
+   std::vector<std::thread> workers;
+   auto per_thread = pages / threads;
+   std::size_t first_page = 0;
+
+   for (std::size_t t=0; t<threads; ++t)
+   {
+      auto count = (t == threads-1) ? pages - first_page : per_thread;
+      auto offset = first_page * stride;
+      auto length = std::min(count * stride, this->_size - offset);
+
+      // the calling thread takes the last share, and any share a thread couldn't be started for.
+      if (t == threads-1)
+         touch_pages(this->_data+offset, length, stride);
+      else
+      {
+         try { workers.emplace_back(touch_pages, this->_data+offset, length, stride); }
+         catch (std::exception &) { touch_pages(this->_data+offset, length, stride); }
+      }
+
+      first_page += count;
+   }
+
+   for (auto &worker : workers)
+      worker.join();
+}
+
+ByteVec inflate::LargeBuffer::to_bytevec() const {
+   return ByteVec(this->begin(), this->end());
+}
@@ -0,0 +1,402 @@
+#include <inflate.hpp>
+
+#include <thread>
+
+#if defined(INFLATE_X86)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#include <smmintrin.h>
+#endif
+
+using namespace inflate;
+
+namespace
+{
+   struct SliceTables
+   {
+      std::uint32_t table[8][256];
+   };
+
+   /// slicing-by-8 tables for a reflected CRC: table[k][b] is the CRC of byte b followed by k zero bytes.
+   constexpr SliceTables make_slice_tables(std::uint32_t polynomial) {
+      SliceTables result {};
+
+      for (std::uint32_t i=0; i<256; ++i)
+      {
+         auto crc = i;
+
+         for (int bit=0; bit<8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+
+         result.table[0][i] = crc;
+      }
+
+      for (std::uint32_t k=1; k<8; ++k)
+         for (std::uint32_t i=0; i<256; ++i)
+            result.table[k][i] = (result.table[k-1][i] >> 8) ^ result.table[0][result.table[k-1][i] & 0xFF];
+
+      return result;
+   }
+
+   const std::uint32_t CRC32_POLYNOMIAL = 0xEDB88320;
+   const std::uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+   const std::size_t CRC_THREAD_MINIMUM = 0x100000;
+
+   constexpr SliceTables CRC32_SLICES = make_slice_tables(CRC32_POLYNOMIAL);
+   constexpr SliceTables CRC32C_SLICES = make_slice_tables(CRC32C_POLYNOMIAL);
+
+   /// multiply two polynomials modulo the CRC polynomial, in the reflected bit order where x^0 is the top bit.
+   constexpr std::uint32_t multiply_mod(std::uint32_t a, std::uint32_t b, std::uint32_t polynomial) {
+      std::uint32_t product = 0;
+
+      for (std::uint32_t m=static_cast<std::uint32_t>(1) << 31; m != 0; m >>= 1)
+      {
+         if (a & m)
+            product ^= b;
+
+         b = (b & 1) ? (b >> 1) ^ polynomial : b >> 1;
+      }
+
+      return product;
+   }
+
+   const std::size_t POWER_TABLE_SIZE = 3 + 64;
+
+   struct PowerTable
+   {
+      std::uint32_t power[POWER_TABLE_SIZE];
+   };
+
+   /// power[k] is x^(2^k) modulo the polynomial. lengths are in bytes, so the lookups start at k=3.
+   constexpr PowerTable make_power_table(std::uint32_t polynomial) {
+      PowerTable result {};
+      std::uint32_t p = static_cast<std::uint32_t>(1) << 30;
+
+      for (std::size_t k=0; k<POWER_TABLE_SIZE; ++k)
+      {
+         result.power[k] = p;
+         p = multiply_mod(p, p, polynomial);
+      }
+
+      return result;
+   }
+
+   constexpr PowerTable CRC32_POWERS = make_power_table(CRC32_POLYNOMIAL);
+   constexpr PowerTable CRC32C_POWERS = make_power_table(CRC32C_POLYNOMIAL);
+
+   std::uint32_t crc_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t size_b, const PowerTable &powers, std::uint32_t polynomial) {
+      // appending size_b bytes multiplies crc_a by x^(8*size_b); the pre- and post-conditioning cancel out.
+      std::uint32_t shift = static_cast<std::uint32_t>(1) << 31;
+
+      for (std::size_t k=3; size_b != 0; size_b >>= 1, ++k)
+         if (size_b & 1)
+            shift = multiply_mod(powers.power[k], shift, polynomial);
+
+      return multiply_mod(shift, crc_a, polynomial) ^ crc_b;
+   }
+
+   inline std::uint32_t load32(const std::uint8_t *ptr) {
+      return static_cast<std::uint32_t>(ptr[0])
+         | (static_cast<std::uint32_t>(ptr[1]) << 8)
+         | (static_cast<std::uint32_t>(ptr[2]) << 16)
+         | (static_cast<std::uint32_t>(ptr[3]) << 24);
+   }
+
+   inline std::uint64_t load64(const std::uint8_t *ptr) {
+      return static_cast<std::uint64_t>(load32(ptr)) | (static_cast<std::uint64_t>(load32(ptr+4)) << 32);
+   }
+
+   std::uint32_t crc_slice8(const SliceTables &tables, std::uint32_t crc, const std::uint8_t *ptr, std::size_t size) {
+      auto &t = tables.table;
+
+      for (; size >= 8; ptr += 8, size -= 8)
+      {
+         auto low = load32(ptr) ^ crc;
+         auto high = load32(ptr+4);
+
+         crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+             ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+      }
+
+      for (; size > 0; ++ptr, --size)
+         crc = t[0][(crc ^ *ptr) & 0xFF] ^ (crc >> 8);
+
+      return crc;
+   }
+
+   using CrcFunction = std::uint32_t (*)(std::uint32_t crc, const std::uint8_t *ptr, std::size_t size);
+
+   std::uint32_t crc32_generic(std::uint32_t crc, const std::uint8_t *ptr, std::size_t size) {
+      return crc_slice8(CRC32_SLICES, crc, ptr, size);
+   }
+
+   std::uint32_t crc32c_generic(std::uint32_t crc, const std::uint8_t *ptr, std::size_t size) {
+      return crc_slice8(CRC32C_SLICES, crc, ptr, size);
+   }
+
+#if defined(INFLATE_X86)
+   INFLATE_TARGET("sse4.2")
+   std::uint32_t crc32c_sse42(std::uint32_t crc, const std::uint8_t *ptr, std::size_t size) {
+#if defined(__x86_64__) || defined(_M_X64)
+      std::uint64_t crc64 = crc;
+
+      for (; size >= 8; ptr += 8, size -= 8)
+         crc64 = _mm_crc32_u64(crc64, load64(ptr));
+
+      crc = static_cast<std::uint32_t>(crc64);
+#else
+      for (; size >= 4; ptr += 4, size -= 4)
+         crc = _mm_crc32_u32(crc, load32(ptr));
+#endif
+
+      for (; size > 0; ++ptr, --size)
+         crc = _mm_crc32_u8(crc, *ptr);
+
+      return crc;
+   }
+
+   const std::size_t PCLMUL_MINIMUM = 64;
+
+   inline __m128i load128(const std::uint8_t *ptr) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+   }
+
+   /// multiply both halves of `value` by the folding constants and add the next block.
+   INFLATE_TARGET("pclmul,sse4.1")
+   inline __m128i fold128(__m128i value, __m128i constants, __m128i next) {
+      auto low = _mm_clmulepi64_si128(value, constants, 0x00);
+      auto high = _mm_clmulepi64_si128(value, constants, 0x11);
+
+      return _mm_xor_si128(_mm_xor_si128(high, low), next);
+   }
+
+   /// fold four 128-bit lanes across the buffer with carry-less multiplies, then reduce them to 32 bits with a
+   /// Barrett reduction. the constants are powers of x modulo the CRC32 polynomial, in reflected order.
+   INFLATE_TARGET("pclmul,sse4.1")
+   std::uint32_t crc32_pclmul(std::uint32_t crc, const std::uint8_t *ptr, std::size_t size) {
+      if (size < PCLMUL_MINIMUM)
+         return crc_slice8(CRC32_SLICES, crc, ptr, size);
+
+      auto tail = size % 16;
+      size -= tail;
+
+      const auto k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+      const auto k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+      const auto k5k0 = _mm_set_epi64x(0, 0x0163CD6124);
+      const auto poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+      const auto low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+      auto x1 = _mm_xor_si128(load128(ptr), _mm_cvtsi32_si128(static_cast<int>(crc)));
+      auto x2 = load128(ptr+0x10);
+      auto x3 = load128(ptr+0x20);
+      auto x4 = load128(ptr+0x30);
+
+      ptr += 64;
+      size -= 64;
+
+      for (; size >= 64; ptr += 64, size -= 64)
+      {
+         x1 = fold128(x1, k1k2, load128(ptr));
+         x2 = fold128(x2, k1k2, load128(ptr+0x10));
+         x3 = fold128(x3, k1k2, load128(ptr+0x20));
+         x4 = fold128(x4, k1k2, load128(ptr+0x30));
+      }
+
+      x1 = fold128(x1, k3k4, x2);
+      x1 = fold128(x1, k3k4, x3);
+      x1 = fold128(x1, k3k4, x4);
+
+      for (; size >= 16; ptr += 16, size -= 16)
+         x1 = fold128(x1, k3k4, load128(ptr));
+
+      // 128 bits down to 64.
+      auto x2_64 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+      x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2_64);
+
+      auto shifted = _mm_srli_si128(x1, 4);
+      x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), k5k0, 0x00), shifted);
+
+      // Barrett reduction to 32 bits.
+      auto quotient = _mm_clmulepi64_si128(_mm_and_si128(x1, low32), poly, 0x10);
+      quotient = _mm_clmulepi64_si128(_mm_and_si128(quotient, low32), poly, 0x00);
+      x1 = _mm_xor_si128(x1, quotient);
+
+      crc = static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+
+      return crc_slice8(CRC32_SLICES, crc, ptr, tail);
+   }
+#endif
+
+   CpuDispatch<CrcFunction> crc32_dispatch([]() -> CrcFunction {
+#if defined(INFLATE_X86)
+      if (cpu_enabled(CpuFeature::CPU_FEATURE_PCLMUL) && cpu_enabled(CpuFeature::CPU_FEATURE_SSE42))
+         return crc32_pclmul;
+#endif
+      return crc32_generic;
+   });
+
+   CpuDispatch<CrcFunction> crc32c_dispatch([]() -> CrcFunction {
+#if defined(INFLATE_X86)
+      if (cpu_enabled(CpuFeature::CPU_FEATURE_SSE42))
+         return crc32c_sse42;
+#endif
+      return crc32c_generic;
+   });
+
+   const std::uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+   const std::uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+   const std::uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+   const std::uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+   const std::uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+   inline std::uint64_t rotl64(std::uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+
+   inline std::uint64_t xxh64_round(std::uint64_t acc, std::uint64_t input) {
+      acc += input * XXH_PRIME64_2;
+      acc = rotl64(acc, 31);
+      return acc * XXH_PRIME64_1;
+   }
+
+   inline std::uint64_t xxh64_merge(std::uint64_t acc, std::uint64_t value) {
+      acc ^= xxh64_round(0, value);
+      return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+   }
+}
+
+std::uint32_t inflate::crc32(const void *ptr, std::size_t size, std::uint32_t init_crc) {
+   return crc32_dispatch(init_crc ^ 0xFFFFFFFF, reinterpret_cast<const std::uint8_t *>(ptr), size) ^ 0xFFFFFFFF;
+}
+
+std::uint32_t inflate::crc32(const std::vector<std::uint8_t> &vec, std::uint32_t init_crc) {
+   return inflate::crc32(vec.data(), vec.size(), init_crc);
+}
+
+std::uint32_t inflate::crc32_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t size_b) {
+   return crc_combine(crc_a, crc_b, size_b, CRC32_POWERS, CRC32_POLYNOMIAL);
+}
+
+std::uint32_t inflate::crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t size_b) {
+   return crc_combine(crc_a, crc_b, size_b, CRC32C_POWERS, CRC32C_POLYNOMIAL);
+}
+
+std::uint32_t inflate::crc32_parallel(const void *ptr, std::size_t size, std::size_t threads, std::uint32_t init_crc) {
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   if (threads == 0)
+      threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+   threads = std::min(threads, size / CRC_THREAD_MINIMUM);
+
+   if (threads <= 1)
+      return inflate::crc32(ptr, size, init_crc);
+
+   std::vector<std::uint32_t> partials(threads);
+   std::vector<std::thread> workers;
+   auto chunk = size / threads;
+
+   // the first chunk continues from init_crc; the others start fresh and are folded in afterwards.
+   for (std::size_t t=0; t<threads; ++t)
+   {
+      auto offset = t * chunk;
+      auto length = (t == threads-1) ? size - offset : chunk;
+
+      workers.emplace_back([&partials, u8_ptr, offset, length, t, init_crc]() {
+         partials[t] = inflate::crc32(u8_ptr+offset, length, (t == 0) ? init_crc : 0);
+      });
+   }
+
+   for (auto &worker : workers)
+      worker.join();
+
+   auto result = partials[0];
+
+   for (std::size_t t=1; t<threads; ++t)
+      result = inflate::crc32_combine(result, partials[t], (t == threads-1) ? size - t * chunk : chunk);
+
+   return result;
+}
+
+std::uint32_t inflate::crc32_parallel(const std::vector<std::uint8_t> &vec, std::size_t threads, std::uint32_t init_crc) {
+   return inflate::crc32_parallel(vec.data(), vec.size(), threads, init_crc);
+}
+
+std::uint32_t inflate::crc32c(const void *ptr, std::size_t size, std::uint32_t init_crc) {
+   return crc32c_dispatch(init_crc ^ 0xFFFFFFFF, reinterpret_cast<const std::uint8_t *>(ptr), size) ^ 0xFFFFFFFF;
+}
+
+std::uint32_t inflate::crc32c(const std::vector<std::uint8_t> &vec, std::uint32_t init_crc) {
+   return inflate::crc32c(vec.data(), vec.size(), init_crc);
+}
+
+std::uint64_t inflate::xxh64(const void *ptr, std::size_t size, std::uint64_t seed) {
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+   auto end = u8_ptr + size;
+   std::uint64_t hash;
+
+   if (size >= 32)
+   {
+      std::uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+      std::uint64_t v2 = seed + XXH_PRIME64_2;
+      std::uint64_t v3 = seed;
+      std::uint64_t v4 = seed - XXH_PRIME64_1;
+
+      for (; end - u8_ptr >= 32; u8_ptr += 32)
+      {
+         v1 = xxh64_round(v1, load64(u8_ptr));
+         v2 = xxh64_round(v2, load64(u8_ptr+8));
+         v3 = xxh64_round(v3, load64(u8_ptr+16));
+         v4 = xxh64_round(v4, load64(u8_ptr+24));
+      }
+
+      hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+      hash = xxh64_merge(hash, v1);
+      hash = xxh64_merge(hash, v2);
+      hash = xxh64_merge(hash, v3);
+      hash = xxh64_merge(hash, v4);
+   }
+   else
+      hash = seed + XXH_PRIME64_5;
+
+   hash += static_cast<std::uint64_t>(size);
+
+   for (; end - u8_ptr >= 8; u8_ptr += 8)
+      hash = rotl64(hash ^ xxh64_round(0, load64(u8_ptr)), 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+
+   if (end - u8_ptr >= 4)
+   {
+      hash = rotl64(hash ^ (static_cast<std::uint64_t>(load32(u8_ptr)) * XXH_PRIME64_1), 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+      u8_ptr += 4;
+   }
+
+   for (; u8_ptr < end; ++u8_ptr)
+      hash = rotl64(hash ^ (*u8_ptr * XXH_PRIME64_5), 11) * XXH_PRIME64_1;
+
+   hash ^= hash >> 33;
+   hash *= XXH_PRIME64_2;
+   hash ^= hash >> 29;
+   hash *= XXH_PRIME64_3;
+   hash ^= hash >> 32;
+
+   return hash;
+}
+
+std::uint64_t inflate::xxh64(const std::vector<std::uint8_t> &vec, std::uint64_t seed) {
+   return inflate::xxh64(vec.data(), vec.size(), seed);
+}
+
+std::uint64_t inflate::checksum(ChecksumType type, const void *ptr, std::size_t size) noexcept {
+   switch (type)
+   {
+   case ChecksumType::CHECKSUM_CRC32:
+      return inflate::crc32(ptr, size);
+
+   case ChecksumType::CHECKSUM_CRC32C:
+      return inflate::crc32c(ptr, size);
+
+   case ChecksumType::CHECKSUM_XXH64:
+      return inflate::xxh64(ptr, size);
+
+   default:
+      return 0;
+   }
+}
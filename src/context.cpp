@@ -0,0 +1,57 @@
+#include <inflate.hpp>
+
+#include <chrono>
+#include <random>
+
+using namespace inflate;
+
+inflate::InflateContext::InflateContext(std::optional<std::uint64_t> seed) {
+   if (seed.has_value())
+   {
+      this->_seed_state = *seed;
+      return;
+   }
+
+   // random_device may be deterministic on some platforms, so mix in the clock and this context's address
+   // to keep contexts created side by side apart. It may also throw when no entropy source is available, in
+   // which case those two are all there is: `thread_context()` is reached from the noexcept API.
+   std::uint64_t entropy = 0;
+
+   try
+   {
+      std::random_device device;
+      entropy = (static_cast<std::uint64_t>(device()) << 32) | device();
+   }
+   catch (std::exception &) {}
+
+   auto now = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+   this->_seed_state = entropy ^ now ^ reinterpret_cast<std::uintptr_t>(this);
+}
+
+std::uint32_t inflate::InflateContext::next_seed() {
+   std::uint32_t seed = 0;
+
+   // splitmix64: a full-period generator whose outputs are well mixed even for adjacent states. 0 is skipped,
+   // since it would leave the LFSR stuck at the RNG_FULL levels.
+   while (seed == 0)
+   {
+      auto z = (this->_seed_state += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+      seed = static_cast<std::uint32_t>((z ^ (z >> 31)) >> 32);
+   }
+
+   return seed;
+}
+
+void inflate::InflateContext::release() {
+   ByteVec().swap(this->_output);
+   ByteVec().swap(this->_scratch);
+}
+
+InflateContext &inflate::thread_context() {
+   thread_local InflateContext context;
+   return context;
+}
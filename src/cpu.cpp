@@ -0,0 +1,129 @@
+#include <inflate.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(INFLATE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+using namespace inflate;
+
+namespace
+{
+   const std::uint32_t TIER_FEATURES[] = {
+      0,
+      CpuFeature::CPU_FEATURE_SSE42 | CpuFeature::CPU_FEATURE_PCLMUL,
+      CpuFeature::CPU_FEATURE_SSE42 | CpuFeature::CPU_FEATURE_PCLMUL | CpuFeature::CPU_FEATURE_AVX2 | CpuFeature::CPU_FEATURE_BMI2,
+      CpuFeature::CPU_FEATURE_SSE42 | CpuFeature::CPU_FEATURE_PCLMUL | CpuFeature::CPU_FEATURE_AVX2 | CpuFeature::CPU_FEATURE_BMI2
+         | CpuFeature::CPU_FEATURE_AVX512,
+   };
+
+   const int NO_OVERRIDE = -1;
+
+   std::atomic<int> tier_override(NO_OVERRIDE);
+   std::atomic<std::uint32_t> generation(1);
+
+   CpuFeatures detect_features() noexcept {
+      std::uint32_t flags = 0;
+
+#if defined(INFLATE_X86) && defined(__GNUC__)
+      __builtin_cpu_init();
+
+      if (__builtin_cpu_supports("sse4.2")) { flags |= CpuFeature::CPU_FEATURE_SSE42; }
+      if (__builtin_cpu_supports("pclmul")) { flags |= CpuFeature::CPU_FEATURE_PCLMUL; }
+      if (__builtin_cpu_supports("bmi2")) { flags |= CpuFeature::CPU_FEATURE_BMI2; }
+      if (__builtin_cpu_supports("avx2")) { flags |= CpuFeature::CPU_FEATURE_AVX2; }
+      if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) { flags |= CpuFeature::CPU_FEATURE_AVX512; }
+#elif defined(INFLATE_X86) && defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      auto max_leaf = info[0];
+
+      __cpuid(info, 1);
+      bool osxsave = ((info[2] >> 27) & 1) != 0;
+
+      if ((info[2] >> 20) & 1) { flags |= CpuFeature::CPU_FEATURE_SSE42; }
+      if ((info[2] >> 1) & 1) { flags |= CpuFeature::CPU_FEATURE_PCLMUL; }
+
+      // the wide registers are only usable if the OS saves them on a context switch.
+      auto xcr0 = (osxsave) ? _xgetbv(0) : 0;
+      bool avx_state = (xcr0 & 0x6) == 0x6;
+      bool avx512_state = (xcr0 & 0xE6) == 0xE6;
+
+      if (max_leaf >= 7)
+      {
+         __cpuidex(info, 7, 0);
+
+         if ((info[1] >> 8) & 1) { flags |= CpuFeature::CPU_FEATURE_BMI2; }
+         if (avx_state && ((info[1] >> 5) & 1)) { flags |= CpuFeature::CPU_FEATURE_AVX2; }
+         if (avx512_state && ((info[1] >> 16) & 1) && ((info[1] >> 30) & 1)) { flags |= CpuFeature::CPU_FEATURE_AVX512; }
+      }
+#endif
+
+      return CpuFeatures{flags};
+   }
+
+   std::optional<CpuTier> environment_tier() noexcept {
+      auto value = std::getenv("INFLATE_CPU_TIER");
+
+      if (value == nullptr)
+         return std::nullopt;
+
+      for (int tier=CpuTier::CPU_TIER_GENERIC; tier<=CpuTier::CPU_TIER_AVX512; ++tier)
+         if (std::strcmp(value, cpu_tier_name(static_cast<CpuTier>(tier))) == 0)
+            return static_cast<CpuTier>(tier);
+
+      return std::nullopt;
+   }
+
+   CpuTier default_tier() noexcept {
+      static const CpuTier tier = environment_tier().value_or(CpuTier::CPU_TIER_AVX512);
+      return tier;
+   }
+}
+
+CpuTier inflate::CpuFeatures::tier() const noexcept {
+   for (int tier=CpuTier::CPU_TIER_AVX512; tier>CpuTier::CPU_TIER_GENERIC; --tier)
+      if ((this->flags & TIER_FEATURES[tier]) == TIER_FEATURES[tier])
+         return static_cast<CpuTier>(tier);
+
+   return CpuTier::CPU_TIER_GENERIC;
+}
+
+const CpuFeatures &inflate::cpu_features() noexcept {
+   static const CpuFeatures features = detect_features();
+   return features;
+}
+
+CpuTier inflate::cpu_tier() noexcept {
+   auto override = tier_override.load(std::memory_order_acquire);
+   auto tier = (override == NO_OVERRIDE) ? default_tier() : static_cast<CpuTier>(override);
+
+   return std::min(tier, cpu_features().tier());
+}
+
+void inflate::set_cpu_tier(std::optional<CpuTier> tier) noexcept {
+   tier_override.store((tier.has_value()) ? static_cast<int>(*tier) : NO_OVERRIDE, std::memory_order_release);
+   generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool inflate::cpu_enabled(CpuFeature feature) noexcept {
+   return cpu_features().has(feature) && (TIER_FEATURES[cpu_tier()] & feature) != 0;
+}
+
+const char *inflate::cpu_tier_name(CpuTier tier) noexcept {
+   switch (tier)
+   {
+   case CpuTier::CPU_TIER_GENERIC: return "generic";
+   case CpuTier::CPU_TIER_SSE42: return "sse42";
+   case CpuTier::CPU_TIER_AVX2: return "avx2";
+   case CpuTier::CPU_TIER_AVX512: return "avx512";
+   default: return "unknown";
+   }
+}
+
+std::uint32_t inflate::cpu_dispatch_generation() noexcept {
+   return generation.load(std::memory_order_acquire);
+}
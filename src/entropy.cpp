@@ -0,0 +1,223 @@
+#include <inflate.hpp>
+
+#include <cmath>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INFLATE_HISTOGRAM_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace inflate;
+
+namespace
+{
+   const std::size_t HISTOGRAM_TABLES = 4;
+   const std::size_t HISTOGRAM_BLOCK = 0x40000000;
+   const std::size_t HISTOGRAM_THREAD_MINIMUM = 0x100000;
+   const std::size_t SLIDING_RESYNC = 0x10000;
+
+   void count_block(const std::uint8_t *ptr, std::size_t size, Histogram &result) {
+      // every byte of a word lands in a different table than its neighbor, so repeated bytes
+      // don't serialize on the same counter. each table receives at most a quarter of the block,
+      // which keeps the counters within 32 bits.
+      std::uint32_t tables[HISTOGRAM_TABLES][256];
+      std::memset(tables, 0, sizeof(tables));
+
+      std::size_t i=0;
+
+      for (; i+8<=size; i+=8)
+      {
+         std::uint64_t word;
+         std::memcpy(&word, ptr+i, sizeof(word));
+
+         ++tables[0][word & 0xFF];
+         ++tables[1][(word >> 8) & 0xFF];
+         ++tables[2][(word >> 16) & 0xFF];
+         ++tables[3][(word >> 24) & 0xFF];
+         ++tables[0][(word >> 32) & 0xFF];
+         ++tables[1][(word >> 40) & 0xFF];
+         ++tables[2][(word >> 48) & 0xFF];
+         ++tables[3][(word >> 56) & 0xFF];
+      }
+
+      for (; i<size; ++i)
+         ++tables[i % HISTOGRAM_TABLES][ptr[i]];
+
+#if defined(INFLATE_HISTOGRAM_SSE2)
+      auto zero = _mm_setzero_si128();
+
+      for (std::size_t j=0; j<256; j+=4)
+      {
+         auto sum = _mm_add_epi32(_mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables[0][j])),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables[1][j]))),
+                                  _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables[2][j])),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&tables[3][j]))));
+         auto low = reinterpret_cast<__m128i *>(&result[j]);
+         auto high = reinterpret_cast<__m128i *>(&result[j+2]);
+
+         _mm_storeu_si128(low, _mm_add_epi64(_mm_loadu_si128(low), _mm_unpacklo_epi32(sum, zero)));
+         _mm_storeu_si128(high, _mm_add_epi64(_mm_loadu_si128(high), _mm_unpackhi_epi32(sum, zero)));
+      }
+#else
+      for (std::size_t j=0; j<256; ++j)
+         result[j] += static_cast<std::uint64_t>(tables[0][j]) + tables[1][j] + tables[2][j] + tables[3][j];
+#endif
+   }
+
+   Histogram count_range(const std::uint8_t *ptr, std::size_t size) {
+      Histogram result;
+      result.fill(0);
+
+      for (std::size_t offset=0; offset<size; offset+=HISTOGRAM_BLOCK)
+         count_block(ptr+offset, std::min(HISTOGRAM_BLOCK, size-offset), result);
+
+      return result;
+   }
+}
+
+Histogram inflate::histogram(const void *ptr, std::size_t size, std::size_t threads) {
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   if (threads == 0)
+      threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+   threads = std::min(threads, size / HISTOGRAM_THREAD_MINIMUM);
+
+   if (threads <= 1)
+      return count_range(u8_ptr, size);
+
+   std::vector<Histogram> partials(threads);
+   std::vector<std::thread> workers;
+   auto chunk = size / threads;
+
+   for (std::size_t t=0; t<threads; ++t)
+   {
+      auto offset = t * chunk;
+      auto length = (t == threads-1) ? size - offset : chunk;
+
+      workers.emplace_back([&partials, u8_ptr, offset, length, t]() {
+         partials[t] = count_range(u8_ptr+offset, length);
+      });
+   }
+
+   for (auto &worker : workers)
+      worker.join();
+
+   Histogram result = partials[0];
+
+   for (std::size_t t=1; t<threads; ++t)
+      for (std::size_t j=0; j<256; ++j)
+         result[j] += partials[t][j];
+
+   return result;
+}
+
+Histogram inflate::histogram(const std::vector<std::uint8_t> &vec, std::size_t threads) {
+   return inflate::histogram(vec.data(), vec.size(), threads);
+}
+
+double inflate::entropy(const Histogram &histogram) {
+   std::uint64_t total = 0;
+
+   for (auto count : histogram)
+      total += count;
+
+   if (total == 0)
+      return 0.0;
+
+   double result = 0.0;
+
+   for (auto count : histogram)
+   {
+      if (count == 0)
+         continue;
+
+      auto p_x = static_cast<double>(count) / total;
+      result -= p_x * std::log2(p_x);
+   }
+
+   return std::abs(result);
+}
+
+double inflate::entropy(const void *ptr, std::size_t size, std::size_t threads) {
+   return inflate::entropy(inflate::histogram(ptr, size, threads));
+}
+
+double inflate::entropy(const std::vector<std::uint8_t> &vec, std::size_t threads) {
+   return inflate::entropy(vec.data(), vec.size(), threads);
+}
+
+std::vector<double> inflate::sliding_entropy(const void *ptr, std::size_t size, std::size_t window, std::size_t step) {
+   std::vector<double> result;
+
+   if (window == 0 || step == 0)
+      throw exception::BadWindow(window, step);
+
+   if (size < window)
+      return result;
+
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   // the entropy of a window of size W is log2(W) - sum(c*log2(c))/W, so only the sum has to be
+   // maintained as bytes enter and leave the window, with c*log2(c) looked up from a table.
+   std::vector<double> weights(window+1);
+   weights[0] = 0.0;
+
+   for (std::size_t c=1; c<=window; ++c)
+      weights[c] = c * std::log2(static_cast<double>(c));
+
+   std::uint64_t counts[256] = { 0 };
+   double weight_sum = 0.0;
+   auto log_window = std::log2(static_cast<double>(window));
+
+   for (std::size_t i=0; i<window; ++i)
+      ++counts[u8_ptr[i]];
+
+   for (std::size_t j=0; j<256; ++j)
+      weight_sum += weights[counts[j]];
+
+   result.reserve((size - window) / step + 1);
+   std::size_t slides = 0;
+
+   for (std::size_t offset=0; ; offset+=step)
+   {
+      result.push_back(std::max(0.0, log_window - weight_sum / window));
+
+      if (size - window - offset < step)
+         break;
+
+      for (std::size_t i=0; i<step; ++i)
+      {
+         auto leaving = u8_ptr[offset+i];
+         auto entering = u8_ptr[offset+window+i];
+
+         if (leaving == entering)
+            continue;
+
+         weight_sum += weights[counts[leaving]-1] - weights[counts[leaving]];
+         --counts[leaving];
+         weight_sum += weights[counts[entering]+1] - weights[counts[entering]];
+         ++counts[entering];
+      }
+
+      // resynchronize the running sum periodically so rounding error can't accumulate over long scans.
+      slides += step;
+
+      if (slides >= SLIDING_RESYNC)
+      {
+         weight_sum = 0.0;
+
+         for (std::size_t j=0; j<256; ++j)
+            weight_sum += weights[counts[j]];
+
+         slides = 0;
+      }
+   }
+
+   return result;
+}
+
+std::vector<double> inflate::sliding_entropy(const std::vector<std::uint8_t> &vec, std::size_t window, std::size_t step) {
+   return inflate::sliding_entropy(vec.data(), vec.size(), window, step);
+}
@@ -0,0 +1,336 @@
+#include "internal.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INFLATE_POSIX_FILES
+#endif
+
+using namespace inflate;
+using namespace inflate::internal;
+
+namespace
+{
+#if defined(INFLATE_POSIX_FILES)
+   /// @brief The input read per step, rounded down to whole units.
+   const std::uint64_t CHUNK_SIZE = 0x400000;
+   const std::uint64_t SPARSE_PAGE = 0x1000;
+
+   class File
+   {
+   public:
+      int fd;
+      std::string path;
+
+      File(const std::string &path, int flags) : fd(open(path.c_str(), flags, 0644)), path(path) {
+         if (this->fd < 0)
+            throw exception::OpenFailed(path);
+      }
+      File(const File &) = delete;
+      ~File() { close(this->fd); }
+
+      std::uint64_t size() const {
+         struct stat info;
+
+         if (fstat(this->fd, &info) != 0)
+            throw exception::IOFailed(this->path);
+
+         return static_cast<std::uint64_t>(info.st_size);
+      }
+
+      void read(std::uint8_t *ptr, std::uint64_t size, std::uint64_t offset) const {
+         while (size > 0)
+         {
+            auto count = pread(this->fd, ptr, size, static_cast<off_t>(offset));
+
+            if (count < 0 && errno == EINTR)
+               continue;
+
+            if (count <= 0)
+               throw exception::IOFailed(this->path);
+
+            ptr += count;
+            size -= count;
+            offset += count;
+         }
+      }
+
+      void write(const std::uint8_t *ptr, std::uint64_t size, std::uint64_t offset) const {
+         while (size > 0)
+         {
+            auto count = pwrite(this->fd, ptr, size, static_cast<off_t>(offset));
+
+            if (count < 0 && errno == EINTR)
+               continue;
+
+            if (count <= 0)
+               throw exception::IOFailed(this->path);
+
+            ptr += count;
+            size -= count;
+            offset += count;
+         }
+      }
+
+      /// @brief Write the nonzero pages of the buffer, as pages of the file, in as few writes as possible.
+      void write_sparse(const std::uint8_t *ptr, std::uint64_t size, std::uint64_t offset) const {
+         std::uint64_t position = 0;
+         std::uint64_t run = 0;
+         bool dense = false;
+
+         while (position < size)
+         {
+            auto next = std::min(size, (offset + position) / SPARSE_PAGE * SPARSE_PAGE + SPARSE_PAGE - offset);
+            auto zero = std::all_of(ptr+position, ptr+next, [](std::uint8_t byte) { return byte == 0; });
+
+            if (dense && zero)
+               this->write(ptr+run, position-run, offset+run);
+            else if (!dense && !zero)
+               run = position;
+
+            dense = !zero;
+            position = next;
+         }
+
+         if (dense)
+            this->write(ptr+run, size-run, offset+run);
+      }
+   };
+
+   std::vector<FileExtent> read_extents(const File &file, std::uint64_t size) {
+      std::vector<FileExtent> extents;
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+      std::uint64_t offset = 0;
+
+      while (offset < size)
+      {
+         auto data = lseek(file.fd, static_cast<off_t>(offset), SEEK_DATA);
+
+         if (data < 0)
+         {
+            // ENXIO means only holes remain; anything else means the filesystem can't tell.
+            if (errno == ENXIO)
+               return extents;
+
+            return std::vector<FileExtent>{FileExtent{0, size}};
+         }
+
+         auto hole = lseek(file.fd, data, SEEK_HOLE);
+         auto end = (hole < 0) ? size : std::min(static_cast<std::uint64_t>(hole), size);
+
+         extents.push_back(FileExtent{static_cast<std::uint64_t>(data), end - static_cast<std::uint64_t>(data)});
+         offset = end;
+      }
+#else
+      if (size != 0)
+         extents.push_back(FileExtent{0, size});
+#endif
+
+      return extents;
+   }
+
+   /// @brief Move the stream described by `header` from `input` to `output`, in either direction. Returns
+   /// the CRC of the deflated side, or 0 for XXH64, which the caller computes.
+   std::uint64_t transform_file(const File &input, const File &output, const InflateHeaderV2 &header, bool inflating) {
+      auto level = static_cast<InflateLevel>(header.level);
+      auto geometry = header_geometry(header);
+      auto family = level_family(level);
+      auto type = static_cast<ChecksumType>(header.checksum_type);
+      std::uint64_t modulus = geometry.modulus();
+      auto unit_bits = modulus * 8;
+      auto input_unit = (inflating) ? modulus : geometry.group_bits;
+      auto output_unit = (inflating) ? geometry.group_bits : modulus;
+      auto units = header.deflated / unit_bits + static_cast<std::uint64_t>(header.deflated % unit_bits != 0);
+      auto input_size = bytes_of((inflating) ? header.deflated : header.inflated);
+      auto extents = read_extents(input, input_size);
+      auto chunk_units = std::max<std::uint64_t>(CHUNK_SIZE / input_unit, 1);
+
+      if (ftruncate(output.fd, static_cast<off_t>(bytes_of((inflating) ? header.inflated : header.deflated))) != 0)
+         throw exception::IOFailed(output.path);
+
+      ByteVec input_buffer(chunk_units * input_unit);
+      ByteVec output_buffer(chunk_units * output_unit);
+      std::uint32_t sum = 0;
+      std::uint32_t zero_sum = 0;
+      std::uint64_t zero_size = 0;
+      std::size_t extent = 0;
+      RandomEngine rng(header);
+
+      for (std::uint64_t unit=0; unit<units; unit+=chunk_units)
+      {
+         auto count = std::min(chunk_units, units - unit);
+         auto bits = std::min(count * unit_bits, header.deflated - unit * unit_bits);
+         auto deflated_size = bytes_of(bits);
+         auto input_offset = unit * input_unit;
+         auto input_length = (inflating) ? deflated_size : bytes_of(inflated_bits(level, geometry, bits));
+         auto output_length = (inflating) ? bytes_of(inflated_bits(level, geometry, bits)) : deflated_size;
+
+         while (extent < extents.size() && extents[extent].offset + extents[extent].size <= input_offset)
+            ++extent;
+
+         auto hole = (extent == extents.size() || extents[extent].offset >= input_offset + input_length);
+
+         if (hole && is_seekable(family, rng.engine()))
+         {
+            // one step per group, the short tail group included.
+            if (family != InflateFamily::INFLATE_FAMILY_FIXED)
+               rng.jump(bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0));
+         }
+         else
+         {
+            if (hole)
+               std::memset(input_buffer.data(), 0, input_length);
+            else
+               input.read(input_buffer.data(), input_length, input_offset);
+
+            if (inflating)
+               inflate_kernel(level, geometry, input_buffer.data(), bits, output_buffer.data(), rng);
+            else
+               deflate_kernel(level, geometry, input_buffer.data(), bits, output_buffer.data(), rng);
+
+            output.write_sparse(output_buffer.data(), output_length, unit * output_unit);
+         }
+
+         if (type == ChecksumType::CHECKSUM_XXH64)
+            continue;
+
+         if (hole)
+         {
+            // every full chunk of a hole has the same CRC, so it's computed once and then only combined.
+            if (deflated_size != zero_size)
+            {
+               ByteVec zeros(deflated_size);
+               zero_sum = static_cast<std::uint32_t>(checksum(type, zeros.data(), zeros.size()));
+               zero_size = deflated_size;
+            }
+
+            sum = (type == ChecksumType::CHECKSUM_CRC32C)
+               ? crc32c_combine(sum, zero_sum, deflated_size)
+               : crc32_combine(sum, zero_sum, deflated_size);
+         }
+         else
+         {
+            auto deflated = (inflating) ? input_buffer.data() : output_buffer.data();
+
+            sum = (type == ChecksumType::CHECKSUM_CRC32C)
+               ? crc32c(deflated, deflated_size, sum)
+               : crc32(deflated, deflated_size, sum);
+         }
+      }
+
+      return sum;
+   }
+
+   std::uint64_t file_xxh64(const File &file, std::uint64_t size) {
+      if (size == 0)
+         return xxh64(nullptr, 0);
+
+      auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+
+      if (mapping == MAP_FAILED)
+         throw exception::IOFailed(file.path);
+
+      auto sum = xxh64(mapping, size);
+      munmap(mapping, size);
+
+      return sum;
+   }
+#else
+   ByteVec read_file(const std::string &path) {
+      std::ifstream file(path, std::ios::binary);
+
+      if (!file.is_open())
+         throw exception::OpenFailed(path);
+
+      return ByteVec(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   }
+
+   void write_file(const std::string &path, const ByteVec &data) {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+      if (!file.is_open())
+         throw exception::OpenFailed(path);
+
+      if (!file.write(reinterpret_cast<const char *>(data.data()), data.size()))
+         throw exception::IOFailed(path);
+   }
+#endif
+}
+
+std::vector<FileExtent> inflate::data_extents(const std::string &path) {
+#if defined(INFLATE_POSIX_FILES)
+   File file(path, O_RDONLY);
+   return read_extents(file, file.size());
+#else
+   std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+   if (!file.is_open())
+      throw exception::OpenFailed(path);
+
+   auto size = static_cast<std::uint64_t>(file.tellg());
+
+   return (size == 0) ? std::vector<FileExtent>() : std::vector<FileExtent>{FileExtent{0, size}};
+#endif
+}
+
+InflateHeaderV2 inflate::inflate_file(const std::string &input, const std::string &output, const InflateOptions &options) {
+   INFLATE_STATS_SCOPE("inflate_file");
+
+#if defined(INFLATE_POSIX_FILES)
+   throw_inflate_status(check_inflate_arguments(nullptr, 0, options), options);
+
+   File input_file(input, O_RDONLY);
+   auto header = make_header(options, input_file.size(), (options.seed.has_value()) ? *options.seed : thread_context().next_seed());
+   File output_file(output, O_RDWR | O_CREAT | O_TRUNC);
+
+   INFLATE_STATS_ADD(bytes_in, bytes_of(header.deflated));
+   INFLATE_STATS_ADD(bytes_out, bytes_of(header.inflated));
+
+   header.checksum = transform_file(input_file, output_file, header, true);
+
+   if (options.checksum == ChecksumType::CHECKSUM_XXH64)
+      header.checksum = file_xxh64(input_file, bytes_of(header.deflated));
+
+   return header;
+#else
+   auto result = inflate_memory(read_file(input), options);
+   write_file(output, result.first);
+
+   return result.second;
+#endif
+}
+
+void inflate::deflate_file(const std::string &input, const std::string &output, const InflateHeaderV2 &header, bool validate) {
+   INFLATE_STATS_SCOPE("deflate_file");
+
+#if defined(INFLATE_POSIX_FILES)
+   File input_file(input, O_RDONLY);
+   check_header(header, input_file.size());
+
+   File output_file(output, O_RDWR | O_CREAT | O_TRUNC);
+
+   INFLATE_STATS_ADD(bytes_in, bytes_of(header.inflated));
+   INFLATE_STATS_ADD(bytes_out, bytes_of(header.deflated));
+
+   std::uint64_t sum = transform_file(input_file, output_file, header, false);
+
+   if (!validate)
+      return;
+
+   if (header.checksum_type == ChecksumType::CHECKSUM_XXH64)
+      sum = file_xxh64(output_file, bytes_of(header.deflated));
+
+   if (sum != header.checksum)
+      throw exception::BadCRC(sum, header.checksum);
+#else
+   auto data = read_file(input);
+   write_file(output, deflate_memory(data, header, validate));
+#endif
+}
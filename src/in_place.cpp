@@ -0,0 +1,148 @@
+#include "internal.hpp"
+
+#include <algorithm>
+
+using namespace inflate;
+using namespace inflate::internal;
+
+namespace
+{
+   /// @brief The units moved per step. Only the input of a step is copied aside, which keeps the scratch
+   /// space to a few tens of kilobytes.
+   const std::uint64_t CHUNK_UNITS = 0x2000;
+
+   /// @brief The register at the start of every chunk of an RNG_FULL stream using the LFSR. The masks never
+   /// depend on the data, so the kernel is simply run over zeros.
+   std::vector<std::uint32_t> full_states(InflateLevel level, InflateGeometry geometry, std::uint32_t seed, std::uint64_t deflated_bits) {
+      std::uint64_t modulus = geometry.modulus();
+      auto chunk_bits = CHUNK_UNITS * modulus * 8;
+      ByteVec zeros(CHUNK_UNITS * modulus);
+      ByteVec scratch(CHUNK_UNITS * geometry.group_bits);
+      std::vector<std::uint32_t> states;
+      ShiftRegister lfsr(seed);
+
+      for (std::uint64_t bit=0; bit<deflated_bits; bit+=chunk_bits)
+      {
+         states.push_back(lfsr.state());
+         inflate_kernel(level, geometry, zeros.data(), std::min(chunk_bits, deflated_bits - bit), scratch.data(), lfsr);
+      }
+
+      return states;
+   }
+}
+
+InflateHeaderV2 inflate::inflate_in_place(std::uint8_t *buffer, std::uint64_t buffer_size, std::uint64_t input_size, const InflateOptions &options) {
+   INFLATE_STATS_SCOPE("inflate_in_place");
+   INFLATE_STATS_ADD(bytes_in, input_size);
+
+   throw_inflate_status(check_inflate_arguments(buffer, buffer_size, options), options);
+
+   auto output_size = inflated_size(options, input_size);
+
+   if (buffer_size < output_size)
+      throw exception::InsufficientSize(buffer_size, output_size);
+
+   INFLATE_STATS_ADD(bytes_out, output_size);
+
+   auto header = make_header(options, input_size, (options.seed.has_value()) ? *options.seed : thread_context().next_seed());
+   auto geometry = options_geometry(options);
+   auto level = options.level;
+
+   {
+      INFLATE_STATS_TIMER(checksum_ns);
+      header.checksum = checksum(options.checksum, buffer, input_size);
+   }
+
+   INFLATE_STATS_TIMER(transform_ns);
+
+   std::uint64_t modulus = geometry.modulus();
+   auto units = input_size / modulus + static_cast<std::uint64_t>(input_size % modulus != 0);
+   auto chunks = units / CHUNK_UNITS + static_cast<std::uint64_t>(units % CHUNK_UNITS != 0);
+   auto family = level_family(level);
+   auto seekable = is_seekable(family, options.rng);
+   std::vector<std::uint32_t> states;
+   ByteVec scratch(std::min(units, CHUNK_UNITS) * modulus);
+
+   if (!seekable)
+      states = full_states(level, geometry, header.seed, header.deflated);
+
+   // the output of chunk `c` starts at `c * CHUNK_UNITS * group_bits`, at or past the end of every earlier
+   // chunk's input, so only the chunk's own input needs to be moved out of the way.
+   for (auto chunk=chunks; chunk-- > 0;)
+   {
+      auto first_unit = chunk * CHUNK_UNITS;
+      auto input_offset = first_unit * modulus;
+      auto size = std::min(CHUNK_UNITS * modulus, input_size - input_offset);
+      RandomEngine rng(header);
+
+      if (!seekable)
+         rng.restore(states[chunk]);
+      else if (family != InflateFamily::INFLATE_FAMILY_FIXED)
+         rng.jump(first_unit * 8);
+
+      std::memcpy(scratch.data(), buffer+input_offset, size);
+      inflate_kernel(level, geometry, scratch.data(), size*8, buffer+first_unit*geometry.group_bits, rng);
+   }
+
+   return header;
+}
+
+InflateHeaderV2 inflate::inflate_in_place(ByteVec &buffer, const InflateOptions &options) {
+   auto input_size = buffer.size();
+
+   buffer.resize(inflated_size(options, input_size));
+
+   try { return inflate_in_place(buffer.data(), buffer.size(), input_size, options); }
+   catch (std::exception &) { buffer.resize(input_size); throw; }
+}
+
+void inflate::deflate_in_place(std::uint8_t *buffer, std::uint64_t size, const InflateHeaderV2 &header, bool validate) {
+   INFLATE_STATS_SCOPE("deflate_in_place");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   check_header(header, size);
+
+   if (buffer == nullptr && size != 0)
+      throw exception::NullPointer();
+
+   auto level = static_cast<InflateLevel>(header.level);
+   auto geometry = header_geometry(header);
+   auto output_size = bytes_of(header.deflated);
+   std::uint64_t modulus = geometry.modulus();
+   auto chunk_bits = CHUNK_UNITS * modulus * 8;
+   auto chunk_inflated = CHUNK_UNITS * geometry.group_bits;
+   ByteVec scratch(std::min(size, chunk_inflated));
+   RandomEngine rng(header);
+
+   INFLATE_STATS_ADD(bytes_out, output_size);
+
+   {
+      INFLATE_STATS_TIMER(transform_ns);
+
+      // deflated data shrinks, so the output of chunk `c` ends before the input of chunk `c + 1` begins.
+      for (std::uint64_t chunk=0; chunk*chunk_bits<header.deflated; ++chunk)
+      {
+         auto bits = std::min(chunk_bits, header.deflated - chunk*chunk_bits);
+         auto inflated = chunk * chunk_inflated;
+         auto length = std::min(chunk_inflated, size - inflated);
+
+         std::memcpy(scratch.data(), buffer+inflated, length);
+         deflate_kernel(level, geometry, scratch.data(), bits, buffer+chunk*CHUNK_UNITS*modulus, rng);
+      }
+   }
+
+   if (!validate)
+      return;
+
+   INFLATE_STATS_TIMER(checksum_ns);
+
+   auto sum = checksum(static_cast<ChecksumType>(header.checksum_type), buffer, output_size);
+
+   if (sum != header.checksum)
+      throw exception::BadCRC(sum, header.checksum);
+}
+
+void inflate::deflate_in_place(ByteVec &buffer, const InflateHeaderV2 &header, bool validate) {
+   deflate_in_place(buffer.data(), buffer.size(), header, validate);
+   buffer.resize(bytes_of(header.deflated));
+}
@@ -1,300 +1,740 @@
-#include <inflate.hpp>
+#include "internal.hpp"
 
 using namespace inflate;
+using namespace inflate::internal;
 
-std::pair<ByteVec, InflateHeader> inflate::inflate_memory(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
-   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
-
-   BitVec padding_bits;
-   std::uint64_t modulus = 0;
-   std::uint64_t inflate_size;
+namespace
+{
+   const std::size_t MAGIC_SIZE = 4;
 
-   if (!seed.has_value())
+   InflateHeaderV2 inflate_into(const std::uint8_t *ptr,
+                                std::uint64_t size,
+                                const InflateOptions &options,
+                                std::uint32_t seed,
+                                std::uint8_t *output) noexcept
    {
-      std::srand(std::time(nullptr));
-      seed = static_cast<std::uint32_t>(std::rand());
+      auto header = make_header(options, size, seed);
+      auto rng = RandomEngine(header);
+      auto geometry = options_geometry(options);
+
+      {
+         INFLATE_STATS_TIMER(transform_ns);
+         inflate_kernel(options.level, geometry, ptr, header.deflated, output, rng);
+      }
+
+      {
+         INFLATE_STATS_TIMER(checksum_ns);
+         header.checksum = checksum(options.checksum, ptr, size);
+      }
+
+      return header;
    }
-   
-   if (level <= InflateLevel::INFLATE_7BIT)
-   {
-      modulus = 8 - level;
-      padding_bits = BitVec(8 - modulus, false);
-      inflate_size = (size * 8) + ((size * 8) / modulus) * padding_bits.size();
+
+   InflateStatus deflate_into(const std::uint8_t *ptr, const InflateHeaderV2 &header, bool validate, std::uint8_t *output, std::uint64_t &sum) noexcept {
+      auto rng = RandomEngine(header);
+
+      {
+         INFLATE_STATS_TIMER(transform_ns);
+         deflate_kernel(static_cast<InflateLevel>(header.level), header_geometry(header), ptr, header.deflated, output, rng);
+      }
+
+      if (validate)
+      {
+         INFLATE_STATS_TIMER(checksum_ns);
+         sum = checksum(static_cast<ChecksumType>(header.checksum_type), output, bytes_of(header.deflated));
+
+         if (sum != header.checksum)
+            return InflateStatus::STATUS_BAD_CRC;
+      }
+
+      return InflateStatus::STATUS_OK;
    }
-   else
-   {
-      if (level <= InflateLevel::INFLATE_RNG_PARTIAL_7BIT)
-         modulus = 8 - (level - InflateLevel::INFLATE_7BIT);
-      else
-         modulus = 8 - (level - InflateLevel::INFLATE_RNG_PARTIAL_7BIT);
 
-      padding_bits = BitVec(8 - modulus, false);
-      inflate_size = (size * 8) + ((size * 8) / modulus) * padding_bits.size();
+   InflateHeader legacy_header(const InflateHeaderV2 &header) noexcept {
+      InflateHeader result;
+
+      std::memset(&result, 0, sizeof(InflateHeader));
+      result.level = header.level;
+      result.inflated = header.inflated;
+      result.deflated = header.deflated;
+      result.checksum = static_cast<std::uint32_t>(header.checksum);
+      result.seed = header.seed;
 
-      if (inflate_size % 8 != 0)
-         inflate_size += 8 - inflate_size % 8;
+      return result;
    }
 
-   auto deflate_stream = BitstreamPtr(u8_ptr, size*8);
-   auto inflate_stream = BitstreamVec(inflate_size);
+   InflateHeaderV2 versioned_header(const InflateHeader &header) noexcept {
+      InflateHeaderV2 result;
 
-   if (level == InflateLevel::INFLATE_NOOP)
-   {
-      inflate_stream = BitstreamVec(deflate_stream.data(), deflate_stream.bit_size());
+      std::memset(&result, 0, sizeof(InflateHeaderV2));
+      result.version = header_version(RngEngine::RNG_LFSR);
+      result.header_size = sizeof(InflateHeaderV2);
+      result.level = header.level;
+      result.checksum_type = ChecksumType::CHECKSUM_CRC32;
+      result.inflated = header.inflated;
+      result.deflated = header.deflated;
+      result.checksum = header.checksum;
+      result.seed = header.seed;
+
+      return result;
    }
-   else if (level <= InflateLevel::INFLATE_7BIT)
-   {
-      std::uint64_t inflate_offset = 0;
-      
-      for (std::uint64_t i=0; i<deflate_stream.bit_size(); i+=modulus)
+
+   /// parse either an `NFL8` or an `NFLV` stream. legacy headers are upgraded, so everything past this point
+   /// only deals with versioned headers.
+   InflateStatus parse_disk(const void *ptr, std::uint64_t size, InflateHeaderV2 &header, std::uint64_t &payload_offset) noexcept {
+      if (ptr == nullptr)
+         return InflateStatus::STATUS_NULL_POINTER;
+
+      auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+      if (size >= MAGIC_SIZE && std::memcmp(u8_ptr, INFLATE_VERSIONED_MAGIC, MAGIC_SIZE) == 0)
       {
-         auto read_size = (deflate_stream.bit_size() - i > modulus) ? modulus : deflate_stream.bit_size() - i;
-
-         for (std::size_t j=0; j<read_size; ++j)
-            inflate_stream.set_bit(inflate_offset++, deflate_stream.get_bit(i+j));
-         
-         if (read_size == modulus)
-            for (std::size_t j=0; j<padding_bits.size(); ++j)
-               inflate_stream.set_bit(inflate_offset++, padding_bits[j]);
+         if (size < MAGIC_SIZE+sizeof(InflateHeaderV2))
+            return InflateStatus::STATUS_INSUFFICIENT_SIZE;
+
+         std::memcpy(&header, u8_ptr+MAGIC_SIZE, sizeof(InflateHeaderV2));
+
+         if (header.version < INFLATE_MIN_HEADER_VERSION || header.header_size < sizeof(InflateHeaderV2))
+            return InflateStatus::STATUS_BAD_HEADER;
+
+         if (size < MAGIC_SIZE+header.header_size)
+            return InflateStatus::STATUS_INSUFFICIENT_SIZE;
+
+         payload_offset = MAGIC_SIZE+header.header_size;
+
+         return InflateStatus::STATUS_OK;
       }
+
+      if (size < MAGIC_SIZE+sizeof(InflateHeader))
+         return InflateStatus::STATUS_INSUFFICIENT_SIZE;
+
+      if (std::memcmp(u8_ptr, INFLATE_MAGIC, MAGIC_SIZE) != 0)
+         return InflateStatus::STATUS_BAD_HEADER_MAGIC;
+
+      InflateHeader legacy;
+      std::memcpy(&legacy, u8_ptr+MAGIC_SIZE, sizeof(InflateHeader));
+
+      header = versioned_header(legacy);
+      payload_offset = MAGIC_SIZE+sizeof(InflateHeader);
+
+      return InflateStatus::STATUS_OK;
    }
-   else if (level <= InflateLevel::INFLATE_RNG_PARTIAL_7BIT)
-   {
-      auto lfsr = ShiftRegister(*seed);
-      std::uint64_t inflate_offset = 0;
-      
-      for (std::uint64_t i=0; i<deflate_stream.bit_size(); i+=modulus)
+
+   /// write the magic and header in front of a payload which was inflated in place behind them. a versioned
+   /// header is padded with zeroes up to `payload_offset`, and its `header_size` covers the padding.
+   void write_disk_header(std::uint8_t *output, InflateHeaderV2 header, std::uint64_t payload_offset, bool versioned) noexcept {
+      INFLATE_STATS_TIMER(assembly_ns);
+
+      if (versioned)
       {
-         auto read_size = (deflate_stream.bit_size() - i > modulus) ? modulus : deflate_stream.bit_size() - i;
-         auto inject_index = *lfsr % read_size;
-
-         for (std::size_t j=0; j<read_size; ++j)
-         {
-            if (j == inject_index)
-            {
-               inflate_stream.write_bits(inflate_offset, padding_bits);
-               inflate_offset += padding_bits.size();
-            }
-            
-            inflate_stream.set_bit(inflate_offset++, deflate_stream.get_bit(i+j));
-         }
+         header.header_size = static_cast<std::uint16_t>(payload_offset - MAGIC_SIZE);
+
+         std::memcpy(output, INFLATE_VERSIONED_MAGIC, MAGIC_SIZE);
+         std::memcpy(output+MAGIC_SIZE, &header, sizeof(InflateHeaderV2));
+         std::memset(output+MAGIC_SIZE+sizeof(InflateHeaderV2), 0, payload_offset-MAGIC_SIZE-sizeof(InflateHeaderV2));
+      }
+      else
+      {
+         auto legacy = legacy_header(header);
+
+         std::memcpy(output, INFLATE_MAGIC, MAGIC_SIZE);
+         std::memcpy(output+MAGIC_SIZE, &legacy, sizeof(InflateHeader));
       }
    }
-   else
-   {
-      auto lfsr = ShiftRegister(*seed);
-      std::uint64_t inflate_offset = 0;
-      
-      for (std::uint64_t i=0; i<deflate_stream.bit_size(); i+=modulus)
+
+   /// resize the output, counting an allocation only when its capacity has to grow.
+   void resize_output(ByteVec &output, std::uint64_t size) {
+      if (output.capacity() < size)
       {
-         auto read_size = (deflate_stream.bit_size() - i > modulus) ? modulus : deflate_stream.bit_size() - i;
-         bool relevant_bits[8] = { false, false, false, false, false, false, false, false };
-         std::size_t target_bits = 0;
-
-         while (target_bits < read_size)
-         {
-            auto index = *lfsr % 8;
-
-            if (relevant_bits[index])
-               continue;
-
-            relevant_bits[index] = true;
-            ++target_bits;
-         }
-
-         std::size_t bit_offset = 0;
-
-         for (std::size_t j=0; j<8; ++j)
-         {
-            if (relevant_bits[j])
-               inflate_stream.set_bit(inflate_offset++, deflate_stream.get_bit(i+bit_offset++));
-            else
-               inflate_stream.set_bit(inflate_offset++, false);
-         }
+         INFLATE_STATS_ADD(allocations, 1);
       }
+
+      output.resize(size);
    }
-   
-   InflateHeader header;
 
-   header.level = level;
-   header.inflated = inflate_stream.bit_size();
-   header.deflated = deflate_stream.bit_size();
-   header.checksum = crc32(ptr, size);
-   header.seed = *seed;
+   /// the kernels read their input while the output is resized and written, so an input lying inside the output
+   /// vector, such as a context's own `output()` passed back in, is moved out of the way first. Swapping the
+   /// vectors keeps its bytes where they are for the rest of the call, and `holder` keeps them alive.
+   void unalias_input(ByteVec &output, ByteVec &holder, const void *ptr, std::uint64_t size) {
+      auto address = reinterpret_cast<std::uintptr_t>(ptr);
+      auto begin = reinterpret_cast<std::uintptr_t>(output.data());
 
-   return std::make_pair(inflate_stream.to_bytevec(), header);
-}
+      if (ptr == nullptr || size == 0 || output.capacity() == 0)
+         return;
 
-std::pair<ByteVec, InflateHeader> inflate::inflate_memory(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) {
-   return inflate_memory(vec.data(), vec.size(), level, seed);
-}
+      if (address < begin + output.capacity() && begin < address + size)
+         std::swap(output, holder);
+   }
 
-ByteVec inflate::deflate_memory(const void *ptr, std::size_t size, const InflateHeader &header, bool validate) {
-   auto inflated_bytes = header.inflated / 8 + static_cast<std::size_t>(header.inflated % 8 != 0);
-   auto deflated_bytes = header.deflated / 8;
+   bool is_region_stream(const void *ptr, std::uint64_t size) noexcept {
+      return ptr != nullptr && size >= MAGIC_SIZE && std::memcmp(ptr, INFLATE_REGION_MAGIC, MAGIC_SIZE) == 0;
+   }
 
-   if (size != inflated_bytes)
-      throw exception::InsufficientSize(size, inflated_bytes);
+   void throw_parse_status(InflateStatus status, std::uint64_t size) {
+      switch (status)
+      {
+      case InflateStatus::STATUS_OK:
+         return;
 
-   auto inflate_stream = BitstreamPtr(reinterpret_cast<const std::uint8_t *>(ptr), header.inflated);
-   auto deflate_stream = BitstreamVec(header.deflated);
+      case InflateStatus::STATUS_NULL_POINTER:
+         throw exception::NullPointer();
 
-   switch (header.level)
-   {
-   case INFLATE_NOOP:
-      deflate_stream.write_bits(0, inflate_stream.to_bitvec());
-      break;
-
-   case INFLATE_1BIT:
-   case INFLATE_2BIT:
-   case INFLATE_3BIT:
-   case INFLATE_4BIT:
-   case INFLATE_5BIT:
-   case INFLATE_6BIT:
-   case INFLATE_7BIT:
-   {
-      auto modulus = 8 - header.level;
-      std::size_t deflate_offset = 0;
+      case InflateStatus::STATUS_INSUFFICIENT_SIZE:
+         throw exception::InsufficientSize(size, MAGIC_SIZE+sizeof(InflateHeader));
 
-      for (std::size_t inflate_offset=0; inflate_offset<header.inflated; inflate_offset+=8)
-      {
-         std::size_t read_size = ((header.inflated - inflate_offset > modulus) ? modulus : header.inflated - inflate_offset);
+      case InflateStatus::STATUS_BAD_HEADER:
+         throw exception::BadHeader();
 
-         for (std::size_t i=0; i<read_size; ++i)
-            deflate_stream.set_bit(deflate_offset++, inflate_stream.get_bit(inflate_offset+i));
+      default:
+         throw exception::BadHeaderMagic();
       }
+   }
 
-      break;
+   InflateStatus current_exception_status() noexcept {
+      try { throw; }
+      catch (exception::NullPointer &) { return InflateStatus::STATUS_NULL_POINTER; }
+      catch (exception::InsufficientSize &) { return InflateStatus::STATUS_INSUFFICIENT_SIZE; }
+      catch (exception::BadHeaderMagic &) { return InflateStatus::STATUS_BAD_HEADER_MAGIC; }
+      catch (exception::BadHeader &) { return InflateStatus::STATUS_BAD_HEADER; }
+      catch (exception::BadCRC &) { return InflateStatus::STATUS_BAD_CRC; }
+      catch (exception::UnsupportedInflateLevel &) { return InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL; }
+      catch (exception::UnsupportedChecksum &) { return InflateStatus::STATUS_UNSUPPORTED_CHECKSUM; }
+      catch (exception::UnsupportedRng &) { return InflateStatus::STATUS_UNSUPPORTED_RNG; }
+      catch (exception::BadAlignment &) { return InflateStatus::STATUS_BAD_ALIGNMENT; }
+      catch (exception::BadSeed &) { return InflateStatus::STATUS_BAD_SEED; }
+      catch (std::bad_alloc &) { return InflateStatus::STATUS_OUT_OF_MEMORY; }
+      catch (...) { return InflateStatus::STATUS_ERROR; }
    }
 
-   case INFLATE_RNG_PARTIAL_1BIT:
-   case INFLATE_RNG_PARTIAL_2BIT:
-   case INFLATE_RNG_PARTIAL_3BIT:
-   case INFLATE_RNG_PARTIAL_4BIT:
-   case INFLATE_RNG_PARTIAL_5BIT:
-   case INFLATE_RNG_PARTIAL_6BIT:
-   case INFLATE_RNG_PARTIAL_7BIT:
-   {
-      auto modulus = 8 - (header.level - InflateLevel::INFLATE_7BIT);
-      auto padding = 8 - modulus;
-      auto lfsr = ShiftRegister(header.seed);
-      std::size_t deflate_offset = 0;
-      
-      for (std::size_t inflate_offset=0; inflate_offset<inflate_stream.bit_size(); inflate_offset+=8)
-      {
-         auto read_size = (header.deflated - deflate_offset > modulus) ? modulus : header.deflated - deflate_offset;
-         auto inject_index = *lfsr % read_size;
-       
-         for (std::size_t i=0; i<read_size+padding; ++i)
-         {
-            if (i >= inject_index && i < inject_index+padding)
-               continue;
-            
-            deflate_stream.set_bit(deflate_offset++, inflate_stream.get_bit(inflate_offset+i));
-         }
-      }
+   /// shared by both header formats: legacy streams always carry a CRC32 and an `NFL8` header.
+   void inflate_disk_with(InflateContext &context, ByteVec &output, const void *ptr, std::uint64_t size, const InflateOptions &options, bool versioned) {
+      INFLATE_STATS_SCOPE("inflate_disk");
+      INFLATE_STATS_ADD(bytes_in, size);
+
+      throw_inflate_status(check_inflate_arguments(ptr, size, options), options);
+
+      ByteVec held;
+      unalias_input(output, (&output == &context.scratch()) ? held : context.scratch(), ptr, size);
+
+      auto seed = (options.seed.has_value()) ? *options.seed : context.next_seed();
+      auto payload_offset = disk_payload_offset(options, versioned);
+
+      // the payload is inflated straight into its place behind the header, so nothing is copied afterwards.
+      resize_output(output, payload_offset + bytes_of(inflated_bits(options.level, options_geometry(options), size*8)));
+      INFLATE_STATS_ADD(bytes_out, output.size());
 
-      break;
+      auto header = inflate_into(reinterpret_cast<const std::uint8_t *>(ptr), size, options, seed, output.data()+payload_offset);
+      write_disk_header(output.data(), header, payload_offset, versioned);
    }
 
-   case INFLATE_RNG_FULL_1BIT:
-   case INFLATE_RNG_FULL_2BIT:
-   case INFLATE_RNG_FULL_3BIT:
-   case INFLATE_RNG_FULL_4BIT:
-   case INFLATE_RNG_FULL_5BIT:
-   case INFLATE_RNG_FULL_6BIT:
-   case INFLATE_RNG_FULL_7BIT:
-   {
-      auto modulus = 8 - (header.level - InflateLevel::INFLATE_RNG_PARTIAL_7BIT);
-      auto lfsr = ShiftRegister(header.seed);
-      std::size_t deflate_offset = 0;
+   Result<ByteVec> try_inflate_disk_with(const void *ptr, std::uint64_t size, const InflateOptions &options, bool versioned) noexcept {
+      INFLATE_STATS_SCOPE("inflate_disk");
+      INFLATE_STATS_ADD(bytes_in, size);
 
-      for (std::size_t inflate_offset=0; inflate_offset<header.inflated; inflate_offset+=8)
-      {
-         std::size_t read_size = (header.deflated - deflate_offset > modulus) ? modulus : header.deflated - deflate_offset;
-         bool relevant_bits[8] = { false, false, false, false, false, false, false, false };
-         std::size_t target_bits = 0;
-         
-         while (target_bits < read_size)
-         {
-            auto index = *lfsr % 8;
-
-            if (relevant_bits[index])
-               continue;
-
-            relevant_bits[index] = true;
-            ++target_bits;
-         }
-
-         for (std::size_t i=0; i<8; ++i)
-         {
-            if (!relevant_bits[i])
-               continue;
-
-            deflate_stream.set_bit(deflate_offset++, inflate_stream.get_bit(inflate_offset+i));
-         }
-      }
+      auto status = check_inflate_arguments(ptr, size, options);
+
+      if (status != InflateStatus::STATUS_OK)
+         return status;
+
+      auto seed = (options.seed.has_value()) ? *options.seed : generate_seed();
+      auto payload_offset = disk_payload_offset(options, versioned);
+      ByteVec inflate_vec;
 
-      break;
+      try { inflate_vec.resize(payload_offset + bytes_of(inflated_bits(options.level, options_geometry(options), size*8))); }
+      catch (std::bad_alloc &) { return InflateStatus::STATUS_OUT_OF_MEMORY; }
+
+      INFLATE_STATS_ADD(allocations, 1);
+      INFLATE_STATS_ADD(bytes_out, inflate_vec.size());
+
+      auto header = inflate_into(reinterpret_cast<const std::uint8_t *>(ptr), size, options, seed, inflate_vec.data()+payload_offset);
+      write_disk_header(inflate_vec.data(), header, payload_offset, versioned);
+
+      return inflate_vec;
    }
+}
+
+InflateStatus inflate::internal::check_inflate_arguments(const void *ptr, std::uint64_t size, const InflateOptions &options) noexcept {
+   if (!is_supported_geometry(options.level, options_geometry(options)))
+      return InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL;
+
+   if (!is_supported_checksum(options.checksum))
+      return InflateStatus::STATUS_UNSUPPORTED_CHECKSUM;
+
+   if (!is_supported_rng(options.rng))
+      return InflateStatus::STATUS_UNSUPPORTED_RNG;
+
+   if (options.seed.has_value() && !is_usable_seed(level_family(options.level), options.rng, *options.seed))
+      return InflateStatus::STATUS_BAD_SEED;
+
+   if (!is_supported_alignment(options.alignment))
+      return InflateStatus::STATUS_BAD_ALIGNMENT;
+
+   if (ptr == nullptr && size != 0)
+      return InflateStatus::STATUS_NULL_POINTER;
+
+   return InflateStatus::STATUS_OK;
+}
+
+void inflate::internal::throw_inflate_status(InflateStatus status, const InflateOptions &options) {
+   switch (status)
+   {
+   case InflateStatus::STATUS_OK:
+      return;
+
+   case InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL:
+      throw exception::UnsupportedInflateLevel(options.level);
+
+   case InflateStatus::STATUS_UNSUPPORTED_CHECKSUM:
+      throw exception::UnsupportedChecksum(options.checksum);
+
+   case InflateStatus::STATUS_UNSUPPORTED_RNG:
+      throw exception::UnsupportedRng(options.rng);
+
+   case InflateStatus::STATUS_BAD_ALIGNMENT:
+      throw exception::BadAlignment(options.alignment);
+
+   case InflateStatus::STATUS_BAD_SEED:
+      throw exception::BadSeed(*options.seed);
 
    default:
-      throw exception::UnsupportedInflateLevel(header.level);
+      throw exception::NullPointer();
    }
+}
+
+InflateHeaderV2 inflate::internal::make_header(const InflateOptions &options, std::uint64_t size, std::uint32_t seed) noexcept {
+   InflateHeaderV2 header;
+   auto geometry = options_geometry(options);
+
+   std::memset(&header, 0, sizeof(InflateHeaderV2));
+   header.version = header_version(options.rng);
+   header.header_size = sizeof(InflateHeaderV2);
+   header.level = options.level;
+   header.checksum_type = options.checksum;
+   header.deflated = size * 8;
+   header.inflated = inflated_bits(options.level, geometry, header.deflated);
+   header.seed = seed;
+   header.rng = options.rng;
+
+   if (is_wide_level(options.level))
+   {
+      header.group_bits = static_cast<std::uint8_t>(geometry.group_bits);
+      header.padding_bits = static_cast<std::uint8_t>(geometry.padding_bits);
+   }
+
+   return header;
+}
+
+std::uint64_t inflate::internal::disk_payload_offset(const InflateOptions &options, bool versioned) noexcept {
+   if (!versioned)
+      return MAGIC_SIZE + sizeof(InflateHeader);
+
+   std::uint64_t offset = MAGIC_SIZE + sizeof(InflateHeaderV2);
+
+   if (options.alignment > 1)
+      offset = (offset + options.alignment - 1) & ~static_cast<std::uint64_t>(options.alignment - 1);
 
-   if (validate)
+   return offset;
+}
+
+void inflate::internal::throw_header_status(InflateStatus status, const InflateHeaderV2 &header, std::uint64_t size) {
+   switch (status)
    {
-      auto crc = crc32(deflate_stream.data(), deflate_stream.byte_size());
+   case InflateStatus::STATUS_OK:
+      return;
+
+   case InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL:
+      throw exception::UnsupportedInflateLevel(header.level);
+
+   case InflateStatus::STATUS_UNSUPPORTED_CHECKSUM:
+      throw exception::UnsupportedChecksum(header.checksum_type);
+
+   case InflateStatus::STATUS_UNSUPPORTED_RNG:
+      throw exception::UnsupportedRng(header.rng);
+
+   case InflateStatus::STATUS_INSUFFICIENT_SIZE:
+      throw exception::InsufficientSize(size, bytes_of(header.inflated));
+
+   default:
+      throw exception::BadHeader();
+   }
+}
+
+void inflate::internal::write_disk_stream(std::uint8_t *output, const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   throw_inflate_status(check_inflate_arguments(ptr, size, options), options);
+
+   auto payload_offset = disk_payload_offset(options, true);
+   auto header = inflate_into(reinterpret_cast<const std::uint8_t *>(ptr), size, options, *options.seed, output+payload_offset);
+   write_disk_header(output, header, payload_offset, true);
+}
+
+InflateHeaderV2 inflate::InflateContext::inflate_memory_into(ByteVec &output, const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   INFLATE_STATS_SCOPE("inflate_memory");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   throw_inflate_status(check_inflate_arguments(ptr, size, options), options);
+
+   ByteVec held;
+   unalias_input(output, (&output == &this->_scratch) ? held : this->_scratch, ptr, size);
+
+   auto seed = (options.seed.has_value()) ? *options.seed : this->next_seed();
+
+   resize_output(output, bytes_of(inflated_bits(options.level, options_geometry(options), size*8)));
+   INFLATE_STATS_ADD(bytes_out, output.size());
+
+   return inflate_into(reinterpret_cast<const std::uint8_t *>(ptr), size, options, seed, output.data());
+}
+
+InflateHeader inflate::InflateContext::inflate_memory_into(ByteVec &output, const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
+   return legacy_header(this->inflate_memory_into(output, ptr, size, InflateOptions{level, seed}));
+}
+
+void inflate::InflateContext::deflate_memory_into(ByteVec &output, const void *ptr, std::uint64_t size, const InflateHeaderV2 &header, bool validate) {
+   INFLATE_STATS_SCOPE("deflate_memory");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   throw_header_status(validate_header(header, size), header, size);
+
+   if (ptr == nullptr && size != 0)
+      throw exception::NullPointer();
+
+   ByteVec held;
+   unalias_input(output, (&output == &this->_scratch) ? held : this->_scratch, ptr, size);
+
+   std::uint64_t sum = 0;
+
+   resize_output(output, bytes_of(header.deflated));
+   INFLATE_STATS_ADD(bytes_out, output.size());
+
+   if (deflate_into(reinterpret_cast<const std::uint8_t *>(ptr), header, validate, output.data(), sum) != InflateStatus::STATUS_OK)
+      throw exception::BadCRC(sum, header.checksum);
+}
+
+void inflate::InflateContext::deflate_memory_into(ByteVec &output, const void *ptr, std::uint64_t size, const InflateHeader &header, bool validate) {
+   this->deflate_memory_into(output, ptr, size, versioned_header(header), validate);
+}
+
+void inflate::InflateContext::inflate_disk_into(ByteVec &output, const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   inflate_disk_with(*this, output, ptr, size, options, true);
+}
+
+void inflate::InflateContext::inflate_disk_into(ByteVec &output, const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
+   inflate_disk_with(*this, output, ptr, size, InflateOptions{level, seed}, false);
+}
 
-      if (crc != header.checksum)
-         throw exception::BadCRC(crc, header.checksum);
+void inflate::InflateContext::deflate_disk_into(ByteVec &output, const void *ptr, std::uint64_t size) {
+   INFLATE_STATS_SCOPE("deflate_disk");
+
+   if (is_region_stream(ptr, size))
+   {
+      output = inflate::deflate_regions_disk(ptr, size);
+      return;
    }
 
-   return deflate_stream.to_bytevec();
+   InflateHeaderV2 header;
+   std::uint64_t payload_offset = 0;
+
+   throw_parse_status(parse_disk(ptr, size, header, payload_offset), size);
+
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   this->deflate_memory_into(output, u8_ptr+payload_offset, size-payload_offset, header);
+}
+
+std::pair<const ByteVec &, InflateHeader> inflate::InflateContext::inflate_memory(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
+   auto header = this->inflate_memory_into(this->_output, ptr, size, level, seed);
+   return std::pair<const ByteVec &, InflateHeader>(this->_output, header);
+}
+
+std::pair<const ByteVec &, InflateHeader> inflate::InflateContext::inflate_memory(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) {
+   return this->inflate_memory(vec.data(), vec.size(), level, seed);
+}
+
+std::pair<const ByteVec &, InflateHeaderV2> inflate::InflateContext::inflate_memory(const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   auto header = this->inflate_memory_into(this->_output, ptr, size, options);
+   return std::pair<const ByteVec &, InflateHeaderV2>(this->_output, header);
+}
+
+std::pair<const ByteVec &, InflateHeaderV2> inflate::InflateContext::inflate_memory(const ByteVec &vec, const InflateOptions &options) {
+   return this->inflate_memory(vec.data(), vec.size(), options);
+}
+
+const ByteVec &inflate::InflateContext::deflate_memory(const void *ptr, std::uint64_t size, const InflateHeader &header, bool validate) {
+   this->deflate_memory_into(this->_output, ptr, size, header, validate);
+   return this->_output;
+}
+
+const ByteVec &inflate::InflateContext::deflate_memory(const ByteVec &vec, const InflateHeader &header, bool validate) {
+   return this->deflate_memory(vec.data(), vec.size(), header, validate);
+}
+
+const ByteVec &inflate::InflateContext::deflate_memory(const void *ptr, std::uint64_t size, const InflateHeaderV2 &header, bool validate) {
+   this->deflate_memory_into(this->_output, ptr, size, header, validate);
+   return this->_output;
+}
+
+const ByteVec &inflate::InflateContext::deflate_memory(const ByteVec &vec, const InflateHeaderV2 &header, bool validate) {
+   return this->deflate_memory(vec.data(), vec.size(), header, validate);
+}
+
+const ByteVec &inflate::InflateContext::inflate_disk(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
+   this->inflate_disk_into(this->_output, ptr, size, level, seed);
+   return this->_output;
+}
+
+const ByteVec &inflate::InflateContext::inflate_disk(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) {
+   return this->inflate_disk(vec.data(), vec.size(), level, seed);
+}
+
+const ByteVec &inflate::InflateContext::inflate_disk(const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   this->inflate_disk_into(this->_output, ptr, size, options);
+   return this->_output;
+}
+
+const ByteVec &inflate::InflateContext::inflate_disk(const ByteVec &vec, const InflateOptions &options) {
+   return this->inflate_disk(vec.data(), vec.size(), options);
+}
+
+const ByteVec &inflate::InflateContext::deflate_disk(const void *ptr, std::uint64_t size) {
+   this->deflate_disk_into(this->_output, ptr, size);
+   return this->_output;
 }
-      
+
+const ByteVec &inflate::InflateContext::deflate_disk(const ByteVec &vec) {
+   return this->deflate_disk(vec.data(), vec.size());
+}
+
+std::pair<ByteVec, InflateHeader> inflate::inflate_memory(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
+   ByteVec result;
+   auto header = thread_context().inflate_memory_into(result, ptr, size, level, seed);
+
+   return std::make_pair(std::move(result), header);
+}
+
+std::pair<ByteVec, InflateHeader> inflate::inflate_memory(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) {
+   return inflate_memory(vec.data(), vec.size(), level, seed);
+}
+
+std::pair<ByteVec, InflateHeaderV2> inflate::inflate_memory(const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   ByteVec result;
+   auto header = thread_context().inflate_memory_into(result, ptr, size, options);
+
+   return std::make_pair(std::move(result), header);
+}
+
+std::pair<ByteVec, InflateHeaderV2> inflate::inflate_memory(const ByteVec &vec, const InflateOptions &options) {
+   return inflate_memory(vec.data(), vec.size(), options);
+}
+
+ByteVec inflate::deflate_memory(const void *ptr, std::size_t size, const InflateHeader &header, bool validate) {
+   ByteVec result;
+   thread_context().deflate_memory_into(result, ptr, size, header, validate);
+
+   return result;
+}
+
 ByteVec inflate::deflate_memory(const ByteVec &vec, const InflateHeader &header, bool validate) {
    return inflate::deflate_memory(vec.data(), vec.size(), header, validate);
 }
 
-ByteVec inflate::inflate_disk(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
-   auto mem = inflate::inflate_memory(ptr, size, level, seed);
-   auto header = mem.second;
-   auto magic = INFLATE_MAGIC;
-   ByteVec inflate_vec;
+ByteVec inflate::deflate_memory(const void *ptr, std::uint64_t size, const InflateHeaderV2 &header, bool validate) {
+   ByteVec result;
+   thread_context().deflate_memory_into(result, ptr, size, header, validate);
 
-   inflate_vec.insert(inflate_vec.end(),
-                      magic,
-                      magic+std::strlen(magic));
-   inflate_vec.insert(inflate_vec.end(),
-                      reinterpret_cast<std::uint8_t *>(&header),
-                      reinterpret_cast<std::uint8_t *>(&header)+(sizeof(InflateHeader)));
-   inflate_vec.insert(inflate_vec.end(),
-                      mem.first.data(),
-                      mem.first.data()+mem.first.size());
+   return result;
+}
 
-   return inflate_vec;
+ByteVec inflate::deflate_memory(const ByteVec &vec, const InflateHeaderV2 &header, bool validate) {
+   return inflate::deflate_memory(vec.data(), vec.size(), header, validate);
+}
+
+ByteVec inflate::inflate_disk(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) {
+   ByteVec result;
+   thread_context().inflate_disk_into(result, ptr, size, level, seed);
+
+   return result;
 }
 
 ByteVec inflate::inflate_disk(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) {
    return inflate::inflate_disk(vec.data(), vec.size(), level, seed);
 }
 
-ByteVec inflate::deflate_disk(const void *ptr, std::uint64_t size) {
-   if (size < sizeof(InflateHeader)-1)
-      throw exception::InsufficientSize(size, sizeof(InflateHeader));
+ByteVec inflate::inflate_disk(const void *ptr, std::uint64_t size, const InflateOptions &options) {
+   ByteVec result;
+   thread_context().inflate_disk_into(result, ptr, size, options);
 
-   if (std::memcmp(ptr, INFLATE_MAGIC, std::strlen(INFLATE_MAGIC)) != 0)
-      throw exception::BadHeaderMagic();
+   return result;
+}
 
-   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
-   auto header = reinterpret_cast<const InflateHeader *>(u8_ptr+std::strlen(INFLATE_MAGIC));
+ByteVec inflate::inflate_disk(const ByteVec &vec, const InflateOptions &options) {
+   return inflate::inflate_disk(vec.data(), vec.size(), options);
+}
+
+ByteVec inflate::deflate_disk(const void *ptr, std::uint64_t size) {
+   ByteVec result;
+   thread_context().deflate_disk_into(result, ptr, size);
 
-   return inflate::deflate_memory(u8_ptr+std::strlen(INFLATE_MAGIC)+sizeof(InflateHeader),
-                                  size-std::strlen(INFLATE_MAGIC)-sizeof(InflateHeader),
-                                  *header);
+   return result;
 }
 
 ByteVec inflate::deflate_disk(const ByteVec &vec) {
    return inflate::deflate_disk(vec.data(), vec.size());
 }
+
+Result<std::pair<ByteVec, InflateHeaderV2>> inflate::try_inflate_memory(const void *ptr, std::uint64_t size, const InflateOptions &options) noexcept {
+   INFLATE_STATS_SCOPE("inflate_memory");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   auto status = check_inflate_arguments(ptr, size, options);
+
+   if (status != InflateStatus::STATUS_OK)
+      return status;
+
+   auto seed = (options.seed.has_value()) ? *options.seed : generate_seed();
+   ByteVec result;
+
+   try { result.resize(bytes_of(inflated_bits(options.level, options_geometry(options), size*8))); }
+   catch (std::bad_alloc &) { return InflateStatus::STATUS_OUT_OF_MEMORY; }
+
+   INFLATE_STATS_ADD(allocations, 1);
+   INFLATE_STATS_ADD(bytes_out, result.size());
+
+   auto header = inflate_into(reinterpret_cast<const std::uint8_t *>(ptr), size, options, seed, result.data());
+
+   return std::make_pair(std::move(result), header);
+}
+
+Result<std::pair<ByteVec, InflateHeaderV2>> inflate::try_inflate_memory(const ByteVec &vec, const InflateOptions &options) noexcept {
+   return inflate::try_inflate_memory(vec.data(), vec.size(), options);
+}
+
+Result<std::pair<ByteVec, InflateHeader>> inflate::try_inflate_memory(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) noexcept {
+   auto result = inflate::try_inflate_memory(ptr, size, InflateOptions{level, seed});
+
+   if (!result.ok())
+      return result.status();
+
+   auto header = legacy_header(result->second);
+
+   return std::make_pair(std::move(result->first), header);
+}
+
+Result<std::pair<ByteVec, InflateHeader>> inflate::try_inflate_memory(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) noexcept {
+   return inflate::try_inflate_memory(vec.data(), vec.size(), level, seed);
+}
+
+Result<ByteVec> inflate::try_deflate_memory(const void *ptr, std::uint64_t size, const InflateHeaderV2 &header, bool validate) noexcept {
+   INFLATE_STATS_SCOPE("deflate_memory");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   auto status = validate_header(header, size);
+
+   if (status != InflateStatus::STATUS_OK)
+      return status;
+
+   if (ptr == nullptr && size != 0)
+      return InflateStatus::STATUS_NULL_POINTER;
+
+   ByteVec result;
+   std::uint64_t sum = 0;
+
+   try { result.resize(bytes_of(header.deflated)); }
+   catch (std::bad_alloc &) { return InflateStatus::STATUS_OUT_OF_MEMORY; }
+
+   INFLATE_STATS_ADD(allocations, 1);
+   INFLATE_STATS_ADD(bytes_out, result.size());
+
+   status = deflate_into(reinterpret_cast<const std::uint8_t *>(ptr), header, validate, result.data(), sum);
+
+   if (status != InflateStatus::STATUS_OK)
+      return status;
+
+   return result;
+}
+
+Result<ByteVec> inflate::try_deflate_memory(const ByteVec &vec, const InflateHeaderV2 &header, bool validate) noexcept {
+   return inflate::try_deflate_memory(vec.data(), vec.size(), header, validate);
+}
+
+Result<ByteVec> inflate::try_deflate_memory(const void *ptr, std::uint64_t size, const InflateHeader &header, bool validate) noexcept {
+   return inflate::try_deflate_memory(ptr, size, versioned_header(header), validate);
+}
+
+Result<ByteVec> inflate::try_deflate_memory(const ByteVec &vec, const InflateHeader &header, bool validate) noexcept {
+   return inflate::try_deflate_memory(vec.data(), vec.size(), header, validate);
+}
+
+Result<ByteVec> inflate::try_inflate_disk(const void *ptr, std::uint64_t size, const InflateOptions &options) noexcept {
+   return try_inflate_disk_with(ptr, size, options, true);
+}
+
+Result<ByteVec> inflate::try_inflate_disk(const ByteVec &vec, const InflateOptions &options) noexcept {
+   return inflate::try_inflate_disk(vec.data(), vec.size(), options);
+}
+
+Result<ByteVec> inflate::try_inflate_disk(const void *ptr, std::uint64_t size, InflateLevel level, std::optional<std::uint32_t> seed) noexcept {
+   return try_inflate_disk_with(ptr, size, InflateOptions{level, seed}, false);
+}
+
+Result<ByteVec> inflate::try_inflate_disk(const ByteVec &vec, InflateLevel level, std::optional<std::uint32_t> seed) noexcept {
+   return inflate::try_inflate_disk(vec.data(), vec.size(), level, seed);
+}
+
+Result<ByteVec> inflate::try_deflate_disk(const void *ptr, std::uint64_t size) noexcept {
+   INFLATE_STATS_SCOPE("deflate_disk");
+
+   // region streams are rare and made of many small calls, so they go through the throwing path.
+   if (is_region_stream(ptr, size))
+   {
+      try { return inflate::deflate_regions_disk(ptr, size); }
+      catch (...) { return current_exception_status(); }
+   }
+
+   InflateHeaderV2 header;
+   std::uint64_t payload_offset = 0;
+   auto status = parse_disk(ptr, size, header, payload_offset);
+
+   if (status != InflateStatus::STATUS_OK)
+      return status;
+
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   return inflate::try_deflate_memory(u8_ptr+payload_offset, size-payload_offset, header);
+}
+
+Result<ByteVec> inflate::try_deflate_disk(const ByteVec &vec) noexcept {
+   return inflate::try_deflate_disk(vec.data(), vec.size());
+}
+
+InflateContainer inflate::parse_container(const void *ptr, std::uint64_t size) {
+   InflateContainer container;
+
+   throw_parse_status(parse_disk(ptr, size, container.header, container.payload_offset), size);
+   container.payload_size = size - container.payload_offset;
+   throw_header_status(validate_header(container.header, container.payload_size), container.header, container.payload_size);
+
+   return container;
+}
+
+InflateContainer inflate::parse_container(const ByteVec &vec) {
+   return inflate::parse_container(vec.data(), vec.size());
+}
+
+Result<InflateContainer> inflate::try_parse_container(const void *ptr, std::uint64_t size) noexcept {
+   InflateContainer container;
+   auto status = parse_disk(ptr, size, container.header, container.payload_offset);
+
+   if (status != InflateStatus::STATUS_OK)
+      return status;
+
+   container.payload_size = size - container.payload_offset;
+   status = validate_header(container.header, container.payload_size);
+
+   if (status != InflateStatus::STATUS_OK)
+      return status;
+
+   return container;
+}
+
+Result<InflateContainer> inflate::try_parse_container(const ByteVec &vec) noexcept {
+   return inflate::try_parse_container(vec.data(), vec.size());
+}
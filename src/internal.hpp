@@ -0,0 +1,43 @@
+#ifndef __INFLATE_INTERNAL_HPP
+#define __INFLATE_INTERNAL_HPP
+
+/// @file internal.hpp
+/// @brief Helpers shared by the library's translation units. Not installed, and not part of the API.
+
+#include <inflate.hpp>
+
+namespace inflate
+{
+namespace internal
+{
+   /// @brief The bytes needed to hold `bits` bits.
+   constexpr std::uint64_t bytes_of(std::uint64_t bits) noexcept {
+      return bits / 8 + static_cast<std::uint64_t>(bits % 8 != 0);
+   }
+
+   /// @brief Throw the exception matching a status returned by `validate_header`. `STATUS_OK` returns.
+   void throw_header_status(InflateStatus status, const InflateHeaderV2 &header, std::uint64_t size);
+
+   /// @brief Validate a header against the size of its payload, throwing on failure.
+   inline void check_header(const InflateHeaderV2 &header, std::uint64_t size) {
+      throw_header_status(validate_header(header, size), header, size);
+   }
+
+   /// @brief Check `options` and the input before inflating. A seed, if given, must suit the level and engine.
+   InflateStatus check_inflate_arguments(const void *ptr, std::uint64_t size, const InflateOptions &options) noexcept;
+
+   /// @brief Throw the exception matching a status returned by `check_inflate_arguments`. `STATUS_OK` returns.
+   void throw_inflate_status(InflateStatus status, const InflateOptions &options);
+
+   /// @brief The versioned header for `size` bytes inflated under `options` with `seed`, checksum left at 0.
+   InflateHeaderV2 make_header(const InflateOptions &options, std::uint64_t size, std::uint32_t seed) noexcept;
+
+   /// @brief Where the payload starts in a stream written by `inflate_disk`, padding included.
+   std::uint64_t disk_payload_offset(const InflateOptions &options, bool versioned) noexcept;
+
+   /// @brief Write the `NFLV` stream `inflate_disk` would return to `output`, which must hold
+   /// `disk_payload_offset(options, true) + inflated_size(options, size)` bytes. `options.seed` must be set.
+   void write_disk_stream(std::uint8_t *output, const void *ptr, std::uint64_t size, const InflateOptions &options);
+}}
+
+#endif
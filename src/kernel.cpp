@@ -0,0 +1,893 @@
+#include <inflate.hpp>
+
+#if defined(INFLATE_X86)
+#include <immintrin.h>
+#endif
+
+using namespace inflate;
+
+namespace
+{
+   inline std::uint64_t low_mask(std::uint32_t bits) {
+      return (bits >= 64) ? ~static_cast<std::uint64_t>(0) : (static_cast<std::uint64_t>(1) << bits) - 1;
+   }
+
+   inline std::uint64_t load_le(const std::uint8_t *ptr, std::size_t bytes) {
+      std::uint64_t value = 0;
+
+      for (std::size_t i=0; i<bytes; ++i)
+         value |= static_cast<std::uint64_t>(ptr[i]) << (i*8);
+
+      return value;
+   }
+
+   inline void store_le(std::uint8_t *ptr, std::uint64_t value, std::size_t bytes) {
+      for (std::size_t i=0; i<bytes; ++i)
+         ptr[i] = static_cast<std::uint8_t>(value >> (i*8));
+   }
+
+   /// read `count` bits starting at bit `offset`, touching only the bytes those bits occupy.
+   inline std::uint64_t extract(const std::uint8_t *ptr, std::uint64_t offset, std::uint32_t count) {
+      auto shift = static_cast<std::uint32_t>(offset % 8);
+      auto bytes = (shift + count + 7) / 8;
+
+      return (load_le(ptr+offset/8, bytes) >> shift) & low_mask(count);
+   }
+
+   inline std::uint8_t deposit(std::uint64_t value, std::uint8_t mask) {
+      std::uint8_t result = 0;
+
+      for (std::uint32_t i=0; i<8; ++i)
+      {
+         if (((mask >> i) & 1) == 0)
+            continue;
+
+         result |= static_cast<std::uint8_t>((value & 1) << i);
+         value >>= 1;
+      }
+
+      return result;
+   }
+
+   inline std::uint64_t gather(std::uint8_t value, std::uint8_t mask) {
+      std::uint64_t result = 0;
+      std::uint32_t bit = 0;
+
+      for (std::uint32_t i=0; i<8; ++i)
+         if ((mask >> i) & 1)
+            result |= static_cast<std::uint64_t>((value >> i) & 1) << bit++;
+
+      return result;
+   }
+
+   class BitWriter
+   {
+      std::uint8_t *_ptr;
+      std::uint64_t _acc;
+      std::uint32_t _bits;
+
+   public:
+      BitWriter(std::uint8_t *ptr) : _ptr(ptr), _acc(0), _bits(0) {}
+
+      void put(std::uint64_t value, std::uint32_t count) {
+         this->_acc |= value << this->_bits;
+         this->_bits += count;
+
+         while (this->_bits >= 8)
+         {
+            *this->_ptr++ = static_cast<std::uint8_t>(this->_acc);
+            this->_acc >>= 8;
+            this->_bits -= 8;
+         }
+      }
+
+      void flush() {
+         if (this->_bits > 0)
+            *this->_ptr++ = static_cast<std::uint8_t>(this->_acc);
+
+         this->_acc = 0;
+         this->_bits = 0;
+      }
+   };
+
+   // with M bits per group, eight groups occupy exactly M input bytes and eight output bytes,
+   // so the main loops move whole blocks and only the tail goes through the bit-level helpers.
+
+   template <std::uint32_t M>
+   void inflate_fixed(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output) {
+      auto groups = bits / M;
+      auto blocks = groups / 8;
+
+      for (std::uint64_t b=0; b<blocks; ++b)
+      {
+         auto value = load_le(input+b*M, M);
+         std::uint64_t result = 0;
+
+         for (std::uint32_t k=0; k<8; ++k)
+            result |= ((value >> (k*M)) & low_mask(M)) << (k*8);
+
+         store_le(output+b*8, result, 8);
+      }
+
+      for (std::uint64_t g=blocks*8; g<groups; ++g)
+         output[g] = static_cast<std::uint8_t>(extract(input, g*M, M));
+
+      if (bits % M != 0)
+         output[groups] = static_cast<std::uint8_t>(extract(input, groups*M, bits % M));
+   }
+
+   template <std::uint32_t M>
+   void deflate_fixed(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output) {
+      auto groups = bits / M;
+      auto blocks = groups / 8;
+
+      for (std::uint64_t b=0; b<blocks; ++b)
+      {
+         std::uint64_t result = 0;
+
+         for (std::uint32_t k=0; k<8; ++k)
+            result |= (input[b*8+k] & low_mask(M)) << (k*M);
+
+         store_le(output+b*M, result, M);
+      }
+
+      BitWriter writer(output+blocks*M);
+
+      for (std::uint64_t g=blocks*8; g<groups; ++g)
+         writer.put(input[g] & low_mask(M), M);
+
+      if (bits % M != 0)
+         writer.put(input[groups] & low_mask(bits % M), bits % M);
+
+      writer.flush();
+   }
+
+   // a partial group depends only on its input bits and the injection index, of which there are at most
+   // seven, so each direction is a single lookup. padding bits are written as zero and ignored on decode.
+   template <std::uint32_t M>
+   struct PartialTables
+   {
+      std::uint8_t inflate[M][1 << M];
+      std::uint8_t deflate[M][256];
+   };
+
+   template <std::uint32_t M>
+   constexpr PartialTables<M> make_partial_tables() {
+      const std::uint32_t padding = 8 - M;
+      PartialTables<M> tables {};
+
+      for (std::uint32_t inject=0; inject<M; ++inject)
+      {
+         std::uint32_t low = (1u << inject) - 1;
+
+         for (std::uint32_t x=0; x<(1u << M); ++x)
+            tables.inflate[inject][x] = static_cast<std::uint8_t>((x & low) | ((x >> inject) << (inject + padding)));
+
+         for (std::uint32_t byte=0; byte<256; ++byte)
+            tables.deflate[inject][byte] = static_cast<std::uint8_t>((byte & low) | (((byte >> (inject + padding)) & ((1u << (M - inject)) - 1)) << inject));
+      }
+
+      return tables;
+   }
+
+   template <std::uint32_t M>
+   constexpr PartialTables<M> PARTIAL_TABLES = make_partial_tables<M>();
+
+   template <std::uint32_t M, typename Rng>
+   void inflate_rng_partial(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      const auto &table = PARTIAL_TABLES<M>.inflate;
+      auto groups = bits / M;
+      auto blocks = groups / 8;
+
+      for (std::uint64_t b=0; b<blocks; ++b)
+      {
+         auto value = load_le(input+b*M, M);
+         std::uint64_t result = 0;
+
+         for (std::uint32_t k=0; k<8; ++k)
+            result |= static_cast<std::uint64_t>(table[rng.next_group().shift() % M][(value >> (k*M)) & low_mask(M)]) << (k*8);
+
+         store_le(output+b*8, result, 8);
+      }
+
+      for (std::uint64_t g=blocks*8; g<groups; ++g)
+         output[g] = table[rng.next_group().shift() % M][extract(input, g*M, M)];
+
+      // the final short group draws its injection index from its own size, which is still below M.
+      if (bits % M != 0)
+      {
+         auto read_size = static_cast<std::uint32_t>(bits % M);
+         auto x = extract(input, groups*M, read_size);
+
+         output[groups] = table[rng.next_group().shift() % read_size][x];
+      }
+
+      INFLATE_STATS_ADD(lfsr_steps, groups + static_cast<std::uint64_t>(bits % M != 0));
+   }
+
+   template <std::uint32_t M, typename Rng>
+   void deflate_rng_partial(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      const auto &table = PARTIAL_TABLES<M>.deflate;
+      auto groups = bits / M;
+      auto blocks = groups / 8;
+
+      for (std::uint64_t b=0; b<blocks; ++b)
+      {
+         auto value = load_le(input+b*8, 8);
+         std::uint64_t result = 0;
+
+         for (std::uint32_t k=0; k<8; ++k)
+            result |= static_cast<std::uint64_t>(table[rng.next_group().shift() % M][(value >> (k*8)) & 0xFF]) << (k*M);
+
+         store_le(output+b*M, result, M);
+      }
+
+      BitWriter writer(output+blocks*M);
+
+      for (std::uint64_t g=blocks*8; g<groups; ++g)
+         writer.put(table[rng.next_group().shift() % M][input[g]], M);
+
+      if (bits % M != 0)
+      {
+         auto read_size = static_cast<std::uint32_t>(bits % M);
+
+         writer.put(table[rng.next_group().shift() % read_size][input[groups]] & low_mask(read_size), read_size);
+      }
+
+      writer.flush();
+
+      INFLATE_STATS_ADD(lfsr_steps, groups + static_cast<std::uint64_t>(bits % M != 0));
+   }
+
+   template <typename Draws>
+   inline std::uint8_t full_mask(Draws &&draws, std::uint32_t read_size) {
+      std::uint8_t mask = 0;
+      std::uint32_t target_bits = 0;
+
+      while (target_bits < read_size)
+      {
+         auto index = draws.shift() % 8;
+         INFLATE_STATS_ADD(lfsr_steps, 1);
+
+         if ((mask >> index) & 1)
+            continue;
+
+         mask |= static_cast<std::uint8_t>(1 << index);
+         ++target_bits;
+      }
+
+      return mask;
+   }
+
+   template <std::uint32_t M, typename Rng>
+   void inflate_rng_full(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      auto groups = bits / M + static_cast<std::uint64_t>(bits % M != 0);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(M, bits - g*M));
+         auto mask = full_mask(rng.next_group(), read_size);
+
+         output[g] = deposit(extract(input, g*M, read_size), mask);
+      }
+   }
+
+   template <std::uint32_t M, typename Rng>
+   void deflate_rng_full(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      auto groups = bits / M + static_cast<std::uint64_t>(bits % M != 0);
+      BitWriter writer(output);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(M, bits - g*M));
+         auto mask = full_mask(rng.next_group(), read_size);
+
+         writer.put(gather(input[g], mask), read_size);
+      }
+
+      writer.flush();
+   }
+
+#if defined(INFLATE_X86)
+   // the same kernels with the deposit and gather loops replaced by single BMI2 instructions.
+
+   template <std::uint32_t M, typename Rng>
+   INFLATE_TARGET("bmi2")
+   void inflate_rng_full_bmi2(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      auto groups = bits / M + static_cast<std::uint64_t>(bits % M != 0);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(M, bits - g*M));
+         auto mask = full_mask(rng.next_group(), read_size);
+
+         output[g] = static_cast<std::uint8_t>(_pdep_u32(static_cast<std::uint32_t>(extract(input, g*M, read_size)), mask));
+      }
+   }
+
+   template <std::uint32_t M, typename Rng>
+   INFLATE_TARGET("bmi2")
+   void deflate_rng_full_bmi2(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      auto groups = bits / M + static_cast<std::uint64_t>(bits % M != 0);
+      BitWriter writer(output);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(M, bits - g*M));
+         auto mask = full_mask(rng.next_group(), read_size);
+
+         writer.put(_pext_u32(input[g], mask), read_size);
+      }
+
+      writer.flush();
+   }
+#endif
+
+   // the wide levels store each group as G/8 little-endian bytes. the groups aren't byte-aligned on the
+   // input side, so they go through the bit-level helpers throughout.
+
+   template <std::uint32_t G>
+   void inflate_wide_fixed(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus;
+
+      for (std::uint64_t g=0; g<groups; ++g)
+         store_le(output+g*(G/8), extract(input, g*modulus, modulus), G/8);
+
+      // like the 8-bit fixed levels, the trailing partial group is left unpadded.
+      if (bits % modulus != 0)
+      {
+         auto read_size = static_cast<std::uint32_t>(bits % modulus);
+         store_le(output+groups*(G/8), extract(input, groups*modulus, read_size), (read_size + 7) / 8);
+      }
+   }
+
+   template <std::uint32_t G>
+   void deflate_wide_fixed(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus;
+      BitWriter writer(output);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+         writer.put(load_le(input+g*(G/8), G/8) & low_mask(modulus), modulus);
+
+      if (bits % modulus != 0)
+      {
+         auto read_size = static_cast<std::uint32_t>(bits % modulus);
+         writer.put(load_le(input+groups*(G/8), (read_size + 7) / 8) & low_mask(read_size), read_size);
+      }
+
+      writer.flush();
+   }
+
+   template <std::uint32_t G, typename Rng>
+   void inflate_wide_partial(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding, Rng &rng) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(modulus, bits - g*modulus));
+         auto x = extract(input, g*modulus, read_size);
+         auto inject = rng.next_group().shift() % read_size;
+
+         store_le(output+g*(G/8), (x & low_mask(inject)) | ((x >> inject) << (inject + padding)), G/8);
+      }
+
+      INFLATE_STATS_ADD(lfsr_steps, groups);
+   }
+
+   template <std::uint32_t G, typename Rng>
+   void deflate_wide_partial(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding, Rng &rng) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0);
+      BitWriter writer(output);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(modulus, bits - g*modulus));
+         auto value = load_le(input+g*(G/8), G/8);
+         auto inject = rng.next_group().shift() % read_size;
+
+         writer.put((value & low_mask(inject)) | (((value >> (inject + padding)) & low_mask(read_size - inject)) << inject), read_size);
+      }
+
+      writer.flush();
+
+      INFLATE_STATS_ADD(lfsr_steps, groups);
+   }
+
+   /// pick the data positions of a wide group. drawing distinct positions gets slow as they run out, so
+   /// when there are fewer padding positions than data positions, the padding positions are drawn instead.
+   template <std::uint32_t G, typename Draws>
+   std::uint64_t wide_mask(Draws &&draws, std::uint32_t read_size) {
+      auto count = std::min(read_size, G - read_size);
+      std::uint64_t mask = 0;
+      std::uint32_t picked = 0;
+
+      while (picked < count)
+      {
+         auto index = draws.shift() % G;
+         INFLATE_STATS_ADD(lfsr_steps, 1);
+
+         if ((mask >> index) & 1)
+            continue;
+
+         mask |= static_cast<std::uint64_t>(1) << index;
+         ++picked;
+      }
+
+      return (count == read_size) ? mask : ~mask & low_mask(G);
+   }
+
+   template <std::uint32_t G, typename Rng>
+   void inflate_wide_full(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding, Rng &rng) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(modulus, bits - g*modulus));
+         auto mask = wide_mask<G>(rng.next_group(), read_size);
+         auto value = extract(input, g*modulus, read_size);
+         std::uint64_t result = 0;
+
+         for (std::uint32_t i=0; i<G; ++i)
+         {
+            if (((mask >> i) & 1) == 0)
+               continue;
+
+            result |= (value & 1) << i;
+            value >>= 1;
+         }
+
+         store_le(output+g*(G/8), result, G/8);
+      }
+   }
+
+   template <std::uint32_t G, typename Rng>
+   void deflate_wide_full(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding, Rng &rng) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0);
+      BitWriter writer(output);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(modulus, bits - g*modulus));
+         auto mask = wide_mask<G>(rng.next_group(), read_size);
+         auto value = load_le(input+g*(G/8), G/8);
+         std::uint64_t result = 0;
+         std::uint32_t bit = 0;
+
+         for (std::uint32_t i=0; i<G; ++i)
+            if ((mask >> i) & 1)
+               result |= ((value >> i) & 1) << bit++;
+
+         writer.put(result, read_size);
+      }
+
+      writer.flush();
+   }
+
+#if defined(INFLATE_X86)
+   template <std::uint32_t G, typename Rng>
+   INFLATE_TARGET("bmi2")
+   void inflate_wide_full_bmi2(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding, Rng &rng) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(modulus, bits - g*modulus));
+         auto mask = static_cast<std::uint32_t>(wide_mask<G>(rng.next_group(), read_size));
+
+         store_le(output+g*(G/8), _pdep_u32(static_cast<std::uint32_t>(extract(input, g*modulus, read_size)), mask), G/8);
+      }
+   }
+
+   template <std::uint32_t G, typename Rng>
+   INFLATE_TARGET("bmi2")
+   void deflate_wide_full_bmi2(const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, std::uint32_t padding, Rng &rng) {
+      const std::uint32_t modulus = G - padding;
+      auto groups = bits / modulus + static_cast<std::uint64_t>(bits % modulus != 0);
+      BitWriter writer(output);
+
+      for (std::uint64_t g=0; g<groups; ++g)
+      {
+         auto read_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(modulus, bits - g*modulus));
+         auto mask = static_cast<std::uint32_t>(wide_mask<G>(rng.next_group(), read_size));
+
+         writer.put(_pext_u32(static_cast<std::uint32_t>(load_le(input+g*(G/8), G/8)), mask), read_size);
+      }
+
+      writer.flush();
+   }
+#endif
+
+   template <template <std::uint32_t> class Kernel, typename... Args>
+   void dispatch_group(std::uint32_t group_bits, Args&&... args) {
+      switch (group_bits)
+      {
+      case 16: Kernel<16>::run(std::forward<Args>(args)...); break;
+      case 32: Kernel<32>::run(std::forward<Args>(args)...); break;
+      }
+   }
+
+   template <std::uint32_t G> struct InflateWideFixed { static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p) { inflate_wide_fixed<G>(i, b, o, p); } };
+   template <std::uint32_t G> struct DeflateWideFixed { static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p) { deflate_wide_fixed<G>(i, b, o, p); } };
+   template <std::uint32_t G> struct InflateWidePartial { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p, Rng &l) { inflate_wide_partial<G>(i, b, o, p, l); } };
+   template <std::uint32_t G> struct DeflateWidePartial { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p, Rng &l) { deflate_wide_partial<G>(i, b, o, p, l); } };
+   template <std::uint32_t G> struct InflateWideFull { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p, Rng &l) { inflate_wide_full<G>(i, b, o, p, l); } };
+   template <std::uint32_t G> struct DeflateWideFull { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p, Rng &l) { deflate_wide_full<G>(i, b, o, p, l); } };
+
+   template <template <std::uint32_t> class Kernel, typename... Args>
+   void dispatch_modulus(std::uint32_t modulus, Args&&... args) {
+      switch (modulus)
+      {
+      case 1: Kernel<1>::run(std::forward<Args>(args)...); break;
+      case 2: Kernel<2>::run(std::forward<Args>(args)...); break;
+      case 3: Kernel<3>::run(std::forward<Args>(args)...); break;
+      case 4: Kernel<4>::run(std::forward<Args>(args)...); break;
+      case 5: Kernel<5>::run(std::forward<Args>(args)...); break;
+      case 6: Kernel<6>::run(std::forward<Args>(args)...); break;
+      case 7: Kernel<7>::run(std::forward<Args>(args)...); break;
+      }
+   }
+
+   template <std::uint32_t M> struct InflateFixed { static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o) { inflate_fixed<M>(i, b, o); } };
+   template <std::uint32_t M> struct DeflateFixed { static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o) { deflate_fixed<M>(i, b, o); } };
+   template <std::uint32_t M> struct InflatePartial { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, Rng &l) { inflate_rng_partial<M>(i, b, o, l); } };
+   template <std::uint32_t M> struct DeflatePartial { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, Rng &l) { deflate_rng_partial<M>(i, b, o, l); } };
+   template <std::uint32_t M> struct InflateFull { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, Rng &l) { inflate_rng_full<M>(i, b, o, l); } };
+   template <std::uint32_t M> struct DeflateFull { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, Rng &l) { deflate_rng_full<M>(i, b, o, l); } };
+
+#if defined(INFLATE_X86)
+   template <std::uint32_t M> struct InflateFullBmi2 { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, Rng &l) { inflate_rng_full_bmi2<M>(i, b, o, l); } };
+   template <std::uint32_t M> struct DeflateFullBmi2 { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, Rng &l) { deflate_rng_full_bmi2<M>(i, b, o, l); } };
+   template <std::uint32_t G> struct InflateWideFullBmi2 { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p, Rng &l) { inflate_wide_full_bmi2<G>(i, b, o, p, l); } };
+   template <std::uint32_t G> struct DeflateWideFullBmi2 { template <typename Rng> static void run(const std::uint8_t *i, std::uint64_t b, std::uint8_t *o, std::uint32_t p, Rng &l) { deflate_wide_full_bmi2<G>(i, b, o, p, l); } };
+#endif
+
+   // the RNG_FULL kernels are the only ones whose inner loop has a single-instruction replacement, so they're
+   // bound per CPU tier. `width` is the modulus for the 8-bit levels and the group width for the wide ones.
+   template <typename Rng>
+   using FullKernel = void (*)(std::uint32_t width, std::uint32_t padding, const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng);
+
+   template <template <std::uint32_t> class Kernel, typename Rng>
+   void run_full(std::uint32_t width, std::uint32_t, const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      dispatch_modulus<Kernel>(width, input, bits, output, rng);
+   }
+
+   template <template <std::uint32_t> class Kernel, typename Rng>
+   void run_wide_full(std::uint32_t width, std::uint32_t padding, const std::uint8_t *input, std::uint64_t bits, std::uint8_t *output, Rng &rng) {
+      dispatch_group<Kernel>(width, input, bits, output, padding, rng);
+   }
+
+#if defined(INFLATE_X86)
+#define INFLATE_FULL_DISPATCH(Rng, generic, bmi2) \
+   CpuDispatch<FullKernel<Rng>>([]() -> FullKernel<Rng> { return (cpu_enabled(CpuFeature::CPU_FEATURE_BMI2)) ? bmi2 : generic; })
+#else
+#define INFLATE_FULL_DISPATCH(Rng, generic, bmi2) CpuDispatch<FullKernel<Rng>>([]() -> FullKernel<Rng> { return generic; })
+#endif
+
+   // one binding per generator, each chosen on its first use.
+   template <typename Rng>
+   CpuDispatch<FullKernel<Rng>> inflate_full = INFLATE_FULL_DISPATCH(Rng, (run_full<InflateFull, Rng>), (run_full<InflateFullBmi2, Rng>));
+   template <typename Rng>
+   CpuDispatch<FullKernel<Rng>> deflate_full = INFLATE_FULL_DISPATCH(Rng, (run_full<DeflateFull, Rng>), (run_full<DeflateFullBmi2, Rng>));
+   template <typename Rng>
+   CpuDispatch<FullKernel<Rng>> inflate_wide_full_dispatch = INFLATE_FULL_DISPATCH(Rng, (run_wide_full<InflateWideFull, Rng>), (run_wide_full<InflateWideFullBmi2, Rng>));
+   template <typename Rng>
+   CpuDispatch<FullKernel<Rng>> deflate_wide_full_dispatch = INFLATE_FULL_DISPATCH(Rng, (run_wide_full<DeflateWideFull, Rng>), (run_wide_full<DeflateWideFullBmi2, Rng>));
+
+   template <typename Rng>
+   void inflate_dense(InflateLevel level,
+                      InflateGeometry geometry,
+                      const std::uint8_t *input,
+                      std::uint64_t deflated_bits,
+                      std::uint8_t *output,
+                      Rng &rng) noexcept
+   {
+      auto modulus = geometry.modulus();
+
+      if (!is_wide_level(level))
+      {
+         switch (level_family(level))
+         {
+         case InflateFamily::INFLATE_FAMILY_FIXED:
+            // an empty stream may come with null buffers, which memcpy doesn't accept even for 0 bytes.
+            if (level != InflateLevel::INFLATE_NOOP)
+               dispatch_modulus<InflateFixed>(modulus, input, deflated_bits, output);
+            else if (deflated_bits != 0)
+               std::memcpy(output, input, deflated_bits / 8 + static_cast<std::uint64_t>(deflated_bits % 8 != 0));
+
+            break;
+
+         case InflateFamily::INFLATE_FAMILY_RNG_PARTIAL:
+            dispatch_modulus<InflatePartial>(modulus, input, deflated_bits, output, rng);
+            break;
+
+         case InflateFamily::INFLATE_FAMILY_RNG_FULL:
+            inflate_full<Rng>(modulus, 0, input, deflated_bits, output, rng);
+            break;
+         }
+
+         return;
+      }
+
+      switch (level_family(level))
+      {
+      case InflateFamily::INFLATE_FAMILY_FIXED:
+         dispatch_group<InflateWideFixed>(geometry.group_bits, input, deflated_bits, output, geometry.padding_bits);
+         break;
+
+      case InflateFamily::INFLATE_FAMILY_RNG_PARTIAL:
+         dispatch_group<InflateWidePartial>(geometry.group_bits, input, deflated_bits, output, geometry.padding_bits, rng);
+         break;
+
+      case InflateFamily::INFLATE_FAMILY_RNG_FULL:
+         inflate_wide_full_dispatch<Rng>(geometry.group_bits, geometry.padding_bits, input, deflated_bits, output, rng);
+         break;
+      }
+   }
+
+   template <typename Rng>
+   void deflate_dense(InflateLevel level,
+                      InflateGeometry geometry,
+                      const std::uint8_t *input,
+                      std::uint64_t deflated_bits,
+                      std::uint8_t *output,
+                      Rng &rng) noexcept
+   {
+      auto modulus = geometry.modulus();
+
+      if (!is_wide_level(level))
+      {
+         switch (level_family(level))
+         {
+         case InflateFamily::INFLATE_FAMILY_FIXED:
+            if (level != InflateLevel::INFLATE_NOOP)
+               dispatch_modulus<DeflateFixed>(modulus, input, deflated_bits, output);
+            else if (deflated_bits != 0)
+               std::memcpy(output, input, deflated_bits / 8 + static_cast<std::uint64_t>(deflated_bits % 8 != 0));
+
+            break;
+
+         case InflateFamily::INFLATE_FAMILY_RNG_PARTIAL:
+            dispatch_modulus<DeflatePartial>(modulus, input, deflated_bits, output, rng);
+            break;
+
+         case InflateFamily::INFLATE_FAMILY_RNG_FULL:
+            deflate_full<Rng>(modulus, 0, input, deflated_bits, output, rng);
+            break;
+         }
+
+         return;
+      }
+
+      switch (level_family(level))
+      {
+      case InflateFamily::INFLATE_FAMILY_FIXED:
+         dispatch_group<DeflateWideFixed>(geometry.group_bits, input, deflated_bits, output, geometry.padding_bits);
+         break;
+
+      case InflateFamily::INFLATE_FAMILY_RNG_PARTIAL:
+         dispatch_group<DeflateWidePartial>(geometry.group_bits, input, deflated_bits, output, geometry.padding_bits, rng);
+         break;
+
+      case InflateFamily::INFLATE_FAMILY_RNG_FULL:
+         deflate_wide_full_dispatch<Rng>(geometry.group_bits, geometry.padding_bits, input, deflated_bits, output, rng);
+         break;
+      }
+   }
+
+   template <typename Rng>
+   using DenseKernel = void (*)(InflateLevel, InflateGeometry, const std::uint8_t *, std::uint64_t, std::uint8_t *, Rng &) noexcept;
+
+   // zero runs are looked for in blocks of this many units, which is a 4 KiB page of output at the 8-bit levels.
+   const std::uint64_t ZERO_BLOCK_UNITS = 512;
+
+   bool is_zero(const std::uint8_t *ptr, std::uint64_t size) noexcept {
+      // dense data nearly always fails on the first word, so the check costs next to nothing there.
+      for (; size >= 8; ptr += 8, size -= 8)
+         if (load_le(ptr, 8) != 0)
+            return false;
+
+      for (; size > 0; ++ptr, --size)
+         if (*ptr != 0)
+            return false;
+
+      return true;
+   }
+
+   constexpr RngEngine engine_of(const ShiftRegister &) noexcept { return RngEngine::RNG_LFSR; }
+   constexpr RngEngine engine_of(const SplitMixRng &) noexcept { return RngEngine::RNG_SPLITMIX; }
+   constexpr RngEngine engine_of(const PhiloxRng &) noexcept { return RngEngine::RNG_PHILOX; }
+
+   /// run `kernel` over the stream, but replace every block of zero units with a memset of the output. with
+   /// zero padding, zero groups map to zero groups in both directions at every level, so the generator
+   /// simply jumps over the run wherever `is_seekable` allows. the LFSR at the RNG_FULL levels draws a
+   /// varying number of shifts, which can only be found by running the groups, so it always takes the kernel.
+   template <typename Rng>
+   void transform_sparse(DenseKernel<Rng> kernel,
+                         bool inflating,
+                         InflateLevel level,
+                         InflateGeometry geometry,
+                         const std::uint8_t *input,
+                         std::uint64_t deflated_bits,
+                         std::uint8_t *output,
+                         Rng &rng) noexcept
+   {
+      auto family = level_family(level);
+
+      if (!is_seekable(family, engine_of(rng)) || level == InflateLevel::INFLATE_NOOP)
+      {
+         kernel(level, geometry, input, deflated_bits, output, rng);
+         return;
+      }
+
+      std::uint64_t modulus = geometry.modulus();
+      auto block_bits = ZERO_BLOCK_UNITS * modulus * 8;
+      auto input_block = ZERO_BLOCK_UNITS * (inflating ? modulus : geometry.group_bits);
+      auto output_block = ZERO_BLOCK_UNITS * (inflating ? geometry.group_bits : modulus);
+      auto blocks = deflated_bits / block_bits;
+
+      // `dense` is the first block not yet handed to the kernel, `zero` the start of the current zero run.
+      std::uint64_t dense = 0;
+      std::uint64_t block = 0;
+
+      while (block < blocks)
+      {
+         if (!is_zero(input+block*input_block, input_block))
+         {
+            ++block;
+            continue;
+         }
+
+         auto zero = block;
+
+         while (block < blocks && is_zero(input+block*input_block, input_block))
+            ++block;
+
+         if (dense < zero)
+            kernel(level, geometry, input+dense*input_block, (zero-dense)*block_bits, output+dense*output_block, rng);
+
+         std::memset(output+zero*output_block, 0, (block-zero)*output_block);
+
+         if (family != InflateFamily::INFLATE_FAMILY_FIXED)
+         {
+            rng.jump((block-zero) * ZERO_BLOCK_UNITS * 8);
+            INFLATE_STATS_ADD(lfsr_steps, (block-zero) * ZERO_BLOCK_UNITS * 8);
+         }
+
+         INFLATE_STATS_ADD(zero_bytes, (block-zero)*output_block);
+         dense = block;
+      }
+
+      kernel(level, geometry, input+dense*input_block, deflated_bits-dense*block_bits, output+dense*output_block, rng);
+   }
+
+   template <typename Kernel>
+   void with_engine(RandomEngine &rng, Kernel &&kernel) noexcept {
+      switch (rng.engine())
+      {
+      case RngEngine::RNG_SPLITMIX: kernel(rng.splitmix()); break;
+      case RngEngine::RNG_PHILOX: kernel(rng.philox()); break;
+      default: kernel(rng.lfsr()); break;
+      }
+   }
+}
+
+InflateStatus inflate::validate_header(const InflateHeader &header, std::uint64_t size) noexcept {
+   if (!is_supported_level(header.level))
+      return InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL;
+
+   std::uint64_t inflated = header.inflated;
+   std::uint64_t deflated = header.deflated;
+
+   if (size != inflated / 8 + static_cast<std::uint64_t>(inflated % 8 != 0))
+      return InflateStatus::STATUS_INSUFFICIENT_SIZE;
+
+   if (deflated > inflated || inflated_bits(static_cast<InflateLevel>(header.level), deflated) != inflated)
+      return InflateStatus::STATUS_BAD_HEADER;
+
+   if (!is_usable_seed(level_family(static_cast<InflateLevel>(header.level)), RngEngine::RNG_LFSR, header.seed))
+      return InflateStatus::STATUS_BAD_HEADER;
+
+   return InflateStatus::STATUS_OK;
+}
+
+InflateStatus inflate::validate_header(const InflateHeaderV2 &header, std::uint64_t size) noexcept {
+   auto geometry = header_geometry(header);
+
+   if (!is_supported_geometry(header.level, geometry))
+      return InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL;
+
+   if (!is_supported_checksum(header.checksum_type))
+      return InflateStatus::STATUS_UNSUPPORTED_CHECKSUM;
+
+   if (!is_supported_rng(header.rng))
+      return InflateStatus::STATUS_UNSUPPORTED_RNG;
+
+   for (auto reserved : header.reserved)
+      if (reserved != 0)
+         return InflateStatus::STATUS_BAD_HEADER;
+
+   if (header.rng != RngEngine::RNG_LFSR && header.version < header_version(static_cast<RngEngine>(header.rng)))
+      return InflateStatus::STATUS_BAD_HEADER;
+
+   if (size != header.inflated / 8 + static_cast<std::uint64_t>(header.inflated % 8 != 0))
+      return InflateStatus::STATUS_INSUFFICIENT_SIZE;
+
+   if (header.deflated > header.inflated || inflated_bits(static_cast<InflateLevel>(header.level), geometry, header.deflated) != header.inflated)
+      return InflateStatus::STATUS_BAD_HEADER;
+
+   if (!is_usable_seed(level_family(static_cast<InflateLevel>(header.level)), static_cast<RngEngine>(header.rng), header.seed))
+      return InflateStatus::STATUS_BAD_HEADER;
+
+   return InflateStatus::STATUS_OK;
+}
+
+void inflate::inflate_kernel(InflateLevel level,
+                             const std::uint8_t *input,
+                             std::uint64_t deflated_bits,
+                             std::uint8_t *output,
+                             ShiftRegister &lfsr) noexcept
+{
+   inflate_kernel(level, level_geometry(level), input, deflated_bits, output, lfsr);
+}
+
+void inflate::deflate_kernel(InflateLevel level,
+                             const std::uint8_t *input,
+                             std::uint64_t deflated_bits,
+                             std::uint8_t *output,
+                             ShiftRegister &lfsr) noexcept
+{
+   deflate_kernel(level, level_geometry(level), input, deflated_bits, output, lfsr);
+}
+
+void inflate::inflate_kernel(InflateLevel level,
+                             InflateGeometry geometry,
+                             const std::uint8_t *input,
+                             std::uint64_t deflated_bits,
+                             std::uint8_t *output,
+                             ShiftRegister &lfsr) noexcept
+{
+   transform_sparse<ShiftRegister>(inflate_dense, true, level, geometry, input, deflated_bits, output, lfsr);
+}
+
+void inflate::deflate_kernel(InflateLevel level,
+                             InflateGeometry geometry,
+                             const std::uint8_t *input,
+                             std::uint64_t deflated_bits,
+                             std::uint8_t *output,
+                             ShiftRegister &lfsr) noexcept
+{
+   transform_sparse<ShiftRegister>(deflate_dense, false, level, geometry, input, deflated_bits, output, lfsr);
+}
+
+void inflate::inflate_kernel(InflateLevel level,
+                             InflateGeometry geometry,
+                             const std::uint8_t *input,
+                             std::uint64_t deflated_bits,
+                             std::uint8_t *output,
+                             RandomEngine &rng) noexcept
+{
+   with_engine(rng, [&](auto &engine) {
+      using Rng = std::remove_reference_t<decltype(engine)>;
+      transform_sparse<Rng>(inflate_dense, true, level, geometry, input, deflated_bits, output, engine);
+   });
+}
+
+void inflate::deflate_kernel(InflateLevel level,
+                             InflateGeometry geometry,
+                             const std::uint8_t *input,
+                             std::uint64_t deflated_bits,
+                             std::uint8_t *output,
+                             RandomEngine &rng) noexcept
+{
+   with_engine(rng, [&](auto &engine) {
+      using Rng = std::remove_reference_t<decltype(engine)>;
+      transform_sparse<Rng>(deflate_dense, false, level, geometry, input, deflated_bits, output, engine);
+   });
+}
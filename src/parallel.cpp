@@ -0,0 +1,353 @@
+#include "internal.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace inflate;
+using namespace inflate::internal;
+
+namespace
+{
+   /// @brief A worker's share of a transform, in units of eight groups: `modulus` deflated bytes and
+   /// `group_bits` inflated bytes.
+   struct Range
+   {
+      std::uint64_t first_unit;
+      std::uint64_t units;
+      bool last;
+   };
+
+   std::vector<std::uint32_t> parse_cpulist(const std::string &list) {
+      std::vector<std::uint32_t> cpus;
+      std::stringstream stream(list);
+      std::string item;
+
+      // the kernel's list format: comma-separated CPUs and inclusive ranges, e.g. "0-3,8,10-11".
+      while (std::getline(stream, item, ','))
+      {
+         if (item.empty() || item[0] < '0' || item[0] > '9')
+            continue;
+
+         auto dash = item.find('-');
+         auto first = static_cast<std::uint32_t>(std::stoul(item.substr(0, dash)));
+         auto last = (dash == std::string::npos) ? first : static_cast<std::uint32_t>(std::stoul(item.substr(dash+1)));
+
+         for (auto cpu=first; cpu<=last; ++cpu)
+            cpus.push_back(cpu);
+      }
+
+      return cpus;
+   }
+
+   bool read_line(const std::string &path, std::string &line) {
+      std::ifstream file(path);
+      return file.is_open() && static_cast<bool>(std::getline(file, line));
+   }
+
+   std::vector<NumaNode> read_topology() {
+      std::vector<NumaNode> nodes;
+
+#if defined(__linux__)
+      std::string online;
+      cpu_set_t allowed;
+
+      CPU_ZERO(&allowed);
+
+      if (read_line("/sys/devices/system/node/online", online) && sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0)
+      {
+         for (auto id : parse_cpulist(online))
+         {
+            std::string cpulist;
+
+            if (!read_line("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist", cpulist))
+               continue;
+
+            // only keep the CPUs this process may run on, so pinning never fails on a restricted cpuset.
+            NumaNode node{id, {}};
+
+            for (auto cpu : parse_cpulist(cpulist))
+               if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                  node.cpus.push_back(cpu);
+
+            if (!node.cpus.empty())
+               nodes.push_back(std::move(node));
+         }
+      }
+#endif
+
+      if (nodes.empty())
+         nodes.push_back(NumaNode{0, {}});
+
+      return nodes;
+   }
+
+   /// @brief Pin the calling thread to the node, before it touches any of its output.
+   void pin_to(const NumaNode &node) {
+#if defined(__linux__)
+      if (node.cpus.empty())
+         return;
+
+      cpu_set_t set;
+      CPU_ZERO(&set);
+
+      for (auto cpu : node.cpus)
+         CPU_SET(cpu, &set);
+
+      // a failure only costs locality, so it isn't reported.
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+#else
+      (void)node;
+#endif
+   }
+
+   std::vector<Range> plan_ranges(InflateLevel level, RngEngine rng, std::uint64_t units, std::uint64_t size, const ParallelOptions &parallel) {
+      std::uint64_t threads = parallel.threads;
+
+      if (threads == 0)
+         threads = std::max<std::uint64_t>(std::thread::hardware_concurrency(), 1);
+
+      // the LFSR at the RNG_FULL levels shifts a varying number of times per group, so there's nothing to jump to.
+      if (!is_seekable(level_family(level), rng))
+         threads = 1;
+
+      threads = std::min(threads, size / std::max<std::uint64_t>(parallel.minimum, 1));
+      threads = std::max<std::uint64_t>(std::min(threads, units), 1);
+
+      std::vector<Range> ranges;
+      auto per_thread = units / threads;
+
+      for (std::uint64_t t=0; t<threads; ++t)
+      {
+         auto first_unit = t * per_thread;
+         auto last = t == threads-1;
+
+         ranges.push_back(Range{first_unit, (last) ? units - first_unit : per_thread, last});
+      }
+
+      return ranges;
+   }
+
+   /// @brief Run `work` once per range, each on its own thread spread evenly over the NUMA nodes in order,
+   /// so consecutive ranges share a node.
+   void run_ranges(const std::vector<Range> &ranges, bool numa, const std::function<void(std::size_t)> &work) {
+      if (ranges.size() == 1)
+      {
+         work(0);
+         return;
+      }
+
+      auto &nodes = numa_nodes();
+      std::vector<std::thread> workers;
+
+      for (std::size_t t=0; t<ranges.size(); ++t)
+      {
+         auto node = (numa && nodes.size() > 1) ? &nodes[t * nodes.size() / ranges.size()] : nullptr;
+
+         workers.emplace_back([&work, node, t]() {
+            if (node != nullptr)
+               pin_to(*node);
+
+            work(t);
+         });
+      }
+
+      for (auto &worker : workers)
+         worker.join();
+   }
+
+   RandomEngine range_engine(InflateLevel level, const InflateHeaderV2 &header, const Range &range) {
+      auto rng = RandomEngine(header);
+
+      // only seekable generators are ever split, and the fixed levels never consult them.
+      if (level_family(level) != InflateFamily::INFLATE_FAMILY_FIXED)
+         rng.jump(range.first_unit * 8);
+
+      return rng;
+   }
+
+   /// @brief Combine the checksums of consecutive ranges, or checksum the whole buffer for XXH64, which
+   /// can't be combined.
+   std::uint64_t combine_checksums(ChecksumType type,
+                                   const std::vector<std::uint32_t> &sums,
+                                   const std::vector<std::uint64_t> &sizes,
+                                   const std::uint8_t *ptr,
+                                   std::uint64_t size)
+   {
+      if (type == ChecksumType::CHECKSUM_XXH64)
+         return xxh64(ptr, size);
+
+      auto result = sums[0];
+
+      for (std::size_t i=1; i<sums.size(); ++i)
+         result = (type == ChecksumType::CHECKSUM_CRC32C)
+            ? crc32c_combine(result, sums[i], sizes[i])
+            : crc32_combine(result, sums[i], sizes[i]);
+
+      return result;
+   }
+
+   std::uint32_t range_checksum(ChecksumType type, const std::uint8_t *ptr, std::uint64_t size) {
+      switch (type)
+      {
+      case ChecksumType::CHECKSUM_CRC32: return crc32(ptr, size);
+      case ChecksumType::CHECKSUM_CRC32C: return crc32c(ptr, size);
+      default: return 0;
+      }
+   }
+}
+
+const std::vector<NumaNode> &inflate::numa_nodes() {
+   static const std::vector<NumaNode> nodes = read_topology();
+   return nodes;
+}
+
+std::uint64_t inflate::inflated_size(const InflateOptions &options, std::uint64_t size) {
+   if (!is_supported_geometry(options.level, options_geometry(options)))
+      throw exception::UnsupportedInflateLevel(options.level);
+
+   return bytes_of(inflated_bits(options.level, options_geometry(options), size*8));
+}
+
+InflateHeaderV2 inflate::inflate_memory_parallel(const void *ptr,
+                                                 std::uint64_t size,
+                                                 std::uint8_t *output,
+                                                 const InflateOptions &options,
+                                                 const ParallelOptions &parallel)
+{
+   INFLATE_STATS_SCOPE("inflate_memory_parallel");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   throw_inflate_status(check_inflate_arguments(ptr, size, options), options);
+
+   auto output_size = inflated_size(options, size);
+
+   if (output == nullptr && output_size != 0)
+      throw exception::NullPointer();
+
+   INFLATE_STATS_ADD(bytes_out, output_size);
+
+   auto header = make_header(options, size, (options.seed.has_value()) ? *options.seed : thread_context().next_seed());
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+   auto geometry = options_geometry(options);
+
+   auto modulus = geometry.modulus();
+   auto ranges = plan_ranges(options.level, options.rng, size / modulus, size, parallel);
+   std::vector<std::uint32_t> sums(ranges.size());
+   std::vector<std::uint64_t> sizes(ranges.size());
+
+   run_ranges(ranges, parallel.numa, [&](std::size_t t) {
+      auto &range = ranges[t];
+      auto input_offset = range.first_unit * modulus;
+      auto input_size = (range.last) ? size - input_offset : range.units * modulus;
+      auto rng = range_engine(options.level, header, range);
+
+      inflate_kernel(options.level,
+                     geometry,
+                     u8_ptr+input_offset,
+                     input_size*8,
+                     output+range.first_unit*geometry.group_bits,
+                     rng);
+
+      sums[t] = range_checksum(options.checksum, u8_ptr+input_offset, input_size);
+      sizes[t] = input_size;
+   });
+
+   header.checksum = combine_checksums(options.checksum, sums, sizes, u8_ptr, size);
+
+   return header;
+}
+
+void inflate::deflate_memory_parallel(const void *ptr,
+                                      std::uint64_t size,
+                                      const InflateHeaderV2 &header,
+                                      std::uint8_t *output,
+                                      bool validate,
+                                      const ParallelOptions &parallel)
+{
+   INFLATE_STATS_SCOPE("deflate_memory_parallel");
+   INFLATE_STATS_ADD(bytes_in, size);
+
+   check_header(header, size);
+
+   auto output_size = bytes_of(header.deflated);
+
+   if ((ptr == nullptr && size != 0) || (output == nullptr && output_size != 0))
+      throw exception::NullPointer();
+
+   INFLATE_STATS_ADD(bytes_out, output_size);
+
+   auto level = static_cast<InflateLevel>(header.level);
+   auto type = static_cast<ChecksumType>(header.checksum_type);
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+   auto geometry = header_geometry(header);
+   auto modulus = geometry.modulus();
+   auto unit_bits = static_cast<std::uint64_t>(modulus) * 8;
+   auto ranges = plan_ranges(level, static_cast<RngEngine>(header.rng), header.deflated / unit_bits, size, parallel);
+   std::vector<std::uint32_t> sums(ranges.size());
+   std::vector<std::uint64_t> sizes(ranges.size());
+
+   run_ranges(ranges, parallel.numa, [&](std::size_t t) {
+      auto &range = ranges[t];
+      auto output_offset = range.first_unit * modulus;
+      auto deflated = (range.last) ? header.deflated - range.first_unit * unit_bits : range.units * unit_bits;
+      auto rng = range_engine(level, header, range);
+
+      deflate_kernel(level,
+                     geometry,
+                     u8_ptr+range.first_unit*geometry.group_bits,
+                     deflated,
+                     output+output_offset,
+                     rng);
+
+      if (validate)
+      {
+         sums[t] = range_checksum(type, output+output_offset, bytes_of(deflated));
+         sizes[t] = bytes_of(deflated);
+      }
+   });
+
+   if (!validate)
+      return;
+
+   auto sum = combine_checksums(type, sums, sizes, output, output_size);
+
+   if (sum != header.checksum)
+      throw exception::BadCRC(sum, header.checksum);
+}
+
+std::pair<LargeBuffer, InflateHeaderV2> inflate::inflate_memory_large(const void *ptr,
+                                                                     std::uint64_t size,
+                                                                     const InflateOptions &options,
+                                                                     const ParallelOptions &parallel,
+                                                                     const LargeBufferOptions &buffer)
+{
+   auto output = LargeBuffer(inflated_size(options, size), buffer);
+   auto header = inflate_memory_parallel(ptr, size, output.data(), options, parallel);
+
+   return std::make_pair(std::move(output), header);
+}
+
+LargeBuffer inflate::deflate_memory_large(const void *ptr,
+                                          std::uint64_t size,
+                                          const InflateHeaderV2 &header,
+                                          bool validate,
+                                          const ParallelOptions &parallel,
+                                          const LargeBufferOptions &buffer)
+{
+   // validate before allocating, since a bad header can claim any size.
+   check_header(header, size);
+
+   auto output = LargeBuffer(bytes_of(header.deflated), buffer);
+   deflate_memory_parallel(ptr, size, header, output.data(), validate, parallel);
+
+   return output;
+}
@@ -0,0 +1,47 @@
+#include <inflate.hpp>
+
+using namespace inflate;
+
+const char *inflate::status_string(InflateStatus status) noexcept {
+   switch (status)
+   {
+   case InflateStatus::STATUS_OK:
+      return "OK";
+
+   case InflateStatus::STATUS_NULL_POINTER:
+      return "Null pointer: An unexpected null pointer was encountered.";
+
+   case InflateStatus::STATUS_INSUFFICIENT_SIZE:
+      return "Insufficient size: the buffer is not the size the header describes.";
+
+   case InflateStatus::STATUS_BAD_HEADER_MAGIC:
+      return "Bad header magic: the magic bytes in the header of the inflate stream were not recognized.";
+
+   case InflateStatus::STATUS_BAD_HEADER:
+      return "Bad header: the sizes in the inflate header are inconsistent with its level.";
+
+   case InflateStatus::STATUS_BAD_CRC:
+      return "Bad CRC: the deflated data does not match the checksum in the header.";
+
+   case InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL:
+      return "Unsupported inflate level: the given level is unsupported.";
+
+   case InflateStatus::STATUS_UNSUPPORTED_CHECKSUM:
+      return "Unsupported checksum: the given checksum type is unsupported.";
+
+   case InflateStatus::STATUS_BAD_ALIGNMENT:
+      return "Bad alignment: the payload alignment must be a power of two no larger than INFLATE_MAX_ALIGNMENT.";
+
+   case InflateStatus::STATUS_UNSUPPORTED_RNG:
+      return "Unsupported RNG: the given random number generator is unsupported.";
+
+   case InflateStatus::STATUS_BAD_SEED:
+      return "Bad seed: the LFSR can't be seeded with 0 at the RNG_FULL levels.";
+
+   case InflateStatus::STATUS_OUT_OF_MEMORY:
+      return "Out of memory: the output buffer could not be allocated.";
+
+   default:
+      return "Error: the operation failed.";
+   }
+}
@@ -0,0 +1,349 @@
+#include <inflate.hpp>
+
+using namespace inflate;
+
+namespace
+{
+   const std::uint64_t SAMPLE_BLOCKS = 16;
+
+   std::vector<InflateLevel> candidate_levels(std::optional<InflateFamily> family) {
+      std::vector<InflateLevel> result = { InflateLevel::INFLATE_NOOP };
+
+      // candidates are ordered by expansion: every family expands n-bit levels by 8/(8-n), so
+      // families only break ties between levels of the same bit count.
+      for (int bits=1; bits<=7; ++bits)
+      {
+         if (!family.has_value() || *family == InflateFamily::INFLATE_FAMILY_FIXED)
+            result.push_back(static_cast<InflateLevel>(InflateLevel::INFLATE_NOOP + bits));
+
+         if (!family.has_value() || *family == InflateFamily::INFLATE_FAMILY_RNG_PARTIAL)
+            result.push_back(static_cast<InflateLevel>(InflateLevel::INFLATE_7BIT + bits));
+
+         if (!family.has_value() || *family == InflateFamily::INFLATE_FAMILY_RNG_FULL)
+            result.push_back(static_cast<InflateLevel>(InflateLevel::INFLATE_RNG_PARTIAL_7BIT + bits));
+      }
+
+      return result;
+   }
+
+   void sample_input(const std::uint8_t *ptr, std::uint64_t size, std::uint64_t sample_size, ByteVec &result) {
+      auto block_size = std::max<std::uint64_t>(sample_size / SAMPLE_BLOCKS, 1);
+      auto stride = size / SAMPLE_BLOCKS;
+
+      result.clear();
+      result.reserve(block_size * SAMPLE_BLOCKS);
+
+      for (std::uint64_t block=0; block<SAMPLE_BLOCKS; ++block)
+      {
+         auto offset = block * stride;
+         auto length = std::min(block_size, size - offset);
+
+         result.insert(result.end(), ptr+offset, ptr+offset+length);
+      }
+   }
+
+   /// candidates are inflated into the context's output buffer. when a level other than `INFLATE_NOOP` wins,
+   /// its header is returned and its output is left in `context.output()`.
+   std::pair<InflateSelection, std::optional<InflateHeader>> evaluate(InflateContext &context,
+                                                                      const std::uint8_t *ptr,
+                                                                      std::uint64_t size,
+                                                                      double max_entropy,
+                                                                      std::optional<InflateFamily> family,
+                                                                      std::uint32_t seed)
+   {
+      InflateSelection selection;
+      selection.sampled_entropy = entropy(ptr, size);
+
+      for (auto level : candidate_levels(family))
+      {
+         selection.level = level;
+
+         if (level == InflateLevel::INFLATE_NOOP)
+         {
+            selection.predicted_entropy = selection.sampled_entropy;
+
+            if (selection.predicted_entropy <= max_entropy)
+               return std::make_pair(selection, std::nullopt);
+
+            continue;
+         }
+
+         auto mem = context.inflate_memory(ptr, size, level, seed);
+         selection.predicted_entropy = entropy(mem.first);
+
+         if (selection.predicted_entropy <= max_entropy)
+            return std::make_pair(selection, std::make_optional(mem.second));
+      }
+
+      throw exception::UnreachableEntropy(max_entropy);
+   }
+}
+
+InflateSelection inflate::select_level(const void *ptr,
+                                       std::uint64_t size,
+                                       double max_entropy,
+                                       std::optional<InflateFamily> family,
+                                       std::optional<std::uint32_t> seed,
+                                       std::uint64_t sample_size)
+{
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   if (!seed.has_value())
+      seed = generate_seed();
+
+   auto &context = thread_context();
+
+   if (size <= sample_size)
+      return evaluate(context, u8_ptr, size, max_entropy, family, *seed).first;
+
+   auto &sample = context.scratch();
+   sample_input(u8_ptr, size, sample_size, sample);
+
+   return evaluate(context, sample.data(), sample.size(), max_entropy, family, *seed).first;
+}
+
+InflateSelection inflate::select_level(const ByteVec &vec,
+                                       double max_entropy,
+                                       std::optional<InflateFamily> family,
+                                       std::optional<std::uint32_t> seed,
+                                       std::uint64_t sample_size)
+{
+   return inflate::select_level(vec.data(), vec.size(), max_entropy, family, seed, sample_size);
+}
+
+std::tuple<ByteVec, InflateHeader, InflateSelection> inflate::inflate_memory_to_entropy(const void *ptr,
+                                                                                        std::uint64_t size,
+                                                                                        double max_entropy,
+                                                                                        std::optional<InflateFamily> family,
+                                                                                        std::optional<std::uint32_t> seed,
+                                                                                        std::uint64_t sample_size)
+{
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   if (!seed.has_value())
+      seed = generate_seed();
+
+   // when the whole input fits in the sample, the winning candidate already is the result.
+   if (size <= sample_size)
+   {
+      auto &context = thread_context();
+      auto evaluation = evaluate(context, u8_ptr, size, max_entropy, family, *seed);
+
+      if (evaluation.second.has_value())
+         return std::make_tuple(context.output(), *evaluation.second, evaluation.first);
+
+      auto mem = inflate_memory(ptr, size, evaluation.first.level, seed);
+
+      return std::make_tuple(std::move(mem.first), mem.second, evaluation.first);
+   }
+
+   auto selection = inflate::select_level(ptr, size, max_entropy, family, seed, sample_size);
+   auto mem = inflate_memory(ptr, size, selection.level, seed);
+
+   return std::make_tuple(std::move(mem.first), mem.second, selection);
+}
+
+std::tuple<ByteVec, InflateHeader, InflateSelection> inflate::inflate_memory_to_entropy(const ByteVec &vec,
+                                                                                        double max_entropy,
+                                                                                        std::optional<InflateFamily> family,
+                                                                                        std::optional<std::uint32_t> seed,
+                                                                                        std::uint64_t sample_size)
+{
+   return inflate::inflate_memory_to_entropy(vec.data(), vec.size(), max_entropy, family, seed, sample_size);
+}
+
+std::tuple<ByteVec, InflateRegionHeader, std::vector<InflateRegion>> inflate::inflate_regions_memory(const void *ptr,
+                                                                                                     std::uint64_t size,
+                                                                                                     double max_entropy,
+                                                                                                     std::uint64_t region_size,
+                                                                                                     std::optional<InflateFamily> family,
+                                                                                                     std::optional<std::uint32_t> seed)
+{
+   if (region_size == 0)
+      throw exception::InsufficientSize(region_size, 1);
+
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   if (!seed.has_value())
+      seed = generate_seed();
+
+   InflateRegionHeader header;
+   header.region_size = region_size;
+   header.regions = size / region_size + static_cast<std::uint64_t>(size % region_size != 0);
+   header.deflated = size * 8;
+   header.checksum = crc32(ptr, size);
+   header.seed = *seed;
+
+   auto &context = thread_context();
+   std::vector<InflateRegion> regions;
+   ByteVec inflated;
+
+   regions.reserve(header.regions);
+
+   for (std::uint64_t offset=0; offset<size; offset+=region_size)
+   {
+      auto length = std::min(region_size, size - offset);
+      auto evaluation = evaluate(context, u8_ptr+offset, length, max_entropy, family, *seed);
+      InflateRegion region;
+
+      std::memset(&region, 0, sizeof(InflateRegion));
+      region.level = evaluation.first.level;
+
+      if (evaluation.second.has_value())
+      {
+         region.inflated = evaluation.second->inflated;
+         inflated.insert(inflated.end(), context.output().begin(), context.output().end());
+      }
+      else
+      {
+         region.inflated = length * 8;
+         inflated.insert(inflated.end(), u8_ptr+offset, u8_ptr+offset+length);
+      }
+
+      regions.push_back(region);
+   }
+
+   return std::make_tuple(std::move(inflated), header, std::move(regions));
+}
+
+std::tuple<ByteVec, InflateRegionHeader, std::vector<InflateRegion>> inflate::inflate_regions_memory(const ByteVec &vec,
+                                                                                                     double max_entropy,
+                                                                                                     std::uint64_t region_size,
+                                                                                                     std::optional<InflateFamily> family,
+                                                                                                     std::optional<std::uint32_t> seed)
+{
+   return inflate::inflate_regions_memory(vec.data(), vec.size(), max_entropy, region_size, family, seed);
+}
+
+ByteVec inflate::deflate_regions_memory(const void *ptr,
+                                        std::uint64_t size,
+                                        const InflateRegionHeader &header,
+                                        const std::vector<InflateRegion> &regions,
+                                        bool validate)
+{
+   auto deflated_bytes = header.deflated / 8;
+
+   if (header.region_size == 0)
+      throw exception::InsufficientSize(header.region_size, 1);
+
+   auto expected_regions = deflated_bytes / header.region_size + static_cast<std::uint64_t>(deflated_bytes % header.region_size != 0);
+
+   if (header.regions != expected_regions || regions.size() != expected_regions)
+      throw exception::InsufficientSize(regions.size(), expected_regions);
+
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+   std::uint64_t inflate_offset = 0;
+   ByteVec result;
+
+   result.reserve(deflated_bytes);
+
+   for (std::uint64_t i=0; i<regions.size(); ++i)
+   {
+      auto inflated_bytes = regions[i].inflated / 8 + static_cast<std::uint64_t>(regions[i].inflated % 8 != 0);
+
+      if (inflated_bytes > size - inflate_offset)
+         throw exception::InsufficientSize(size - inflate_offset, inflated_bytes);
+
+      InflateHeader region_header;
+      region_header.level = regions[i].level;
+      region_header.inflated = regions[i].inflated;
+      region_header.deflated = std::min(header.region_size, deflated_bytes - i * header.region_size) * 8;
+      region_header.checksum = 0;
+      region_header.seed = header.seed;
+
+      auto deflated = deflate_memory(u8_ptr+inflate_offset, inflated_bytes, region_header, false);
+      result.insert(result.end(), deflated.begin(), deflated.end());
+      inflate_offset += inflated_bytes;
+   }
+
+   if (inflate_offset != size)
+      throw exception::InsufficientSize(size, inflate_offset);
+
+   if (validate)
+   {
+      auto crc = crc32(result);
+
+      if (crc != header.checksum)
+         throw exception::BadCRC(crc, header.checksum);
+   }
+
+   return result;
+}
+
+ByteVec inflate::deflate_regions_memory(const ByteVec &vec,
+                                        const InflateRegionHeader &header,
+                                        const std::vector<InflateRegion> &regions,
+                                        bool validate)
+{
+   return inflate::deflate_regions_memory(vec.data(), vec.size(), header, regions, validate);
+}
+
+ByteVec inflate::inflate_regions_disk(const void *ptr,
+                                      std::uint64_t size,
+                                      double max_entropy,
+                                      std::uint64_t region_size,
+                                      std::optional<InflateFamily> family,
+                                      std::optional<std::uint32_t> seed)
+{
+   auto mem = inflate::inflate_regions_memory(ptr, size, max_entropy, region_size, family, seed);
+   auto &header = std::get<1>(mem);
+   auto &regions = std::get<2>(mem);
+   auto magic = INFLATE_REGION_MAGIC;
+   ByteVec inflate_vec;
+
+   inflate_vec.reserve(std::strlen(magic) + sizeof(InflateRegionHeader) + regions.size() * sizeof(InflateRegion) + std::get<0>(mem).size());
+   inflate_vec.insert(inflate_vec.end(),
+                      magic,
+                      magic+std::strlen(magic));
+   inflate_vec.insert(inflate_vec.end(),
+                      reinterpret_cast<std::uint8_t *>(&header),
+                      reinterpret_cast<std::uint8_t *>(&header)+sizeof(InflateRegionHeader));
+   inflate_vec.insert(inflate_vec.end(),
+                      reinterpret_cast<std::uint8_t *>(regions.data()),
+                      reinterpret_cast<std::uint8_t *>(regions.data())+regions.size()*sizeof(InflateRegion));
+   inflate_vec.insert(inflate_vec.end(),
+                      std::get<0>(mem).begin(),
+                      std::get<0>(mem).end());
+
+   return inflate_vec;
+}
+
+ByteVec inflate::inflate_regions_disk(const ByteVec &vec,
+                                      double max_entropy,
+                                      std::uint64_t region_size,
+                                      std::optional<InflateFamily> family,
+                                      std::optional<std::uint32_t> seed)
+{
+   return inflate::inflate_regions_disk(vec.data(), vec.size(), max_entropy, region_size, family, seed);
+}
+
+ByteVec inflate::deflate_regions_disk(const void *ptr, std::uint64_t size) {
+   auto magic_size = std::strlen(INFLATE_REGION_MAGIC);
+
+   if (size < magic_size+sizeof(InflateRegionHeader))
+      throw exception::InsufficientSize(size, magic_size+sizeof(InflateRegionHeader));
+
+   if (std::memcmp(ptr, INFLATE_REGION_MAGIC, magic_size) != 0)
+      throw exception::BadHeaderMagic();
+
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+   InflateRegionHeader header;
+   std::memcpy(&header, u8_ptr+magic_size, sizeof(InflateRegionHeader));
+
+   auto table_offset = magic_size + sizeof(InflateRegionHeader);
+   auto max_regions = (size - table_offset) / sizeof(InflateRegion);
+
+   if (header.regions > max_regions)
+      throw exception::InsufficientSize(max_regions, header.regions);
+
+   std::vector<InflateRegion> regions(header.regions);
+   std::memcpy(regions.data(), u8_ptr+table_offset, regions.size()*sizeof(InflateRegion));
+
+   auto payload_offset = table_offset + regions.size()*sizeof(InflateRegion);
+
+   return inflate::deflate_regions_memory(u8_ptr+payload_offset, size-payload_offset, header, regions);
+}
+
+ByteVec inflate::deflate_regions_disk(const ByteVec &vec) {
+   return inflate::deflate_regions_disk(vec.data(), vec.size());
+}
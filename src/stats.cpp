@@ -0,0 +1,53 @@
+#include <inflate.hpp>
+
+#include <mutex>
+
+using namespace inflate;
+
+namespace
+{
+   thread_local InflateStats current_stats = {};
+   thread_local InflateStats completed_stats = {};
+   thread_local std::size_t scope_depth = 0;
+
+   std::mutex callback_mutex;
+   StatsCallback callback;
+}
+
+bool inflate::stats_enabled() {
+#if defined(INFLATE_STATS)
+   return true;
+#else
+   return false;
+#endif
+}
+
+InflateStats inflate::last_stats() { return completed_stats; }
+
+void inflate::set_stats_callback(StatsCallback new_callback) {
+   std::lock_guard<std::mutex> lock(callback_mutex);
+   callback = new_callback;
+}
+
+InflateStats &inflate::stats::current() { return current_stats; }
+
+inflate::stats::Scope::Scope(const char *operation) : _operation(operation) {
+   if (scope_depth++ == 0)
+      current_stats = InflateStats();
+}
+
+inflate::stats::Scope::~Scope() {
+   if (--scope_depth != 0)
+      return;
+
+   completed_stats = current_stats;
+
+   StatsCallback active;
+   {
+      std::lock_guard<std::mutex> lock(callback_mutex);
+      active = callback;
+   }
+
+   if (active)
+      active(this->_operation, completed_stats);
+}
@@ -0,0 +1,288 @@
+#include "internal.hpp"
+
+#include <algorithm>
+
+using namespace inflate;
+using namespace inflate::internal;
+
+namespace
+{
+   const std::size_t MAGIC_SIZE = 4;
+
+   bool write_all(std::streambuf *sink, const void *ptr, std::size_t size) {
+      return sink->sputn(reinterpret_cast<const char *>(ptr), size) == static_cast<std::streamsize>(size);
+   }
+
+   bool read_all(std::streambuf *source, void *ptr, std::size_t size) {
+      return source->sgetn(reinterpret_cast<char *>(ptr), size) == static_cast<std::streamsize>(size);
+   }
+
+   std::uint64_t update_checksum(std::uint8_t type, std::uint64_t sum, const std::uint8_t *ptr, std::size_t size) {
+      if (type == ChecksumType::CHECKSUM_CRC32C)
+         return crc32c(ptr, size, static_cast<std::uint32_t>(sum));
+
+      return crc32(ptr, size, static_cast<std::uint32_t>(sum));
+   }
+}
+
+inflate::InflateStreambuf::InflateStreambuf(std::streambuf *sink, InflateLevel level, std::optional<std::uint32_t> seed)
+   : _sink(sink),
+     _level(level),
+     _status(InflateStatus::STATUS_OK),
+     _closed(false)
+{
+   if (sink == nullptr)
+      throw exception::NullPointer();
+
+   if (!is_supported_level(level))
+      throw exception::UnsupportedInflateLevel(level);
+
+   if (!seed.has_value())
+      seed = generate_seed();
+
+   if (!is_usable_seed(level_family(level), RngEngine::RNG_LFSR, *seed))
+      throw exception::BadSeed(*seed);
+
+   this->_lfsr = ShiftRegister(*seed);
+
+   std::memset(&this->_header, 0, sizeof(InflateHeader));
+   this->_header.level = level;
+   this->_header.seed = *seed;
+
+   // a chunk of whole 8-group blocks keeps every kernel call but the last byte-aligned on both sides.
+   auto modulus = level_modulus(level);
+   this->_input.resize(modulus * INFLATE_STREAM_BLOCKS);
+   this->_output.resize(8 * INFLATE_STREAM_BLOCKS);
+   this->setp(reinterpret_cast<char *>(this->_input.data()), reinterpret_cast<char *>(this->_input.data()+this->_input.size()));
+
+   // the placeholder is all zeroes, which no reader accepts if the stream is never closed.
+   this->_header_position = sink->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+
+   std::uint8_t placeholder[MAGIC_SIZE+sizeof(InflateHeader)] = {};
+
+   if (this->_header_position == std::streampos(-1) || !write_all(sink, placeholder, sizeof(placeholder)))
+      this->_status = InflateStatus::STATUS_ERROR;
+}
+
+inflate::InflateStreambuf::~InflateStreambuf() {
+   this->close();
+}
+
+bool inflate::InflateStreambuf::flush_input(bool final) {
+   if (this->_status != InflateStatus::STATUS_OK)
+      return false;
+
+   auto input = reinterpret_cast<std::uint8_t *>(this->pbase());
+   auto size = static_cast<std::uint64_t>(this->pptr() - this->pbase());
+
+   // a partial chunk can only be transformed at the end of the stream.
+   if (size == 0 || (!final && size != this->_input.size()))
+      return true;
+
+   auto inflated = bytes_of(inflated_bits(this->_level, size*8));
+
+   inflate_kernel(this->_level, input, size*8, this->_output.data(), this->_lfsr);
+   this->_header.checksum = crc32(input, size, this->_header.checksum);
+   this->_header.deflated += size*8;
+   this->_header.inflated += inflated_bits(this->_level, size*8);
+
+   this->setp(this->pbase(), this->epptr());
+
+   if (!write_all(this->_sink, this->_output.data(), inflated))
+   {
+      this->_status = InflateStatus::STATUS_ERROR;
+      return false;
+   }
+
+   return true;
+}
+
+InflateStreambuf::int_type inflate::InflateStreambuf::overflow(int_type ch) {
+   if (this->_closed || !this->flush_input(false))
+      return traits_type::eof();
+
+   if (traits_type::eq_int_type(ch, traits_type::eof()))
+      return traits_type::not_eof(ch);
+
+   *this->pptr() = traits_type::to_char_type(ch);
+   this->pbump(1);
+
+   return ch;
+}
+
+int inflate::InflateStreambuf::sync() {
+   // only whole chunks can be written ahead of close(), and overflow already writes those as they fill.
+   if (this->_status != InflateStatus::STATUS_OK)
+      return -1;
+
+   return this->_sink->pubsync();
+}
+
+InflateStatus inflate::InflateStreambuf::close() {
+   if (this->_closed)
+      return this->_status;
+
+   this->_closed = true;
+
+   if (!this->flush_input(true))
+      return this->_status;
+
+   auto end = this->_sink->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+
+   if (end == std::streampos(-1)
+       || this->_sink->pubseekpos(this->_header_position, std::ios_base::out) != this->_header_position
+       || !write_all(this->_sink, INFLATE_MAGIC, MAGIC_SIZE)
+       || !write_all(this->_sink, &this->_header, sizeof(InflateHeader))
+       || this->_sink->pubseekpos(end, std::ios_base::out) != end)
+   {
+      this->_status = InflateStatus::STATUS_ERROR;
+      return this->_status;
+   }
+
+   if (this->_sink->pubsync() != 0)
+      this->_status = InflateStatus::STATUS_ERROR;
+
+   return this->_status;
+}
+
+inflate::DeflateStreambuf::DeflateStreambuf(std::streambuf *source, bool validate)
+   : _source(source),
+     _validate(validate),
+     _header_read(false),
+     _remaining(0),
+     _sum(0),
+     _status(InflateStatus::STATUS_OK)
+{
+   if (source == nullptr)
+      throw exception::NullPointer();
+
+   std::memset(&this->_header, 0, sizeof(InflateHeaderV2));
+   this->setg(nullptr, nullptr, nullptr);
+}
+
+bool inflate::DeflateStreambuf::read_header() {
+   if (this->_header_read)
+      return this->_status == InflateStatus::STATUS_OK;
+
+   this->_header_read = true;
+
+   char magic[MAGIC_SIZE];
+
+   if (!read_all(this->_source, magic, MAGIC_SIZE))
+   {
+      this->_status = InflateStatus::STATUS_INSUFFICIENT_SIZE;
+      return false;
+   }
+
+   if (std::memcmp(magic, INFLATE_VERSIONED_MAGIC, MAGIC_SIZE) == 0)
+   {
+      if (!read_all(this->_source, &this->_header, sizeof(InflateHeaderV2)))
+      {
+         this->_status = InflateStatus::STATUS_INSUFFICIENT_SIZE;
+         return false;
+      }
+
+      if (this->_header.version < INFLATE_MIN_HEADER_VERSION || this->_header.header_size < sizeof(InflateHeaderV2))
+      {
+         this->_status = InflateStatus::STATUS_BAD_HEADER;
+         return false;
+      }
+
+      // skip fields appended by later header versions.
+      for (auto extra=this->_header.header_size-sizeof(InflateHeaderV2); extra > 0; --extra)
+      {
+         if (traits_type::eq_int_type(this->_source->sbumpc(), traits_type::eof()))
+         {
+            this->_status = InflateStatus::STATUS_INSUFFICIENT_SIZE;
+            return false;
+         }
+      }
+   }
+   else if (std::memcmp(magic, INFLATE_MAGIC, MAGIC_SIZE) == 0)
+   {
+      InflateHeader legacy;
+
+      if (!read_all(this->_source, &legacy, sizeof(InflateHeader)))
+      {
+         this->_status = InflateStatus::STATUS_INSUFFICIENT_SIZE;
+         return false;
+      }
+
+      this->_header.version = header_version(RngEngine::RNG_LFSR);
+      this->_header.header_size = sizeof(InflateHeaderV2);
+      this->_header.level = legacy.level;
+      this->_header.checksum_type = ChecksumType::CHECKSUM_CRC32;
+      this->_header.seed = legacy.seed;
+      this->_header.inflated = legacy.inflated;
+      this->_header.deflated = legacy.deflated;
+      this->_header.checksum = legacy.checksum;
+   }
+   else
+   {
+      this->_status = InflateStatus::STATUS_BAD_HEADER_MAGIC;
+      return false;
+   }
+
+   this->_status = validate_header(this->_header, bytes_of(this->_header.inflated));
+
+   if (this->_status == InflateStatus::STATUS_OK && this->_validate && this->_header.checksum_type == ChecksumType::CHECKSUM_XXH64)
+      this->_status = InflateStatus::STATUS_UNSUPPORTED_CHECKSUM;
+
+   if (this->_status != InflateStatus::STATUS_OK)
+      return false;
+
+   // eight groups are `modulus` deflated bytes and `group_bits` inflated bytes.
+   auto geometry = header_geometry(this->_header);
+
+   this->_rng = RandomEngine(this->_header);
+   this->_remaining = this->_header.deflated;
+   this->_input.resize(geometry.group_bits * INFLATE_STREAM_BLOCKS);
+   this->_output.resize(geometry.modulus() * INFLATE_STREAM_BLOCKS);
+
+   return true;
+}
+
+const InflateHeaderV2 &inflate::DeflateStreambuf::header() {
+   this->read_header();
+   return this->_header;
+}
+
+DeflateStreambuf::int_type inflate::DeflateStreambuf::underflow() {
+   if (this->gptr() < this->egptr())
+      return traits_type::to_int_type(*this->gptr());
+
+   if (!this->read_header() || this->_remaining == 0)
+      return traits_type::eof();
+
+   auto level = static_cast<InflateLevel>(this->_header.level);
+   auto geometry = header_geometry(this->_header);
+   auto chunk_bits = static_cast<std::uint64_t>(this->_output.size()) * 8;
+   auto deflated_bits = std::min(this->_remaining, chunk_bits);
+   auto inflated = bytes_of(inflated_bits(level, geometry, deflated_bits));
+   auto deflated = bytes_of(deflated_bits);
+
+   if (!read_all(this->_source, this->_input.data(), inflated))
+   {
+      this->_status = InflateStatus::STATUS_INSUFFICIENT_SIZE;
+      return traits_type::eof();
+   }
+
+   deflate_kernel(level, geometry, this->_input.data(), deflated_bits, this->_output.data(), this->_rng);
+   this->_remaining -= deflated_bits;
+
+   if (this->_validate)
+   {
+      this->_sum = update_checksum(this->_header.checksum_type, this->_sum, this->_output.data(), deflated);
+
+      if (this->_remaining == 0 && this->_sum != this->_header.checksum)
+      {
+         this->_status = InflateStatus::STATUS_BAD_CRC;
+         return traits_type::eof();
+      }
+   }
+
+   auto begin = reinterpret_cast<char *>(this->_output.data());
+   this->setg(begin, begin, begin+deflated);
+
+   return traits_type::to_int_type(*this->gptr());
+}
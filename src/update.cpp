@@ -0,0 +1,194 @@
+#include "internal.hpp"
+
+#include <algorithm>
+
+using namespace inflate;
+using namespace inflate::internal;
+
+namespace
+{
+   /// @brief Bring `lfsr`, at the start of unit `from`, to the start of unit `to` by deflating the units in
+   /// between into scratch space. The RNG_FULL levels have no shortcut: only the groups themselves know how
+   /// many shifts they draw.
+   void replay_units(InflateLevel level,
+                     InflateGeometry geometry,
+                     const std::uint8_t *inflated,
+                     std::uint64_t from,
+                     std::uint64_t to,
+                     ShiftRegister &lfsr)
+   {
+      const std::uint64_t chunk = INFLATE_CHECKPOINT_INTERVAL;
+      ByteVec scratch(std::min(chunk, to - from) * geometry.modulus());
+
+      for (auto unit=from; unit<to; unit+=chunk)
+      {
+         auto units = std::min(chunk, to - unit);
+         deflate_kernel(level, geometry, inflated+unit*geometry.group_bits, units*geometry.modulus()*8, scratch.data(), lfsr);
+      }
+   }
+}
+
+InflateCheckpoints inflate::inflate_checkpoints(const void *ptr, std::uint64_t size, const InflateHeaderV2 &header, std::uint64_t interval) {
+   INFLATE_STATS_SCOPE("inflate_checkpoints");
+
+   check_header(header, size);
+
+   if (ptr == nullptr && size != 0)
+      throw exception::NullPointer();
+
+   if (interval == 0)
+      interval = INFLATE_CHECKPOINT_INTERVAL;
+
+   auto level = static_cast<InflateLevel>(header.level);
+   auto geometry = header_geometry(header);
+   auto unit_bits = static_cast<std::uint64_t>(geometry.modulus()) * 8;
+   auto units = header.deflated / unit_bits + static_cast<std::uint64_t>(header.deflated % unit_bits != 0);
+   auto u8_ptr = reinterpret_cast<const std::uint8_t *>(ptr);
+
+   InflateCheckpoints checkpoints;
+   checkpoints.interval = interval;
+   checkpoints.states.push_back(header.seed);
+
+   // every other stream reaches any unit directly, so the seed alone will do.
+   if (is_seekable(level_family(level), static_cast<RngEngine>(header.rng)))
+      return checkpoints;
+
+   ShiftRegister lfsr(header.seed);
+
+   // only checkpoints with a unit after them are worth keeping, so the last, possibly partial, unit is
+   // never deflated here.
+   for (std::uint64_t unit=interval; unit<units; unit+=interval)
+   {
+      replay_units(level, geometry, u8_ptr, unit-interval, unit, lfsr);
+      checkpoints.states.push_back(lfsr.state());
+   }
+
+   return checkpoints;
+}
+
+InflateCheckpoints inflate::inflate_checkpoints(const ByteVec &vec, const InflateHeaderV2 &header, std::uint64_t interval) {
+   return inflate_checkpoints(vec.data(), vec.size(), header, interval);
+}
+
+void inflate::update_memory(std::uint8_t *inflated,
+                            std::uint64_t size,
+                            InflateHeaderV2 &header,
+                            std::uint64_t offset,
+                            const void *ptr,
+                            std::uint64_t length,
+                            const InflateCheckpoints *checkpoints)
+{
+   INFLATE_STATS_SCOPE("update_memory");
+
+   check_header(header, size);
+
+   if ((inflated == nullptr && size != 0) || (ptr == nullptr && length != 0))
+      throw exception::NullPointer();
+
+   if (header.deflated % 8 != 0)
+      throw exception::OutOfBounds(header.deflated, header.deflated / 8 * 8);
+
+   auto deflated_size = header.deflated / 8;
+
+   if (offset > deflated_size || length > deflated_size - offset)
+      throw exception::OutOfBounds(offset+length, deflated_size);
+
+   if (length == 0)
+      return;
+
+   INFLATE_STATS_ADD(bytes_in, length);
+
+   auto level = static_cast<InflateLevel>(header.level);
+   auto geometry = header_geometry(header);
+   std::uint64_t modulus = geometry.modulus();
+
+   // a unit of eight groups is `modulus` deflated bytes, so the edit's bytes name its units directly.
+   auto first_unit = offset / modulus;
+   auto last_unit = (offset + length - 1) / modulus;
+   auto piece_offset = first_unit * modulus;
+   auto piece_size = std::min((last_unit + 1) * modulus, deflated_size) - piece_offset;
+   auto output = inflated + first_unit * geometry.group_bits;
+
+   RandomEngine rng(header);
+   auto family = level_family(level);
+
+   if (!is_seekable(family, rng.engine()))
+   {
+      auto &lfsr = rng.lfsr();
+      std::uint64_t start = 0;
+
+      if (checkpoints != nullptr)
+      {
+         if (checkpoints->interval == 0 || checkpoints->states.empty() || checkpoints->states[0] != header.seed)
+            throw exception::BadCheckpoints();
+
+         auto index = std::min<std::uint64_t>(first_unit / checkpoints->interval, checkpoints->states.size() - 1);
+         start = index * checkpoints->interval;
+         lfsr.restore(checkpoints->states[index]);
+      }
+
+      replay_units(level, geometry, inflated, start, first_unit, lfsr);
+   }
+   else if (family != InflateFamily::INFLATE_FAMILY_FIXED)
+   {
+      rng.jump(first_unit * 8);
+   }
+
+   ByteVec piece(piece_size);
+   auto piece_rng = rng;
+
+   {
+      INFLATE_STATS_TIMER(transform_ns);
+      deflate_kernel(level, geometry, output, piece_size*8, piece.data(), rng);
+   }
+
+   auto window = piece.data() + (offset - piece_offset);
+   auto type = static_cast<ChecksumType>(header.checksum_type);
+
+   // the CRC of the edited stream differs from the old one by the CRC of the xor of the two windows, carried
+   // through the bytes after the window. Equal-length CRCs xor to exactly that, whatever the init and final xor.
+   if (type == ChecksumType::CHECKSUM_CRC32 || type == ChecksumType::CHECKSUM_CRC32C)
+   {
+      INFLATE_STATS_TIMER(checksum_ns);
+
+      auto suffix = deflated_size - offset - length;
+      auto old_sum = checksum(type, window, length);
+      auto new_sum = checksum(type, ptr, length);
+      auto delta = static_cast<std::uint32_t>(old_sum ^ new_sum);
+      auto carried = (type == ChecksumType::CHECKSUM_CRC32) ? crc32_combine(delta, 0, suffix) : crc32c_combine(delta, 0, suffix);
+
+      header.checksum = static_cast<std::uint32_t>(header.checksum) ^ carried;
+   }
+
+   std::memcpy(window, ptr, length);
+
+   {
+      INFLATE_STATS_TIMER(transform_ns);
+      inflate_kernel(level, geometry, piece.data(), piece_size*8, output, piece_rng);
+   }
+
+   INFLATE_STATS_ADD(bytes_out, bytes_of(inflated_bits(level, geometry, piece_size*8)));
+
+   if (type == ChecksumType::CHECKSUM_XXH64)
+   {
+      ByteVec deflated(deflated_size);
+      RandomEngine full_rng(header);
+
+      {
+         INFLATE_STATS_TIMER(transform_ns);
+         deflate_kernel(level, geometry, inflated, header.deflated, deflated.data(), full_rng);
+      }
+
+      INFLATE_STATS_TIMER(checksum_ns);
+      header.checksum = xxh64(deflated.data(), deflated.size());
+   }
+}
+
+void inflate::update_memory(ByteVec &inflated,
+                            InflateHeaderV2 &header,
+                            std::uint64_t offset,
+                            const ByteVec &bytes,
+                            const InflateCheckpoints *checkpoints)
+{
+   update_memory(inflated.data(), inflated.size(), header, offset, bytes.data(), bytes.size(), checkpoints);
+}
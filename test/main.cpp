@@ -1,8 +1,12 @@
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
-#include <map>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 #include <framework.hpp>
 #include <inflate.hpp>
@@ -48,29 +52,135 @@ test_bitstream()
    ASSERT(*reinterpret_cast<const std::uint32_t *>(stream.data()) == 0xADAB1DC0);
    ASSERT(*reinterpret_cast<const std::uint16_t *>(stream.data()+4) == 0xEA1D);
 
+   auto moved_data = stream.data();
+   auto moved_size = stream.bit_size();
+   auto moved = std::move(stream);
+   ASSERT(moved.data() == moved_data && moved.bit_size() == moved_size);
+   ASSERT(stream.bit_size() == 0);
+
+   stream = std::move(moved);
+   ASSERT(stream.data() == moved_data && moved.bit_size() == 0);
+
+   BitstreamVec appended;
+   std::set<const std::uint8_t *> buffers;
+
+   for (std::uint64_t i=0; i<100000; ++i)
+   {
+      appended.push_bit(i % 3 == 0);
+      buffers.insert(appended.data());
+   }
+
+   ASSERT(appended.capacity() >= appended.bit_size());
+   ASSERT(buffers.size() < 32);
+   ASSERT(appended[99999] && !appended[99998]);
+
+   appended.resize(5);
+   appended.resize(16);
+   ASSERT(appended.data()[1] == 0 && appended.data()[0] == 0x09);
+
+   auto reserved_size = appended.bit_size();
+   appended.reserve(1000000);
+   ASSERT(appended.capacity() >= 1000000 && appended.bit_size() == reserved_size && appended.data()[0] == 0x09);
+
+   ByteVec pattern(301);
+
+   for (std::size_t i=0; i<pattern.size(); ++i)
+      pattern[i] = static_cast<std::uint8_t>((i * 73) ^ (i >> 2));
+
+   auto bits = BitstreamVec(pattern, pattern.size()*8 - 3);
+   auto reference_bits = bits.to_bitvec();
+   ASSERT(reference_bits.size() == bits.bit_size());
+   auto pattern_bits = to_bitvec(pattern);
+   ASSERT(reference_bits == BitVec(pattern_bits.begin(), pattern_bits.begin()+bits.bit_size()));
+
+   auto first = bits.cbegin() + 13;
+   auto last = bits.cend() - 5;
+   ASSERT(last - first == static_cast<std::ptrdiff_t>(bits.bit_size()) - 18);
+   ASSERT(first[4] == reference_bits[17] && first < last && 2 + first == first + 2);
+   ASSERT(std::distance(bits.cbegin(), bits.cend()) == static_cast<std::ptrdiff_t>(bits.bit_size()));
+
+   using std::count;
+   using std::find;
+   using std::copy;
+   using std::equal;
+
+   ASSERT(count(first, last, true) == std::count(reference_bits.begin()+13, reference_bits.end()-5, true));
+   ASSERT(count(first, last, false) == std::count(reference_bits.begin()+13, reference_bits.end()-5, false));
+
+   auto zeros = BitstreamVec(1000);
+   ASSERT(find(zeros.cbegin(), zeros.cend(), true) == zeros.cend());
+   zeros[777] = true;
+   ASSERT(find(zeros.cbegin()+3, zeros.cend(), true).index() == 777);
+   ASSERT(find(zeros.begin(), zeros.end(), false).index() == 0);
+
+   fill(zeros.begin()+5, zeros.begin()+301, true);
+   ASSERT(count(zeros.cbegin(), zeros.cend(), true) == 297);
+   ASSERT(!zeros[4] && zeros[5] && zeros[300] && !zeros[301]);
+
+   auto target = BitstreamVec(bits.bit_size() + 50);
+   auto copied_end = copy(first, last, target.begin()+7);
+   ASSERT(copied_end.index() == 7 + static_cast<std::uint64_t>(last - first));
+   ASSERT(equal(first, last, target.cbegin()+7));
+   ASSERT(!equal(first, last, target.cbegin()+8));
+   ASSERT(std::equal(first, last, reference_bits.begin()+13));
+
+   auto aligned = BitstreamVec(bits.bit_size());
+   copy(bits.cbegin(), bits.cend(), aligned.begin());
+   ASSERT(aligned == bits);
+
+   ASSERT_THROWS(count(bits.cbegin(), bits.cend()+1, true), exception::OutOfBounds);
+   ASSERT_THROWS(copy(first, last, target.end()-3), exception::OutOfBounds);
+
    COMPLETE();
 }
 
-double entropy(const std::uint8_t *ptr, std::size_t size)
+int
+test_entropy()
 {
-   std::map<std::uint8_t,std::size_t> occurrences;
+   INIT();
 
-   for (std::size_t i=0; i<size; ++i)
-      ++occurrences[ptr[i]];
+   ByteVec uniform;
 
-   double result = 0.0;
+   for (std::size_t i=0; i<256*64; ++i)
+      uniform.push_back(static_cast<std::uint8_t>(i));
 
-   for (auto entry : occurrences)
-   {
-      auto weight = entry.second;
-      auto p_x = static_cast<double>(weight) / size;
+   ASSERT(histogram(uniform)[0x41] == 64);
 
-      if (p_x == 0) { continue; }
+   ByteVec large(1024*1024*4);
 
-      result -= p_x * std::log2(p_x);
-   }
+   for (std::size_t i=0; i<large.size(); ++i)
+      large[i] = static_cast<std::uint8_t>((i * 7) ^ (i >> 11));
+
+   ASSERT(histogram(large, 4) == histogram(large));
+   ASSERT(std::abs(entropy(uniform) - 8.0) < 1e-9);
+   ASSERT(entropy(ByteVec(1024, 0x41)) == 0.0);
+   ASSERT(entropy(ByteVec()) == 0.0);
+
+   ByteVec halves(512, 0);
+   std::fill(halves.begin()+256, halves.end(), 0xFF);
+   ASSERT(std::abs(entropy(halves) - 1.0) < 1e-9);
+
+   std::srand(std::time(nullptr));
+   ByteVec random_bytes;
+
+   for (std::size_t i=0; i<1024*64; ++i)
+      random_bytes.push_back(std::rand() % 16);
+
+   auto windows = sliding_entropy(random_bytes, 4096, 512);
+   ASSERT(windows.size() == (random_bytes.size() - 4096) / 512 + 1);
+
+   bool windows_match = true;
 
-   return std::abs(result);
+   for (std::size_t i=0; i<windows.size(); ++i)
+      if (std::abs(windows[i] - entropy(random_bytes.data()+i*512, 4096)) > 1e-9)
+         windows_match = false;
+
+   ASSERT(windows_match);
+   ASSERT(sliding_entropy(random_bytes.data(), 100, 4096).empty());
+   ASSERT_THROWS(sliding_entropy(random_bytes, 0), exception::BadWindow);
+   ASSERT_THROWS(sliding_entropy(random_bytes, 4096, 0), exception::BadWindow);
+
+   COMPLETE();
 }
 
 int
@@ -116,16 +226,1474 @@ test_inflate()
 }
 
 int
-main
-(int argc, char *argv[])
+test_select()
 {
    INIT();
 
-   LOG_INFO("Testing Bitstream objects.");
-   PROCESS_RESULT(test_bitstream);
+   std::srand(std::time(nullptr));
+   ByteVec random_bytes;
 
-   LOG_INFO("Testing inflate functions.");
-   PROCESS_RESULT(test_inflate);
+   for (std::size_t i=0; i<1024*256; ++i)
+      random_bytes.push_back(std::rand() % 256);
+
+   InflateSelection selection;
+   ASSERT_SUCCESS(selection = select_level(random_bytes, 7.0));
+   ASSERT(selection.level != InflateLevel::INFLATE_NOOP);
+   ASSERT(selection.predicted_entropy <= 7.0);
+   LOG_INFO("Selected level " << static_cast<int>(selection.level) << " with predicted entropy " << selection.predicted_entropy);
+
+   auto inflated = inflate_memory_to_entropy(random_bytes, 7.0, InflateFamily::INFLATE_FAMILY_RNG_PARTIAL, 0xDEADBEEF);
+   auto header = std::get<1>(inflated);
+   ASSERT(header.level >= InflateLevel::INFLATE_RNG_PARTIAL_1BIT && header.level <= InflateLevel::INFLATE_RNG_PARTIAL_7BIT);
+   ASSERT(header.level == std::get<2>(inflated).level);
+   ASSERT(entropy(std::get<0>(inflated)) < 7.05);
+   ASSERT(deflate_memory(std::get<0>(inflated), header) == random_bytes);
+
+   auto small = ByteVec(random_bytes.begin(), random_bytes.begin()+4096);
+   inflated = inflate_memory_to_entropy(small, 6.0);
+   ASSERT(entropy(std::get<0>(inflated)) == std::get<2>(inflated).predicted_entropy);
+   ASSERT(deflate_memory(std::get<0>(inflated), std::get<1>(inflated)) == small);
+
+   ASSERT(select_level(ByteVec(4096, 0x41), 1.0).level == InflateLevel::INFLATE_NOOP);
+   ASSERT_THROWS(select_level(random_bytes, 0.5), exception::UnreachableEntropy);
+
+   COMPLETE();
+}
+
+int
+test_regions()
+{
+   INIT();
+
+   std::srand(std::time(nullptr));
+   ByteVec mixed;
+
+   for (std::size_t i=0; i<1024*32; ++i)
+      mixed.push_back(std::rand() % 256);
+
+   for (std::size_t i=0; i<1024*64; ++i)
+      mixed.push_back("a low entropy table of strings"[i % 30]);
+
+   for (std::size_t i=0; i<1024*32+100; ++i)
+      mixed.push_back(std::rand() % 256);
+
+   ByteVec inflated;
+   ASSERT_SUCCESS(inflated = inflate_regions_disk(mixed, 7.0));
+   ASSERT(std::memcmp(inflated.data(), INFLATE_REGION_MAGIC, 4) == 0);
+   ASSERT(inflated.size() < inflate_disk(mixed, InflateLevel::INFLATE_3BIT).size());
+   LOG_INFO("Region inflated size: " << inflated.size() << " (from " << mixed.size() << ")");
+
+   ByteVec deflated;
+   ASSERT_SUCCESS(deflated = deflate_disk(inflated));
+   ASSERT(deflated == mixed);
+
+   auto mem = inflate_regions_memory(mixed, 7.0, 0x4000, InflateFamily::INFLATE_FAMILY_RNG_FULL);
+   auto &regions = std::get<2>(mem);
+   ASSERT(regions.size() == 9);
+   ASSERT(regions[3].level == InflateLevel::INFLATE_NOOP);
+   ASSERT(regions[0].level >= InflateLevel::INFLATE_RNG_FULL_1BIT);
+
+   bool passing = true;
+   std::uint64_t offset = 0;
+
+   for (auto &region : regions)
+   {
+      auto bytes = region.inflated / 8 + static_cast<std::uint64_t>(region.inflated % 8 != 0);
+
+      if (entropy(std::get<0>(mem).data()+offset, bytes) > 7.0)
+         passing = false;
+
+      offset += bytes;
+   }
+
+   ASSERT(passing);
+   ASSERT(deflate_regions_memory(std::get<0>(mem), std::get<1>(mem), regions) == mixed);
+
+   inflated[inflated.size()-1] ^= 0xFF;
+   ASSERT_THROWS(deflate_disk(inflated), exception::BadCRC);
+
+   COMPLETE();
+}
+
+int
+test_stats()
+{
+   INIT();
+
+   ByteVec input(4096, 0x5A);
+   std::size_t callbacks = 0;
+   std::string operation;
+
+   set_stats_callback([&callbacks, &operation](const char *name, const InflateStats &) { ++callbacks; operation = name; });
+   auto inflated = inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_3BIT);
+   set_stats_callback(nullptr);
+
+   auto stats = last_stats();
+
+   if (stats_enabled())
+   {
+      ASSERT(callbacks == 1);
+      ASSERT(operation == "inflate_disk");
+      ASSERT(stats.bytes_in == input.size());
+      ASSERT(stats.bytes_out == inflated.size());
+      ASSERT(stats.lfsr_steps >= input.size() * 8 / 5);
+      ASSERT(stats.allocations == 1);
+
+      ASSERT_SUCCESS(deflate_disk(inflated));
+      ASSERT(last_stats().bytes_out == input.size());
+   }
+   else
+   {
+      ASSERT(callbacks == 0);
+      ASSERT(stats.bytes_in == 0 && stats.transform_ns == 0);
+   }
+
+   COMPLETE();
+}
+
+int
+test_status()
+{
+   INIT();
+
+   ByteVec input;
+
+   for (std::size_t i=0; i<1000; ++i)
+      input.push_back(static_cast<std::uint8_t>(i * 31));
+
+   for (int level=InflateLevel::INFLATE_NOOP; level<=InflateLevel::INFLATE_RNG_FULL_7BIT; ++level)
+   {
+      auto inflated = try_inflate_disk(input, static_cast<InflateLevel>(level), 0x1234);
+      ASSERT(inflated.ok());
+      ASSERT(*inflated == inflate_disk(input, static_cast<InflateLevel>(level), 0x1234));
+
+      auto deflated = try_deflate_disk(*inflated);
+      ASSERT(deflated.ok() && *deflated == input);
+   }
+
+   auto inflated = *try_inflate_disk(input, InflateLevel::INFLATE_RNG_PARTIAL_2BIT);
+   auto corrupt = inflated;
+
+   corrupt[0] = 'X';
+   ASSERT(try_deflate_disk(corrupt).status() == InflateStatus::STATUS_BAD_HEADER_MAGIC);
+   ASSERT(try_deflate_disk(corrupt.data(), 8).status() == InflateStatus::STATUS_INSUFFICIENT_SIZE);
+   ASSERT(try_deflate_disk(ByteVec(inflated.begin(), inflated.end()-1)).status() == InflateStatus::STATUS_INSUFFICIENT_SIZE);
+
+   corrupt = inflated;
+   corrupt[corrupt.size()-1] ^= 0xFF;
+   ASSERT(try_deflate_disk(corrupt).status() == InflateStatus::STATUS_BAD_CRC);
+   ASSERT_THROWS(deflate_disk(corrupt), exception::BadCRC);
+
+   auto mem = *try_inflate_memory(input, InflateLevel::INFLATE_5BIT);
+   auto header = mem.second;
+   header.level = 0xFF;
+   ASSERT(try_deflate_memory(mem.first, header).status() == InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL);
+   ASSERT_THROWS(deflate_memory(mem.first, header), exception::UnsupportedInflateLevel);
+
+   header = mem.second;
+   header.deflated += 8;
+   ASSERT(try_deflate_memory(mem.first, header).status() == InflateStatus::STATUS_BAD_HEADER);
+   ASSERT_THROWS(deflate_memory(mem.first, header), exception::BadHeader);
+
+   // an LFSR seeded with 0 never moves, which the RNG_FULL levels would wait on forever.
+   ASSERT(try_inflate_memory(input, InflateLevel::INFLATE_RNG_FULL_3BIT, 0u).status() == InflateStatus::STATUS_BAD_SEED);
+   ASSERT_THROWS(inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_7BIT, 0u), exception::BadSeed);
+   ASSERT(try_inflate_memory(input, InflateLevel::INFLATE_RNG_PARTIAL_3BIT, 0u).ok());
+
+   InflateOptions zero_seed;
+   zero_seed.level = InflateLevel::INFLATE_RNG_FULL_WIDE;
+   zero_seed.group_bits = 16;
+   zero_seed.padding_bits = 3;
+   zero_seed.seed = 0;
+   ASSERT(try_inflate_memory(input, zero_seed).status() == InflateStatus::STATUS_BAD_SEED);
+
+   zero_seed.rng = RngEngine::RNG_PHILOX;
+   ASSERT(try_inflate_memory(input, zero_seed).ok());
+
+   auto full_disk = *try_inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_3BIT, 0x1234);
+   std::memset(full_disk.data()+4+offsetof(InflateHeader, seed), 0, sizeof(std::uint32_t));
+   ASSERT(try_deflate_disk(full_disk).status() == InflateStatus::STATUS_BAD_HEADER);
+   ASSERT_THROWS(deflate_disk(full_disk), exception::BadHeader);
+
+   auto full_mem = *try_inflate_memory(input, InflateOptions{InflateLevel::INFLATE_RNG_FULL_3BIT, 0x1234});
+   full_mem.second.seed = 0;
+   ASSERT(try_deflate_memory(full_mem.first, full_mem.second).status() == InflateStatus::STATUS_BAD_HEADER);
+
+   ASSERT(try_inflate_memory(input, static_cast<InflateLevel>(0x40)).status() == InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL);
+   ASSERT(try_inflate_memory(nullptr, 16).status() == InflateStatus::STATUS_NULL_POINTER);
+   ASSERT(std::strlen(status_string(InflateStatus::STATUS_BAD_CRC)) > 0);
+
+   COMPLETE();
+}
+
+namespace
+{
+   constexpr std::array<std::uint8_t, 37> STATIC_PAYLOAD = {
+      0x49, 0x6E, 0x66, 0x6C, 0x61, 0x74, 0x65, 0x20, 0x6D, 0x65, 0x20, 0x61, 0x74, 0x20, 0x63, 0x6F,
+      0x6D, 0x70, 0x69, 0x6C, 0x65, 0x20, 0x74, 0x69, 0x6D, 0x65, 0x00, 0xFF, 0x80, 0x01, 0x7F, 0xFE,
+      0xDE, 0xAD, 0xBE, 0xEF, 0x5A,
+   };
+
+   template <InflateLevel Level>
+   bool matches_runtime() {
+      constexpr auto blob = static_inflate<Level, 0x1234>(STATIC_PAYLOAD);
+      auto runtime = inflate_memory(STATIC_PAYLOAD.data(), STATIC_PAYLOAD.size(), Level, 0x1234);
+
+      return ByteVec(blob.data.begin(), blob.data.end()) == runtime.first
+         && blob.header.level == runtime.second.level
+         && blob.header.inflated == runtime.second.inflated
+         && blob.header.deflated == runtime.second.deflated
+         && blob.header.checksum == runtime.second.checksum
+         && blob.header.seed == runtime.second.seed
+         && deflate_memory(blob.data.data(), blob.data.size(), blob.header) == ByteVec(STATIC_PAYLOAD.begin(), STATIC_PAYLOAD.end());
+   }
+}
+
+int
+test_static()
+{
+   INIT();
+
+   static_assert(crc32(std::array<std::uint8_t, 9>{'1','2','3','4','5','6','7','8','9'}) == 0xCBF43926);
+   static_assert(static_inflate<InflateLevel::INFLATE_RNG_FULL_3BIT>(STATIC_PAYLOAD).header.inflated == 60*8);
+
+   ASSERT(matches_runtime<InflateLevel::INFLATE_NOOP>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_3BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_7BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_RNG_PARTIAL_1BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_RNG_PARTIAL_2BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_RNG_PARTIAL_5BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_RNG_PARTIAL_7BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_RNG_FULL_3BIT>());
+   ASSERT(matches_runtime<InflateLevel::INFLATE_RNG_FULL_7BIT>());
+
+   COMPLETE();
+}
+
+int
+test_context()
+{
+   INIT();
+
+   ByteVec input;
+
+   for (std::size_t i=0; i<5000; ++i)
+      input.push_back(static_cast<std::uint8_t>(i * 131 + (i >> 3)));
+
+   auto first = InflateContext(0x1234);
+   auto second = InflateContext(0x1234);
+   auto seed = first.next_seed();
+
+   ASSERT(seed == second.next_seed());
+   ASSERT(first.next_seed() != seed);
+   ASSERT(generate_seed() != generate_seed());
+
+   auto context = InflateContext();
+
+   for (int level=InflateLevel::INFLATE_NOOP; level<=InflateLevel::INFLATE_RNG_FULL_7BIT; ++level)
+   {
+      auto mem = context.inflate_memory(input, static_cast<InflateLevel>(level), 0x5678);
+      ASSERT(mem.first == inflate_memory(input, static_cast<InflateLevel>(level), 0x5678).first);
+
+      auto header = mem.second;
+      ASSERT(context.deflate_memory(mem.first, header) == input);
+
+      auto &disk = context.inflate_disk(input, static_cast<InflateLevel>(level), 0x5678);
+      ASSERT(disk == inflate_disk(input, static_cast<InflateLevel>(level), 0x5678));
+      ASSERT(context.deflate_disk(disk) == input);
+   }
+
+   // once warmed up, repeating a request reuses the same buffer.
+   auto data = context.inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_7BIT).data();
+   auto capacity = context.capacity();
+   ASSERT(context.inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_7BIT).data() == data);
+   ASSERT(context.capacity() == capacity);
+
+   ByteVec output;
+   auto header = context.inflate_memory_into(output, input.data(), input.size(), InflateLevel::INFLATE_RNG_PARTIAL_2BIT);
+   auto reserved = output.data();
+   context.deflate_memory_into(output, ByteVec(output).data(), output.size(), header);
+   ASSERT(output == input && output.data() == reserved);
+
+   // the context's own output can be passed straight back in, in either direction and at any size.
+   auto v2 = context.inflate_memory(input, InflateOptions{InflateLevel::INFLATE_RNG_FULL_3BIT, 0x5678});
+   auto v2_header = v2.second;
+   auto expected = inflate_memory(input, InflateOptions{InflateLevel::INFLATE_RNG_FULL_3BIT, 0x5678}).first;
+   ASSERT(context.deflate_memory(context.output(), v2_header) == input);
+   ASSERT(context.inflate_memory(context.output(), InflateOptions{InflateLevel::INFLATE_RNG_FULL_3BIT, 0x5678}).first == expected);
+   ASSERT(context.deflate_memory(context.output(), v2_header) == input);
+   ASSERT(context.inflate_memory(context.output(), InflateLevel::INFLATE_7BIT, 0x5678).first == inflate_memory(input, InflateLevel::INFLATE_7BIT, 0x5678).first);
+   ASSERT(context.inflate_disk(context.output(), InflateLevel::INFLATE_7BIT, 0x5678) == inflate_disk(inflate_memory(input, InflateLevel::INFLATE_7BIT, 0x5678).first, InflateLevel::INFLATE_7BIT, 0x5678));
+   ASSERT(context.deflate_disk(context.output()) == inflate_memory(input, InflateLevel::INFLATE_7BIT, 0x5678).first);
+
+   header = context.inflate_memory_into(output, output.data(), output.size(), InflateLevel::INFLATE_RNG_PARTIAL_2BIT, 0x5678);
+   context.deflate_memory_into(output, output.data(), output.size(), header);
+   ASSERT(output == input);
+
+   context.inflate_memory_into(context.scratch(), input.data(), input.size(), InflateLevel::INFLATE_3BIT, 0x5678);
+   context.inflate_memory_into(context.scratch(), context.scratch().data(), context.scratch().size(), InflateLevel::INFLATE_3BIT, 0x5678);
+   ASSERT(context.scratch() == inflate_memory(inflate_memory(input, InflateLevel::INFLATE_3BIT, 0x5678).first, InflateLevel::INFLATE_3BIT, 0x5678).first);
+
+   context.release();
+   ASSERT(context.capacity() == 0);
+
+   bool thread_ok[2] = { false, false };
+   auto worker = [&input, &thread_ok](std::size_t index) {
+      auto local = InflateContext();
+      bool ok = true;
+
+      for (int i=0; i<32; ++i)
+      {
+         auto &disk = local.inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_3BIT);
+         ok = ok && local.deflate_disk(disk) == input;
+      }
+
+      thread_ok[index] = ok;
+   };
+
+   std::thread a(worker, 0), b(worker, 1);
+   a.join();
+   b.join();
+   ASSERT(thread_ok[0] && thread_ok[1]);
+
+   COMPLETE();
+}
+
+int
+test_checksum()
+{
+   INIT();
+
+   auto check = "123456789";
+   ASSERT(crc32(check, 9) == 0xCBF43926);
+   ASSERT(crc32c(check, 9) == 0xE3069283);
+   ASSERT(xxh64(check, 0) == 0xEF46DB3751D8E999ULL);
+   ASSERT(xxh64("abc", 3) == 0x44BC2CF5AD770999ULL);
+
+   ByteVec input;
+
+   for (std::size_t i=0; i<3001; ++i)
+      input.push_back(static_cast<std::uint8_t>((i * 7919) ^ (i >> 5)));
+
+   // the sliced and hardware paths must agree with a plain bitwise CRC at every length and alignment.
+   for (std::size_t offset=0; offset<3; ++offset)
+   {
+      for (std::size_t size : { 0, 1, 7, 8, 9, 63, 1000, 2998 })
+      {
+         std::uint32_t reference = 0xFFFFFFFF;
+         std::uint32_t reference_c = 0xFFFFFFFF;
+
+         for (std::size_t i=0; i<size; ++i)
+         {
+            reference = CRC32_TABLE[(reference ^ input[offset+i]) & 0xFF] ^ (reference >> 8);
+            reference_c ^= input[offset+i];
+
+            for (int bit=0; bit<8; ++bit)
+               reference_c = (reference_c & 1) ? (reference_c >> 1) ^ 0x82F63B78 : reference_c >> 1;
+         }
+
+         ASSERT(crc32(input.data()+offset, size) == (reference ^ 0xFFFFFFFF));
+         ASSERT(crc32c(input.data()+offset, size) == (reference_c ^ 0xFFFFFFFF));
+      }
+   }
+
+   for (auto type : { ChecksumType::CHECKSUM_CRC32, ChecksumType::CHECKSUM_CRC32C, ChecksumType::CHECKSUM_XXH64 })
+   {
+      InflateOptions options;
+      options.level = InflateLevel::INFLATE_RNG_PARTIAL_3BIT;
+      options.seed = 0x4242;
+      options.checksum = type;
+
+      auto mem = inflate_memory(input, options);
+      ASSERT(mem.second.version == 2 && mem.second.checksum_type == type);
+      ASSERT(mem.second.checksum == checksum(type, input.data(), input.size()));
+      ASSERT(mem.first == inflate_memory(input, options.level, 0x4242).first);
+      ASSERT(deflate_memory(mem.first, mem.second) == input);
+
+      auto disk = inflate_disk(input, options);
+      ASSERT(std::memcmp(disk.data(), INFLATE_VERSIONED_MAGIC, 4) == 0);
+      ASSERT(deflate_disk(disk) == input);
+      ASSERT(*try_deflate_disk(disk) == input);
+
+      disk[disk.size()-1] ^= 0xFF;
+      ASSERT_THROWS(deflate_disk(disk), exception::BadCRC);
+      ASSERT(try_deflate_disk(disk).status() == InflateStatus::STATUS_BAD_CRC);
+   }
+
+   for (std::size_t split : { 0, 1, 8, 1500, 3001 })
+   {
+      auto crc_a = crc32(input.data(), split);
+      auto crc_b = crc32(input.data()+split, input.size()-split);
+      ASSERT(crc32_combine(crc_a, crc_b, input.size()-split) == crc32(input));
+
+      auto crc_c = crc32c(input.data(), split);
+      auto crc_d = crc32c(input.data()+split, input.size()-split);
+      ASSERT(crc32c_combine(crc_c, crc_d, input.size()-split) == crc32c(input));
+   }
+
+   ByteVec large(0x500003);
+
+   for (std::size_t i=0; i<large.size(); ++i)
+      large[i] = static_cast<std::uint8_t>(i ^ (i >> 11));
+
+   auto large_crc = crc32(large);
+   ASSERT(crc32_parallel(large, 4) == large_crc);
+   ASSERT(crc32_parallel(large, 3) == large_crc);
+   ASSERT(crc32_parallel(large, 0) == large_crc);
+   ASSERT(crc32_parallel(large.data(), 0x100, 4) == crc32(large.data(), 0x100));
+   ASSERT(crc32_parallel(large, 4, 0x12345678) == crc32(large, 0x12345678));
+
+   // the legacy calls still produce NFL8 streams with a CRC32.
+   auto legacy = inflate_disk(input, InflateLevel::INFLATE_5BIT, 0x4242);
+   ASSERT(std::memcmp(legacy.data(), INFLATE_MAGIC, 4) == 0);
+
+   InflateOptions bad_options;
+   bad_options.checksum = static_cast<ChecksumType>(0x7F);
+   ASSERT_THROWS(inflate_disk(input, bad_options), exception::UnsupportedChecksum);
+   ASSERT(try_inflate_disk(input, bad_options).status() == InflateStatus::STATUS_UNSUPPORTED_CHECKSUM);
+
+   // readers skip fields appended by later header versions.
+   auto disk = inflate_disk(input, InflateOptions{});
+   InflateHeaderV2 header;
+   std::memcpy(&header, disk.data()+4, sizeof(InflateHeaderV2));
+   header.header_size += 8;
+
+   ByteVec extended(disk.begin(), disk.begin()+4);
+   extended.insert(extended.end(), reinterpret_cast<std::uint8_t *>(&header), reinterpret_cast<std::uint8_t *>(&header)+sizeof(InflateHeaderV2));
+   extended.insert(extended.end(), 8, 0);
+   extended.insert(extended.end(), disk.begin()+4+sizeof(InflateHeaderV2), disk.end());
+   ASSERT(deflate_disk(extended) == input);
+
+   header.version = INFLATE_HEADER_VERSION + 1;
+   std::memcpy(extended.data()+4, &header, sizeof(InflateHeaderV2));
+   ASSERT(deflate_disk(extended) == input);
+
+   header.version = INFLATE_MIN_HEADER_VERSION - 1;
+   std::memcpy(extended.data()+4, &header, sizeof(InflateHeaderV2));
+   ASSERT_THROWS(deflate_disk(extended), exception::BadHeader);
+
+   // a later version may only append fields, so one using a reserved byte is refused rather than misread.
+   header.version = INFLATE_HEADER_VERSION + 1;
+   header.reserved[2] = 1;
+   std::memcpy(extended.data()+4, &header, sizeof(InflateHeaderV2));
+   ASSERT_THROWS(deflate_disk(extended), exception::BadHeader);
+   ASSERT(try_deflate_disk(extended).status() == InflateStatus::STATUS_BAD_HEADER);
+
+   COMPLETE();
+}
+
+int
+test_stream()
+{
+   INIT();
+
+   // larger than one chunk at every level, and not a multiple of the modulus.
+   ByteVec input(INFLATE_STREAM_BLOCKS * 8 * 2 + 13);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>((i * 31) ^ (i >> 9));
+
+   for (auto level : { InflateLevel::INFLATE_1BIT, InflateLevel::INFLATE_3BIT, InflateLevel::INFLATE_7BIT,
+                       InflateLevel::INFLATE_RNG_PARTIAL_3BIT, InflateLevel::INFLATE_RNG_FULL_3BIT })
+   {
+      std::stringstream sink(std::ios::in | std::ios::out | std::ios::binary);
+
+      {
+         InflateStreambuf inflater(sink.rdbuf(), level, 0x1234);
+         std::ostream out(&inflater);
+
+         // uneven writes cross the chunk boundaries at arbitrary offsets.
+         for (std::size_t offset=0, step=1; offset<input.size(); offset+=step, step=step*3+1)
+            out.write(reinterpret_cast<const char *>(input.data()+offset), std::min(step, input.size()-offset));
+
+         ASSERT(out.good());
+         ASSERT(inflater.close() == InflateStatus::STATUS_OK);
+      }
+
+      auto text = sink.str();
+      ByteVec streamed(text.begin(), text.end());
+      ASSERT(streamed == inflate_disk(input, level, 0x1234));
+
+      sink.seekg(0);
+      DeflateStreambuf deflater(sink.rdbuf());
+      ASSERT(deflater.header().level == level && deflater.header().deflated == input.size() * 8);
+
+      std::istream in(&deflater);
+      ByteVec output(input.size());
+      in.read(reinterpret_cast<char *>(output.data()), output.size());
+      ASSERT(in.gcount() == static_cast<std::streamsize>(input.size()) && output == input);
+      ASSERT(in.get() == std::char_traits<char>::eof() && deflater.status() == InflateStatus::STATUS_OK);
+   }
+
+   InflateOptions options;
+   options.level = InflateLevel::INFLATE_RNG_FULL_3BIT;
+   options.checksum = ChecksumType::CHECKSUM_CRC32C;
+
+   auto versioned = inflate_disk(input, options);
+   std::stringstream source(std::string(versioned.begin(), versioned.end()), std::ios::in | std::ios::binary);
+   DeflateStreambuf deflater(source.rdbuf());
+   std::istream in(&deflater);
+   std::string versioned_output((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   ASSERT(ByteVec(versioned_output.begin(), versioned_output.end()) == input);
+   ASSERT(deflater.status() == InflateStatus::STATUS_OK);
+
+   auto corrupt = inflate_disk(input, InflateLevel::INFLATE_5BIT, 0x1234);
+   corrupt[corrupt.size()-1] ^= 0xFF;
+   std::stringstream bad_source(std::string(corrupt.begin(), corrupt.end()), std::ios::in | std::ios::binary);
+   DeflateStreambuf bad_deflater(bad_source.rdbuf());
+   std::istream bad_in(&bad_deflater);
+   std::string bad_output((std::istreambuf_iterator<char>(bad_in)), std::istreambuf_iterator<char>());
+   ASSERT(bad_output.size() < input.size() && bad_deflater.status() == InflateStatus::STATUS_BAD_CRC);
+
+   std::stringstream truncated(std::string(corrupt.begin(), corrupt.begin()+corrupt.size()/2), std::ios::in | std::ios::binary);
+   DeflateStreambuf short_deflater(truncated.rdbuf());
+   std::istream short_in(&short_deflater);
+   std::string short_output((std::istreambuf_iterator<char>(short_in)), std::istreambuf_iterator<char>());
+   ASSERT(short_deflater.status() == InflateStatus::STATUS_INSUFFICIENT_SIZE);
+
+   ASSERT_THROWS(InflateStreambuf(nullptr), exception::NullPointer);
+   ASSERT_THROWS(DeflateStreambuf(nullptr), exception::NullPointer);
+
+   COMPLETE();
+}
+
+int
+test_wide()
+{
+   INIT();
+
+   ByteVec input(1001);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>((i * 131) ^ (i >> 3));
+
+   for (auto level : { InflateLevel::INFLATE_WIDE, InflateLevel::INFLATE_RNG_PARTIAL_WIDE, InflateLevel::INFLATE_RNG_FULL_WIDE })
+   {
+      for (std::uint8_t group_bits : { 16, 32 })
+      {
+         for (std::uint8_t padding_bits : { 1, 3, group_bits - 1 })
+         {
+            InflateOptions options;
+            options.level = level;
+            options.seed = 0x5151;
+            options.group_bits = group_bits;
+            options.padding_bits = padding_bits;
+
+            for (std::size_t size : { 0, 1, 5, 1001 })
+            {
+               auto mem = inflate_memory(input.data(), size, options);
+               ASSERT(mem.second.group_bits == group_bits && mem.second.padding_bits == padding_bits);
+               ASSERT(mem.second.inflated == inflated_bits(level, InflateGeometry{group_bits, padding_bits}, size*8));
+               ASSERT(mem.first.size() == mem.second.inflated / 8 + (mem.second.inflated % 8 != 0));
+               ASSERT(deflate_memory(mem.first, mem.second) == ByteVec(input.begin(), input.begin()+size));
+            }
+
+            auto disk = inflate_disk(input, options);
+            ASSERT(deflate_disk(disk) == input);
+
+            std::stringstream source(std::string(disk.begin(), disk.end()), std::ios::in | std::ios::binary);
+            DeflateStreambuf deflater(source.rdbuf());
+            std::istream in(&deflater);
+            std::string streamed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            ASSERT(ByteVec(streamed.begin(), streamed.end()) == input && deflater.status() == InflateStatus::STATUS_OK);
+         }
+      }
+   }
+
+   // one padding bit in sixteen grows the data by a fifteenth, where the smallest 8-bit level grows it by a seventh.
+   InflateOptions options;
+   options.level = InflateLevel::INFLATE_RNG_PARTIAL_WIDE;
+   options.group_bits = 16;
+   options.padding_bits = 1;
+
+   auto wide = inflate_memory(input, options);
+   ASSERT(wide.first.size() < inflate_memory(input, InflateLevel::INFLATE_RNG_PARTIAL_1BIT).first.size());
+   ASSERT(wide.first.size() == (input.size() * 8 + 14) / 15 * 2);
+
+   // the padding bits are the only ones the fixed levels leave clear.
+   options.level = InflateLevel::INFLATE_WIDE;
+   auto fixed = inflate_memory(input, options);
+
+   for (std::size_t i=1; i+1<fixed.first.size(); i+=2)
+      ASSERT((fixed.first[i] & 0x80) == 0);
+
+   ASSERT_THROWS(inflate_memory(input, InflateLevel::INFLATE_WIDE), exception::UnsupportedInflateLevel);
+   ASSERT(try_inflate_disk(input, InflateLevel::INFLATE_RNG_FULL_WIDE).status() == InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL);
+
+   options.padding_bits = 16;
+   ASSERT_THROWS(inflate_memory(input, options), exception::UnsupportedInflateLevel);
+
+   options.group_bits = 24;
+   options.padding_bits = 1;
+   ASSERT(try_inflate_memory(input, options).status() == InflateStatus::STATUS_UNSUPPORTED_INFLATE_LEVEL);
+
+   auto header = wide.second;
+   header.group_bits = 32;
+   ASSERT_THROWS(deflate_memory(wide.first, header), exception::BadHeader);
+
+   COMPLETE();
+}
+
+int
+test_container()
+{
+   INIT();
+
+   ByteVec input(5000);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>(i ^ (i >> 7));
+
+   for (std::uint32_t alignment : { 0, 1, 64, 4096 })
+   {
+      InflateOptions options;
+      options.level = InflateLevel::INFLATE_RNG_PARTIAL_3BIT;
+      options.alignment = alignment;
+
+      auto disk = inflate_disk(input, options);
+      auto container = parse_container(disk);
+      ASSERT(container.payload_offset >= 4 + sizeof(InflateHeaderV2));
+      ASSERT(alignment == 0 || container.payload_offset % alignment == 0);
+      ASSERT(alignment > 64 || container.payload_offset <= 64);
+      ASSERT(container.payload_offset + container.payload_size == disk.size());
+
+      for (auto i=4+sizeof(InflateHeaderV2); i<container.payload_offset; ++i)
+         ASSERT(disk[i] == 0);
+
+      ASSERT(deflate_memory(disk.data()+container.payload_offset, container.payload_size, container.header) == input);
+      ASSERT(deflate_disk(disk) == input);
+      ASSERT(try_parse_container(disk)->payload_offset == container.payload_offset);
+
+      std::stringstream source(std::string(disk.begin(), disk.end()), std::ios::in | std::ios::binary);
+      DeflateStreambuf deflater(source.rdbuf());
+      std::istream in(&deflater);
+      std::string streamed((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      ASSERT(ByteVec(streamed.begin(), streamed.end()) == input);
+   }
+
+   auto legacy = inflate_disk(input, InflateLevel::INFLATE_2BIT);
+   ASSERT(parse_container(legacy).payload_offset == 4 + sizeof(InflateHeader));
+   ASSERT(parse_container(legacy).header.level == InflateLevel::INFLATE_2BIT);
+
+   legacy.pop_back();
+   ASSERT_THROWS(parse_container(legacy), exception::InsufficientSize);
+   ASSERT(try_parse_container(legacy).status() == InflateStatus::STATUS_INSUFFICIENT_SIZE);
+   ASSERT(try_parse_container(nullptr, 0).status() == InflateStatus::STATUS_NULL_POINTER);
+
+   InflateOptions bad_options;
+   bad_options.alignment = 48;
+   ASSERT_THROWS(inflate_disk(input, bad_options), exception::BadAlignment);
+   ASSERT(try_inflate_disk(input, bad_options).status() == InflateStatus::STATUS_BAD_ALIGNMENT);
+
+   COMPLETE();
+}
+
+int
+test_cpu()
+{
+   INIT();
+
+   auto best = cpu_features().tier();
+   ASSERT(cpu_tier() <= best);
+   ASSERT(std::strcmp(cpu_tier_name(CpuTier::CPU_TIER_AVX2), "avx2") == 0);
+
+   ByteVec input(4099);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>((i * 197) ^ (i >> 4));
+
+   InflateOptions wide;
+   wide.level = InflateLevel::INFLATE_RNG_FULL_WIDE;
+   wide.seed = 0x7777;
+   wide.group_bits = 32;
+   wide.padding_bits = 5;
+
+   set_cpu_tier(CpuTier::CPU_TIER_GENERIC);
+   ASSERT(cpu_tier() == CpuTier::CPU_TIER_GENERIC);
+   ASSERT(!cpu_enabled(CpuFeature::CPU_FEATURE_SSE42) && !cpu_enabled(CpuFeature::CPU_FEATURE_BMI2));
+
+   auto crc = crc32(input);
+   auto crc_c = crc32c(input);
+   auto full = inflate_memory(input, InflateLevel::INFLATE_RNG_FULL_3BIT, 0x7777).first;
+   auto full_wide = inflate_memory(input, wide).first;
+
+   // every tier the CPU supports must give the generic results.
+   for (int tier=CpuTier::CPU_TIER_SSE42; tier<=best; ++tier)
+   {
+      set_cpu_tier(static_cast<CpuTier>(tier));
+      ASSERT(cpu_tier() == tier);
+      ASSERT(crc32(input) == crc && crc32c(input) == crc_c);
+      ASSERT(crc32(input.data()+3, 100, 0x1234) == crc32(ByteVec(input.begin()+3, input.begin()+103), 0x1234));
+      ASSERT(inflate_memory(input, InflateLevel::INFLATE_RNG_FULL_3BIT, 0x7777).first == full);
+      auto inflated_wide = inflate_memory(input, wide);
+      ASSERT(inflated_wide.first == full_wide);
+      ASSERT(deflate_memory(inflated_wide.first, inflated_wide.second) == input);
+   }
+
+   set_cpu_tier(CpuTier::CPU_TIER_AVX512);
+   ASSERT(cpu_tier() == best);
+
+   set_cpu_tier(std::nullopt);
+   ASSERT(cpu_tier() <= best);
+
+   COMPLETE();
+}
+
+int
+test_parallel()
+{
+   INIT();
+
+   auto jumped = ShiftRegister(0x1234);
+   auto shifted = ShiftRegister(0x1234);
+   jumped.jump(1000);
+
+   for (int i=0; i<1000; ++i)
+      shifted.shift();
+
+   ASSERT(*jumped == *shifted);
+   ASSERT(!numa_nodes().empty());
+
+   ByteVec input(100003);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>((i * 131) ^ (i >> 7));
+
+   InflateOptions cases[5];
+   cases[0].level = InflateLevel::INFLATE_RNG_PARTIAL_3BIT;
+   cases[1].level = InflateLevel::INFLATE_5BIT;
+   cases[1].checksum = ChecksumType::CHECKSUM_CRC32C;
+   cases[2].level = InflateLevel::INFLATE_RNG_PARTIAL_WIDE;
+   cases[2].group_bits = 16;
+   cases[2].padding_bits = 3;
+   cases[3].level = InflateLevel::INFLATE_RNG_FULL_2BIT;
+   cases[4].level = InflateLevel::INFLATE_RNG_PARTIAL_7BIT;
+   cases[4].checksum = ChecksumType::CHECKSUM_XXH64;
+
+   ParallelOptions parallel;
+   parallel.minimum = 1;
+
+   for (auto &options : cases)
+   {
+      options.seed = 0xBEEF;
+      auto expected = inflate_memory(input, options);
+
+      for (std::size_t threads : {1, 3, 4})
+      {
+         parallel.threads = threads;
+
+         ByteVec inflated(inflated_size(options, input.size()));
+         ASSERT(inflated.size() == expected.first.size());
+
+         auto header = inflate_memory_parallel(input.data(), input.size(), inflated.data(), options, parallel);
+         ASSERT(inflated == expected.first);
+         ASSERT(std::memcmp(&header, &expected.second, sizeof(InflateHeaderV2)) == 0);
+
+         ByteVec deflated(input.size());
+         deflate_memory_parallel(inflated.data(), inflated.size(), header, deflated.data(), true, parallel);
+         ASSERT(deflated == input);
+      }
+   }
+
+   auto inflated = inflate_memory(input, cases[0]);
+   ByteVec deflated(input.size());
+   inflated.second.checksum ^= 1;
+   ASSERT_THROWS(deflate_memory_parallel(inflated.first.data(), inflated.first.size(), inflated.second, deflated.data(), true, parallel),
+                 exception::BadCRC);
+   ASSERT_THROWS(deflate_memory_parallel(inflated.first.data(), 10, inflated.second, deflated.data(), true, parallel),
+                 exception::InsufficientSize);
+
+   // the same argument checks as inflate_memory.
+   cases[3].seed = 0;
+   inflated.first.resize(inflated_size(cases[3], input.size()));
+   ASSERT_THROWS(inflate_memory_parallel(input.data(), input.size(), inflated.first.data(), cases[3], parallel), exception::BadSeed);
+
+   COMPLETE();
+}
+
+int
+test_large_buffer()
+{
+   INIT();
+
+   LargeBuffer empty;
+   ASSERT(empty.empty() && empty.data() == nullptr && empty.backing() == LargeBufferBacking::LARGE_BUFFER_EMPTY);
+
+   LargeBuffer buffer(0x300001);
+   ASSERT(buffer.size() == 0x300001 && buffer.backing() != LargeBufferBacking::LARGE_BUFFER_EMPTY);
+
+   for (std::size_t i=0; i<buffer.size(); i+=0x1001)
+      buffer[i] = static_cast<std::uint8_t>(i >> 3);
+
+   buffer.prefault(4);
+
+   auto intact = true;
+
+   for (std::size_t i=0; i<buffer.size(); i+=0x1001)
+      intact = intact && buffer[i] == static_cast<std::uint8_t>(i >> 3);
+
+   ASSERT(intact);
+
+   auto moved = std::move(buffer);
+   ASSERT(buffer.empty() && moved.size() == 0x300001);
+
+   LargeBufferOptions hugetlb;
+   hugetlb.hugetlb = true;
+   LargeBuffer pooled(0x1000, hugetlb);
+   pooled.prefault();
+   ASSERT(pooled.size() == 0x1000 && pooled.backing() != LargeBufferBacking::LARGE_BUFFER_EMPTY);
+
+   ByteVec input(50000);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>(i * 7 + (i >> 9));
+
+   InflateOptions options;
+   options.level = InflateLevel::INFLATE_RNG_PARTIAL_4BIT;
+   options.seed = 0x4242;
+
+   ParallelOptions parallel;
+   parallel.threads = 2;
+   parallel.minimum = 1;
+
+   auto expected = inflate_memory(input, options);
+   auto inflated = inflate_memory_large(input.data(), input.size(), options, parallel);
+   ASSERT(inflated.first.to_bytevec() == expected.first);
+
+   auto deflated = deflate_memory_large(inflated.first.data(), inflated.first.size(), inflated.second, true, parallel);
+   ASSERT(deflated.to_bytevec() == input);
+
+   inflated.second.inflated *= 2;
+   ASSERT_THROWS(deflate_memory_large(inflated.first.data(), inflated.first.size(), inflated.second), exception::InsufficientSize);
+
+   COMPLETE();
+}
+
+int
+test_bitspan()
+{
+   INIT();
+
+   ByteVec bytes(64);
+
+   for (std::size_t i=0; i<bytes.size(); ++i)
+      bytes[i] = static_cast<std::uint8_t>((i * 29) ^ 0x5A);
+
+   auto stream = BitstreamVec(bytes, bytes.size()*8);
+   auto reference_bits = stream.to_bitvec();
+
+   auto view = stream.span(3, 400);
+   ASSERT(view.bit_size() == 400 && view.data() == stream.data() && view.offset() == 3);
+   ASSERT(view[0] == reference_bits[3] && view[399] == reference_bits[402]);
+
+   auto inner = view.subspan(10, 100).last(40);
+   ASSERT(inner.data() == stream.data()+9 && inner.offset() == 1);
+   ASSERT(inner.to_bitvec() == BitVec(reference_bits.begin()+73, reference_bits.begin()+113));
+   ASSERT(inner.count(true) + inner.count(false) == 40);
+   ASSERT(inner.find(!inner[0]) != 0);
+
+   auto target = BitstreamVec(200);
+   auto window = target.mutable_span(17, 100);
+   window.copy_from(stream.span(50, 100));
+   ASSERT(window == stream.span(50, 100));
+   ASSERT(ConstBitSpan(window) == stream.span(50, 100));
+   ASSERT(window != stream.span(51, 100));
+   ASSERT(target.span(0, 17).count(true) == 0 && target.span(117, 83).count(true) == 0);
+
+   window.fill(true);
+   ASSERT(target.span().count(true) == 100 && target.span().find(true) == 17);
+   window.set_bit(5, false);
+   ASSERT(!target[22] && target.span().count(true) == 99);
+
+   auto shifted = BitstreamVec(stream);
+   shifted.span(0, 300).copy_to(shifted.mutable_span(7, 300));
+   ASSERT(shifted.span(7, 300) == stream.span(0, 300));
+
+   auto sliced = BitstreamVec(stream.span(5, 123));
+   ASSERT(sliced.bit_size() == 123 && sliced == stream.span(5, 123));
+
+   auto appended = BitstreamVec(stream.span(0, 10));
+   appended.push_bits(stream.span(100, 30));
+   ASSERT(appended.span(10, 30) == stream.span(100, 30));
+   appended.push_bits(appended.span(0, 40));
+   ASSERT(appended.span(40, 40) == appended.span(0, 40));
+
+   appended.insert_bits(3, stream.span(200, 13));
+   ASSERT(appended.bit_size() == 93 && appended.span(3, 13) == stream.span(200, 13));
+   ASSERT(appended.span(16, 7) == stream.span(3, 7));
+
+   appended.write_bits(1, stream.span(300, 9));
+   ASSERT(appended.span(1, 9) == stream.span(300, 9));
+
+   ASSERT_THROWS(view.subspan(390, 11), exception::OutOfBounds);
+   ASSERT_THROWS(view.copy_to(target.mutable_span(0, 10)), exception::OutOfBounds);
+
+   static_assert(!std::is_constructible<MutBitstreamPtr, const std::uint8_t *, std::uint64_t>::value,
+                 "const data must not make a mutable stream");
+
+   auto const_stream = ConstBitstreamPtr(static_cast<const std::uint8_t *>(bytes.data()), 64);
+   const ConstBitstreamPtr &as_const = stream;
+   ASSERT(const_stream.span() == stream.span(0, 64));
+   ASSERT(const_stream == stream.read_bits(0, 64).to_bitvec());
+   ASSERT(as_const.get_byte(1) == bytes[1]);
+   ASSERT_THROWS(ConstBitstreamPtr(static_cast<const std::uint8_t *>(nullptr), 8), exception::NullPointer);
+   ASSERT_THROWS(MutBitstreamPtr(static_cast<std::uint8_t *>(nullptr), 8), exception::NullPointer);
+   ASSERT_SUCCESS(ConstBitstreamPtr(static_cast<const std::uint8_t *>(nullptr), 0));
+
+   COMPLETE();
+}
+
+int
+test_archive()
+{
+   INIT();
+
+   std::vector<ByteVec> files;
+   std::vector<ArchiveSource> sources;
+
+   for (std::size_t i=0; i<20; ++i)
+   {
+      ByteVec file(i * 997);
+
+      for (std::size_t j=0; j<file.size(); ++j)
+         file[j] = static_cast<std::uint8_t>((j * (i + 3)) ^ (j >> 5));
+
+      files.push_back(std::move(file));
+   }
+
+   for (std::size_t i=0; i<files.size(); ++i)
+      sources.push_back(ArchiveSource{"dir/file" + std::to_string(i) + ".bin", files[i].data(), files[i].size()});
+
+   InflateOptions options;
+   options.level = InflateLevel::INFLATE_RNG_PARTIAL_3BIT;
+   options.checksum = ChecksumType::CHECKSUM_CRC32C;
+   options.seed = 0x1357;
+   options.alignment = 64;
+
+   auto archive = inflate_archive(sources, options, 4);
+   ASSERT(archive == inflate_archive(sources, options, 1));
+   ASSERT(std::memcmp(archive.data(), INFLATE_ARCHIVE_MAGIC, 4) == 0);
+
+   ArchiveReader reader(archive);
+   ASSERT(reader.members().size() == files.size());
+   ASSERT(reader.members()[7].name == "dir/file7.bin" && reader.members()[7].deflated == files[7].size());
+   ASSERT(reader.find("dir/file3.bin") == &reader.members()[3]);
+   ASSERT(reader.find("missing") == nullptr);
+
+   auto all_match = true;
+   auto all_aligned = true;
+   auto all_streams = true;
+
+   for (std::size_t i=0; i<files.size(); ++i)
+   {
+      auto &member = reader.members()[i];
+      auto container = reader.container(member);
+
+      all_match = all_match && reader.extract(member) == files[i];
+      all_aligned = all_aligned && (member.offset + container.payload_offset) % 64 == 0;
+
+      // members are inflated in place, but each is still exactly the stream inflate_disk returns.
+      auto stream = inflate_disk(files[i], options);
+      all_streams = all_streams && member.size == stream.size() && std::equal(stream.begin(), stream.end(), archive.begin()+member.offset);
+   }
+
+   ASSERT(all_match);
+   ASSERT(all_aligned);
+   ASSERT(all_streams);
+   ASSERT(reader.extract("dir/file19.bin") == files[19]);
+   ASSERT_THROWS(reader.extract("missing"), exception::MemberNotFound);
+
+   auto unseeded = inflate_archive(sources);
+   ArchiveReader unseeded_reader(unseeded);
+   ASSERT(unseeded_reader.extract("dir/file11.bin") == files[11]);
+   ASSERT(unseeded_reader.container(unseeded_reader.members()[1]).header.seed
+          != unseeded_reader.container(unseeded_reader.members()[2]).header.seed);
+
+   auto path = std::string("testinflate_archive.nfla");
+
+   {
+      std::ofstream file(path, std::ios::binary);
+      file.write(reinterpret_cast<const char *>(archive.data()), archive.size());
+   }
+
+   {
+      ArchiveReader mapped(path);
+      ASSERT(mapped.members().size() == files.size());
+      ASSERT(mapped.extract("dir/file5.bin") == files[5]);
+
+      auto moved = std::move(mapped);
+      ASSERT(moved.extract("dir/file6.bin") == files[6]);
+   }
+
+   std::remove(path.c_str());
+   ASSERT_THROWS(ArchiveReader(path), exception::OpenFailed);
+
+   auto corrupt = archive;
+   corrupt[corrupt.size() - sizeof(InflateArchiveTrailer) - 3] ^= 1;
+   ASSERT_THROWS(ArchiveReader(corrupt.data(), corrupt.size()), exception::BadCRC);
+
+   auto truncated = ByteVec(archive.begin(), archive.end()-1);
+   ASSERT_THROWS(ArchiveReader(truncated.data(), truncated.size()), exception::BadHeaderMagic);
+   ASSERT_THROWS(ArchiveReader(archive.data(), 10), exception::InsufficientSize);
+
+   COMPLETE();
+}
+
+int
+test_update()
+{
+   INIT();
+
+   auto lfsr = ShiftRegister(0x1234);
+   lfsr.shift();
+   auto saved = lfsr.state();
+   auto next = lfsr.shift();
+   lfsr.restore(saved);
+   ASSERT(lfsr.shift() == next);
+
+   ByteVec input(40001);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>((i * 37) ^ (i >> 5));
+
+   InflateOptions cases[6];
+   cases[0].level = InflateLevel::INFLATE_3BIT;
+   cases[1].level = InflateLevel::INFLATE_RNG_PARTIAL_5BIT;
+   cases[1].checksum = ChecksumType::CHECKSUM_CRC32C;
+   cases[2].level = InflateLevel::INFLATE_RNG_PARTIAL_WIDE;
+   cases[2].group_bits = 32;
+   cases[2].padding_bits = 5;
+   cases[3].level = InflateLevel::INFLATE_RNG_FULL_2BIT;
+   cases[4].level = InflateLevel::INFLATE_RNG_FULL_WIDE;
+   cases[4].group_bits = 16;
+   cases[4].padding_bits = 7;
+   cases[4].checksum = ChecksumType::CHECKSUM_CRC32C;
+   cases[5].level = InflateLevel::INFLATE_RNG_PARTIAL_1BIT;
+   cases[5].checksum = ChecksumType::CHECKSUM_XXH64;
+
+   // edits at the start, straddling units, and running to the very last byte.
+   std::pair<std::uint64_t, std::uint64_t> edits[] = {{0, 1}, {1234, 77}, {20000, 3}, {39990, 11}};
+
+   for (auto &options : cases)
+   {
+      options.seed = 0xF00D;
+
+      auto edited = input;
+      auto inflated = inflate_memory(input, options);
+      auto checkpoints = inflate_checkpoints(inflated.first, inflated.second, 16);
+      ASSERT(checkpoints.states[0] == 0xF00D);
+
+      for (auto &edit : edits)
+      {
+         ByteVec bytes(edit.second);
+
+         for (std::size_t i=0; i<bytes.size(); ++i)
+            bytes[i] = static_cast<std::uint8_t>(edit.first + i * 3);
+
+         std::memcpy(edited.data()+edit.first, bytes.data(), bytes.size());
+
+         auto without = inflated;
+         update_memory(without.first, without.second, edit.first, bytes);
+         update_memory(inflated.first, inflated.second, edit.first, bytes, &checkpoints);
+
+         auto expected = inflate_memory(edited, options);
+         ASSERT(inflated.first == expected.first);
+         ASSERT(without.first == expected.first);
+         ASSERT(std::memcmp(&inflated.second, &expected.second, sizeof(InflateHeaderV2)) == 0);
+         ASSERT(std::memcmp(&without.second, &expected.second, sizeof(InflateHeaderV2)) == 0);
+      }
+
+      ASSERT(deflate_memory(inflated.first, inflated.second) == edited);
+   }
+
+   auto inflated = inflate_memory(input, cases[3]);
+   ByteVec bytes(2);
+   ASSERT_THROWS(update_memory(inflated.first, inflated.second, input.size()-1, bytes), exception::OutOfBounds);
+
+   auto checkpoints = inflate_checkpoints(inflated.first, inflated.second);
+   checkpoints.states[0] ^= 1;
+   ASSERT_THROWS(update_memory(inflated.first, inflated.second, 5, bytes, &checkpoints), exception::BadCheckpoints);
+
+   COMPLETE();
+}
+
+int
+test_sparse()
+{
+   INIT();
+
+   // zero runs long enough for the fast path, with dense data between them and a short run that isn't.
+   ByteVec input(200003);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      if (i < 5000 || (i >= 90000 && i < 90100) || (i >= 150000 && i < 150003) || i > 199000)
+         input[i] = static_cast<std::uint8_t>((i * 29) ^ (i >> 3) ^ 1);
+
+   InflateOptions cases[6];
+   cases[0].level = InflateLevel::INFLATE_3BIT;
+   cases[1].level = InflateLevel::INFLATE_RNG_PARTIAL_5BIT;
+   cases[2].level = InflateLevel::INFLATE_RNG_PARTIAL_WIDE;
+   cases[2].group_bits = 16;
+   cases[2].padding_bits = 3;
+   cases[3].level = InflateLevel::INFLATE_WIDE;
+   cases[3].group_bits = 32;
+   cases[3].padding_bits = 5;
+   cases[4].level = InflateLevel::INFLATE_RNG_FULL_7BIT;
+   cases[5].level = InflateLevel::INFLATE_NOOP;
+
+   for (auto &options : cases)
+   {
+      options.seed = 0xCAFE;
+
+      // small chained pieces never hold a whole zero block, so they take the kernels throughout.
+      auto geometry = options_geometry(options);
+      std::uint64_t modulus = geometry.modulus();
+      std::uint64_t piece = 100;
+      ByteVec reference(inflated_size(options, input.size()));
+      ShiftRegister lfsr(0xCAFE);
+
+      for (std::uint64_t unit=0; unit*modulus<input.size(); unit+=piece)
+      {
+         auto bits = std::min(piece*modulus, input.size() - unit*modulus) * 8;
+         inflate_kernel(options.level, geometry, input.data()+unit*modulus, bits, reference.data()+unit*geometry.group_bits, lfsr);
+      }
+
+      auto inflated = inflate_memory(input, options);
+      ASSERT(inflated.first == reference);
+      ASSERT(deflate_memory(inflated.first, inflated.second) == input);
+
+      if (stats_enabled() && options.level != InflateLevel::INFLATE_NOOP && options.level != InflateLevel::INFLATE_RNG_FULL_7BIT)
+         ASSERT(last_stats().zero_bytes > 0);
+   }
+
+   auto read_file = [](const std::string &path) {
+      std::ifstream file(path, std::ios::binary);
+      return ByteVec(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   };
+
+   std::string sparse_path = "testinflate_sparse.bin";
+   std::string inflated_path = "testinflate_sparse.nfl";
+   std::string deflated_path = "testinflate_sparse.out";
+
+   {
+      // seeking past the end leaves holes on filesystems that support them.
+      std::ofstream file(sparse_path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char *>(input.data()), 5000);
+      file.seekp(0x500000 + 123);
+      file.write(reinterpret_cast<const char *>(input.data()), 5000);
+      file.seekp(0x700000);
+      file.put(1);
+   }
+
+   auto contents = read_file(sparse_path);
+   ASSERT(contents.size() == 0x700001);
+
+   auto extents = data_extents(sparse_path);
+   ASSERT(!extents.empty());
+   ASSERT(extents.back().offset + extents.back().size == contents.size());
+
+   InflateOptions file_cases[4];
+   file_cases[0].level = InflateLevel::INFLATE_RNG_PARTIAL_3BIT;
+   file_cases[1].level = InflateLevel::INFLATE_5BIT;
+   file_cases[1].checksum = ChecksumType::CHECKSUM_CRC32C;
+   file_cases[2].level = InflateLevel::INFLATE_RNG_FULL_7BIT;
+   file_cases[3].level = InflateLevel::INFLATE_RNG_PARTIAL_WIDE;
+   file_cases[3].group_bits = 32;
+   file_cases[3].padding_bits = 9;
+   file_cases[3].checksum = ChecksumType::CHECKSUM_XXH64;
+
+   for (auto &options : file_cases)
+   {
+      options.seed = 0x5EED;
+
+      auto expected = inflate_memory(contents, options);
+      auto header = inflate_file(sparse_path, inflated_path, options);
+      ASSERT(std::memcmp(&header, &expected.second, sizeof(InflateHeaderV2)) == 0);
+      ASSERT(read_file(inflated_path) == expected.first);
+
+      deflate_file(inflated_path, deflated_path, header);
+      ASSERT(read_file(deflated_path) == contents);
+
+      header.checksum ^= 1;
+      ASSERT_THROWS(deflate_file(inflated_path, deflated_path, header), exception::BadCRC);
+   }
+
+   ASSERT_THROWS(inflate_file("testinflate_missing.bin", inflated_path), exception::OpenFailed);
+
+   file_cases[2].seed = 0;
+   ASSERT_THROWS(inflate_file(sparse_path, inflated_path, file_cases[2]), exception::BadSeed);
+
+   std::remove(sparse_path.c_str());
+   std::remove(inflated_path.c_str());
+   std::remove(deflated_path.c_str());
+
+   COMPLETE();
+}
+
+int
+test_in_place()
+{
+   INIT();
+
+   InflateOptions cases[6];
+   cases[0].level = InflateLevel::INFLATE_7BIT;
+   cases[1].level = InflateLevel::INFLATE_RNG_PARTIAL_2BIT;
+   cases[1].checksum = ChecksumType::CHECKSUM_CRC32C;
+   cases[2].level = InflateLevel::INFLATE_RNG_FULL_6BIT;
+   cases[3].level = InflateLevel::INFLATE_RNG_FULL_WIDE;
+   cases[3].group_bits = 32;
+   cases[3].padding_bits = 11;
+   cases[4].level = InflateLevel::INFLATE_RNG_PARTIAL_WIDE;
+   cases[4].group_bits = 16;
+   cases[4].padding_bits = 1;
+   cases[4].checksum = ChecksumType::CHECKSUM_XXH64;
+   cases[5].level = InflateLevel::INFLATE_NOOP;
+
+   for (std::uint64_t size : {0, 1, 7, 130001})
+   {
+      ByteVec input(size);
+
+      for (std::size_t i=0; i<input.size(); ++i)
+         input[i] = static_cast<std::uint8_t>((i * 53) ^ (i >> 9));
+
+      for (auto &options : cases)
+      {
+         options.seed = 0xD00D;
+
+         auto expected = inflate_memory(input, options);
+         auto buffer = input;
+         buffer.reserve(inflated_size(options, size));
+
+         auto data = buffer.data();
+         auto header = inflate_in_place(buffer, options);
+         ASSERT(buffer == expected.first);
+         ASSERT(std::memcmp(&header, &expected.second, sizeof(InflateHeaderV2)) == 0);
+         ASSERT(buffer.data() == data);
+
+         deflate_in_place(buffer, header);
+         ASSERT(buffer == input);
+      }
+   }
+
+   ByteVec input(1000, 0x42);
+   auto buffer = input;
+   ASSERT_THROWS(inflate_in_place(buffer.data(), buffer.size(), buffer.size(), cases[0]), exception::InsufficientSize);
+
+   cases[2].seed = 0;
+   ASSERT_THROWS(inflate_in_place(buffer, cases[2]), exception::BadSeed);
+   ASSERT(buffer == input);
+
+   auto header = inflate_in_place(buffer, cases[1]);
+   header.checksum ^= 1;
+   ASSERT_THROWS(deflate_in_place(buffer, header), exception::BadCRC);
+
+   COMPLETE();
+}
+
+int
+test_rng()
+{
+   INIT();
+
+   // the first known-answer vector of Philox4x32-10: a zero key and counter.
+   std::uint32_t block[4];
+   Philox::block(0, 0, 0, block);
+   ASSERT(block[0] == 0x6627E8D5 && block[1] == 0xE169C58D && block[2] == 0xBC57AC4C && block[3] == 0x9B00DBD8);
+
+   auto walked = PhiloxRng(0x1234);
+   auto jumped = PhiloxRng(0x1234);
+
+   for (int i=0; i<1000; ++i)
+      walked.next_group();
+
+   jumped.jump(1000);
+   ASSERT(walked.next_group().shift() == jumped.next_group().shift());
+
+   auto draws = SplitMixRng(0x1234).next_group();
+   auto first = draws.shift();
+   ASSERT(first != draws.shift() && first == SplitMixRng(0x1234).next_group().shift());
+
+   // a zero run long enough for the kernels to skip, and a copy of it broken up so nothing is skipped.
+   ByteVec input(200003);
+
+   for (std::size_t i=0; i<input.size(); ++i)
+      input[i] = static_cast<std::uint8_t>((i * 29) ^ (i >> 6));
+
+   std::memset(input.data()+50000, 0, 0x10000);
+
+   auto dense = input;
+
+   for (std::size_t i=50000; i<50000+0x10000; i+=1000)
+      dense[i] = 1;
+
+   InflateOptions cases[4];
+   cases[0].level = InflateLevel::INFLATE_RNG_PARTIAL_3BIT;
+   cases[1].level = InflateLevel::INFLATE_RNG_FULL_5BIT;
+   cases[2].level = InflateLevel::INFLATE_RNG_FULL_WIDE;
+   cases[2].group_bits = 32;
+   cases[2].padding_bits = 9;
+   cases[2].checksum = ChecksumType::CHECKSUM_CRC32C;
+   cases[3].level = InflateLevel::INFLATE_RNG_FULL_1BIT;
+   cases[3].checksum = ChecksumType::CHECKSUM_XXH64;
+
+   ParallelOptions parallel;
+   parallel.minimum = 1;
+   parallel.threads = 4;
+
+   for (auto engine : {RngEngine::RNG_SPLITMIX, RngEngine::RNG_PHILOX})
+   {
+      for (auto &options : cases)
+      {
+         options.seed = 0xCAFE;
+         options.rng = RngEngine::RNG_LFSR;
+
+         auto lfsr = inflate_memory(input, options);
+
+         if (stats_enabled())
+            ASSERT((last_stats().zero_bytes > 0) == (options.level == InflateLevel::INFLATE_RNG_PARTIAL_3BIT));
+
+         options.rng = engine;
+
+         auto inflated = inflate_memory(input, options);
+         ASSERT(inflated.second.rng == engine && inflated.second.version == INFLATE_HEADER_VERSION);
+         ASSERT(lfsr.second.version == INFLATE_MIN_HEADER_VERSION);
+
+         // the zero run is skipped at every level, the RNG_FULL ones included.
+         if (stats_enabled())
+            ASSERT(last_stats().zero_bytes >= 0x8000);
+
+         ASSERT(deflate_memory(inflated.first, inflated.second) == input);
+
+         if (stats_enabled())
+            ASSERT(last_stats().zero_bytes >= 0x8000);
+
+         ASSERT(inflated.first.size() == lfsr.first.size() && inflated.first != lfsr.first);
+         ASSERT(deflate_disk(inflate_disk(input, options)) == input);
+
+         // with the run broken up nothing is skipped, so the groups after it must agree with the skipping path.
+         auto broken = inflate_memory(dense, options);
+
+         if (stats_enabled())
+            ASSERT(last_stats().zero_bytes == 0);
+
+         auto tail = inflated.first.size() / 4 * 3;
+         ASSERT(std::equal(inflated.first.begin()+tail, inflated.first.end(), broken.first.begin()+tail));
+
+         ByteVec threaded(inflated.first.size());
+         auto header = inflate_memory_parallel(input.data(), input.size(), threaded.data(), options, parallel);
+         ASSERT(threaded == inflated.first);
+         ASSERT(std::memcmp(&header, &inflated.second, sizeof(InflateHeaderV2)) == 0);
+
+         ByteVec deflated(input.size());
+         deflate_memory_parallel(threaded.data(), threaded.size(), header, deflated.data(), true, parallel);
+         ASSERT(deflated == input);
+
+         auto buffer = input;
+         inflate_in_place(buffer, options);
+         ASSERT(buffer == inflated.first);
+
+         ByteVec bytes(5, 0x77);
+         auto edited = input;
+         std::memcpy(edited.data()+150000, bytes.data(), bytes.size());
+
+         auto checkpoints = inflate_checkpoints(inflated.first, inflated.second);
+         ASSERT(checkpoints.states.size() == 1);
+
+         update_memory(inflated.first, inflated.second, 150000, bytes);
+         auto expected = inflate_memory(edited, options);
+         ASSERT(inflated.first == expected.first);
+         ASSERT(std::memcmp(&inflated.second, &expected.second, sizeof(InflateHeaderV2)) == 0);
+      }
+   }
+
+   InflateOptions bad_options;
+   bad_options.rng = static_cast<RngEngine>(7);
+   ASSERT_THROWS(inflate_memory(input, bad_options), exception::UnsupportedRng);
+   ASSERT(try_inflate_memory(input, bad_options).status() == InflateStatus::STATUS_UNSUPPORTED_RNG);
+
+   auto inflated = inflate_memory(input, cases[0]);
+   inflated.second.rng = 9;
+   ASSERT_THROWS(deflate_memory(inflated.first, inflated.second), exception::UnsupportedRng);
+
+   // readers from before version 3 ignore the engine, so an engine is only honoured in a version 3 header.
+   inflated.second.rng = RngEngine::RNG_PHILOX;
+   inflated.second.version = INFLATE_MIN_HEADER_VERSION;
+   ASSERT_THROWS(deflate_memory(inflated.first, inflated.second), exception::BadHeader);
+
+   COMPLETE();
+}
+
+int
+main
+(int argc, char *argv[])
+{
+   INIT();
+
+   LOG_INFO("Testing Bitstream objects.");
+   PROCESS_RESULT(test_bitstream);
+
+   LOG_INFO("Testing bit spans.");
+   PROCESS_RESULT(test_bitspan);
+
+   LOG_INFO("Testing entropy functions.");
+   PROCESS_RESULT(test_entropy);
+
+   LOG_INFO("Testing inflate functions.");
+   PROCESS_RESULT(test_inflate);
+
+   LOG_INFO("Testing level selection.");
+   PROCESS_RESULT(test_select);
+
+   LOG_INFO("Testing region inflation.");
+   PROCESS_RESULT(test_regions);
+
+   LOG_INFO("Testing performance counters.");
+   PROCESS_RESULT(test_stats);
+
+   LOG_INFO("Testing the non-throwing API.");
+   PROCESS_RESULT(test_status);
+
+   LOG_INFO("Testing compile-time inflation.");
+   PROCESS_RESULT(test_static);
+
+   LOG_INFO("Testing inflate contexts.");
+   PROCESS_RESULT(test_context);
+
+   LOG_INFO("Testing checksums and versioned headers.");
+   PROCESS_RESULT(test_checksum);
+
+   LOG_INFO("Testing stream adapters.");
+   PROCESS_RESULT(test_stream);
+
+   LOG_INFO("Testing wide levels.");
+   PROCESS_RESULT(test_wide);
+
+   LOG_INFO("Testing aligned containers.");
+   PROCESS_RESULT(test_container);
+
+   LOG_INFO("Testing CPU dispatch.");
+   PROCESS_RESULT(test_cpu);
+
+   LOG_INFO("Testing parallel inflation.");
+   PROCESS_RESULT(test_parallel);
+
+   LOG_INFO("Testing large buffers.");
+   PROCESS_RESULT(test_large_buffer);
+
+   LOG_INFO("Testing archives.");
+   PROCESS_RESULT(test_archive);
+
+   LOG_INFO("Testing incremental updates.");
+   PROCESS_RESULT(test_update);
+
+   LOG_INFO("Testing sparse data.");
+   PROCESS_RESULT(test_sparse);
+
+   LOG_INFO("Testing in-place transforms.");
+   PROCESS_RESULT(test_in_place);
+
+   LOG_INFO("Testing counter-based RNG engines...");
+   PROCESS_RESULT(test_rng);
 
    COMPLETE();
 }